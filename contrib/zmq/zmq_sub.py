@@ -46,6 +46,7 @@ class ZMQHandler():
         self.zmqSubSocket.setsockopt_string(zmq.SUBSCRIBE, "hashtx")
         self.zmqSubSocket.setsockopt_string(zmq.SUBSCRIBE, "rawblock")
         self.zmqSubSocket.setsockopt_string(zmq.SUBSCRIBE, "rawtx")
+        self.zmqSubSocket.setsockopt_string(zmq.SUBSCRIBE, "auxblock")
         self.zmqSubSocket.connect("tcp://127.0.0.1:%i" % port)
 
     async def handle(self) :
@@ -68,6 +69,9 @@ class ZMQHandler():
         elif topic == b"rawtx":
             print('- RAW TX ('+sequence+') -')
             print(binascii.hexlify(body))
+        elif topic == b"auxblock":
+            print('- AUX BLOCK ('+sequence+') -')
+            print(binascii.hexlify(body[:32]), binascii.hexlify(body[32:64]), struct.unpack('<I', body[64:68])[0])
         # schedule ourselves to receive the next message
         asyncio.ensure_future(self.handle())
 
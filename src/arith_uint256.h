@@ -175,6 +175,8 @@ public:
     base_uint& operator*=(uint32_t b32);
     base_uint& operator*=(const base_uint& b);
     base_uint& operator/=(const base_uint& b);
+    /** Same result as operator/= for a divisor that fits in 32 bits, computed one word at a time. */
+    base_uint& DivideBy(uint32_t b32);
 
     base_uint& operator++()
     {
@@ -0,0 +1,122 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/blockcache.h"
+
+#include "auxpow/auxpow.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "miner.h"
+#include "primitives/block.h"
+#include "timedata.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <algorithm>
+
+CAuxBlockCache auxBlockCache(MAX_AUXBLOCK_CACHE_BYTES);
+
+//! List node, hash map node and the CBlock object itself, on top of the serialized size
+static const size_t AUXBLOCK_ENTRY_OVERHEAD = sizeof(CBlock) + 128;
+
+CAuxBlockCache::CAuxBlockCache(size_t nMaxBytesIn) : nBytes(0), nMaxBytes(nMaxBytesIn), nMempoolUpdates(0), nExtraNonce(0)
+{
+}
+
+void CAuxBlockCache::Erase(entry_list::iterator it)
+{
+    std::map<CScript, uint256>::iterator itTemplate = mapTemplate.find(it->scriptPayout);
+    if (itTemplate != mapTemplate.end() && itTemplate->second == it->block->GetHash())
+        mapTemplate.erase(itTemplate);
+    mapBlock.erase(it->block->GetHash());
+    nBytes -= it->bytes;
+    blocks.erase(it);
+}
+
+void CAuxBlockCache::Evict()
+{
+    while (nBytes > nMaxBytes && !blocks.empty())
+        Erase(blocks.begin());
+}
+
+void CAuxBlockCache::UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload)
+{
+    // Notifications arrive some time after the tip moved, so blocks already
+    // built on pindexNew are kept.
+    std::lock_guard<std::mutex> lock(cs);
+    const uint256 hashTip = pindexNew->GetBlockHash();
+    for (entry_list::iterator it = blocks.begin(); it != blocks.end(); ) {
+        entry_list::iterator itNext = std::next(it);
+        if (it->block->hashPrevBlock != hashTip)
+            Erase(it);
+        it = itNext;
+    }
+}
+
+void CAuxBlockCache::TransactionAddedToMempool(const CTransactionRef &ptxn)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    nMempoolUpdates++;
+}
+
+std::shared_ptr<const CBlock> CAuxBlockCache::Create(const CScript& scriptPayout, int& nHeight, const uint256& hashPrevBlock)
+{
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        std::map<CScript, uint256>::const_iterator it = mapTemplate.find(scriptPayout);
+        if (it != mapTemplate.end()) {
+            const Entry& entry = *mapBlock.at(it->second);
+            if ((hashPrevBlock.IsNull() || entry.block->hashPrevBlock == hashPrevBlock) &&
+                (entry.nMempoolUpdates == nMempoolUpdates || GetTime() - entry.nCreated <= AUXBLOCK_REFRESH_INTERVAL)) {
+                nHeight = entry.nHeight;
+                return entry.block;
+            }
+        }
+    }
+
+    // The new block is added while cs_main is still held, so the tip cannot move
+    // on before it is in the cache; UpdatedBlockTip will drop it when it does.
+    LOCK(cs_main);
+    const CBlockIndex* pindexPrev = chainActive.Tip();
+    std::unique_ptr<CBlockTemplate> pblocktemplate = BlockAssembler(Params()).CreateNewBlock(scriptPayout);
+    if (!pblocktemplate)
+        return nullptr;
+
+    std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>(pblocktemplate->block);
+    pblock->nTime = (uint32_t) std::max(pindexPrev->GetMedianTimePast() + 1, GetAdjustedTime());
+    pblock->nNonce = 0;
+    IncrementExtraNonce(pblock.get(), pindexPrev, nExtraNonce);
+    // Sets the version
+    pblock->SetAuxPow(new CAuxPow());
+
+    std::lock_guard<std::mutex> lock(cs);
+    const uint256 hash = pblock->GetHash();
+    const size_t bytes = ::GetSerializeSize(*pblock, SER_NETWORK, PROTOCOL_VERSION) + AUXBLOCK_ENTRY_OVERHEAD;
+    blocks.push_back(Entry{pblock, scriptPayout, pindexPrev->nHeight + 1, nMempoolUpdates, GetTime(), bytes});
+    mapBlock.emplace(hash, std::prev(blocks.end()));
+    mapTemplate[scriptPayout] = hash;
+    nBytes += bytes;
+    Evict();
+
+    nHeight = pindexPrev->nHeight + 1;
+    return pblock;
+}
+
+std::shared_ptr<CBlock> CAuxBlockCache::Lookup(const uint256& hash) const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = mapBlock.find(hash);
+    if (it == mapBlock.end())
+        return nullptr;
+    return std::make_shared<CBlock>(*it->second->block);
+}
+
+CAuxBlockCache::Stats CAuxBlockCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    Stats stats;
+    stats.entries = blocks.size();
+    stats.bytes = nBytes;
+    return stats;
+}
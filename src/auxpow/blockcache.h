@@ -0,0 +1,96 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_AUXPOW_BLOCKCACHE_H
+#define BITCOIN_AUXPOW_BLOCKCACHE_H
+
+#include "script/script.h"
+#include "uint256.h"
+#include "validationinterface.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class CBlock;
+
+//! Memory budget for merge-mining blocks awaiting submission
+static const size_t MAX_AUXBLOCK_CACHE_BYTES = 64 << 20;
+//! Seconds a template is kept after the mempool changed, as getauxblock always did
+static const int64_t AUXBLOCK_REFRESH_INTERVAL = 20;
+
+/**
+ * Merge-mining block templates, one per payout script, shared by all callers of
+ * createauxblock. A template is dropped when the tip moves past it and rebuilt
+ * once the mempool has changed and it is AUXBLOCK_REFRESH_INTERVAL seconds old;
+ * until then it is handed out without taking cs_main.
+ *
+ * Every block handed out stays submittable until the tip changes or it is the
+ * oldest one when the memory budget runs out.
+ */
+class CAuxBlockCache : public CValidationInterface
+{
+public:
+    struct Stats
+    {
+        size_t entries;
+        size_t bytes;
+    };
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<CBlock> block;
+        CScript scriptPayout;
+        int nHeight;
+        uint64_t nMempoolUpdates;
+        int64_t nCreated;
+        size_t bytes;
+    };
+    struct CheapHasher
+    {
+        size_t operator()(const uint256& hash) const { return hash.GetCheapHash(); }
+    };
+    typedef std::list<Entry> entry_list;
+
+    mutable std::mutex cs;
+    //! Oldest first
+    entry_list blocks;
+    std::unordered_map<uint256, entry_list::iterator, CheapHasher> mapBlock;
+    //! Hash of the current template of each payout script
+    std::map<CScript, uint256> mapTemplate;
+    size_t nBytes;
+    size_t nMaxBytes;
+    uint64_t nMempoolUpdates;
+    //! Guarded by cs_main
+    unsigned int nExtraNonce;
+
+    void Erase(entry_list::iterator it);
+    void Evict();
+
+protected:
+    void UpdatedBlockTip(const CBlockIndex *pindexNew, const CBlockIndex *pindexFork, bool fInitialDownload) override;
+    void TransactionAddedToMempool(const CTransactionRef &ptxn) override;
+
+public:
+    explicit CAuxBlockCache(size_t nMaxBytesIn);
+
+    /**
+     * Block paying to scriptPayout on top of the tip, with an empty auxpow.
+     * nHeight is set to its height. Returns nullptr if no block could be made.
+     *
+     * Callers that saw the tip move before UpdatedBlockTip could get here pass
+     * the new tip as hashPrevBlock, so a template on the old one is not reused.
+     */
+    std::shared_ptr<const CBlock> Create(const CScript& scriptPayout, int& nHeight, const uint256& hashPrevBlock = uint256());
+    //! Copy of a block handed out by Create, or nullptr if it is stale
+    std::shared_ptr<CBlock> Lookup(const uint256& hash) const;
+    Stats GetStats() const;
+};
+
+extern CAuxBlockCache auxBlockCache;
+
+#endif // BITCOIN_AUXPOW_BLOCKCACHE_H
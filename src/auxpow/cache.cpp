@@ -0,0 +1,37 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/cache.h"
+
+#include "auxpow/auxpow.h"
+#include "saltedcache.h"
+
+namespace {
+/**
+ * Valid auxpow cache, shared by header sync (including the header check
+ * threads), CheckBlock for compact and full blocks, and ReadBlockFromDisk.
+ * Entries are SHA256d(nonce || aux block hash || auxpow).
+ */
+CSaltedCache<uint256, CAuxPow> auxpowCache;
+} // namespace
+
+void InitAuxpowCache()
+{
+    auxpowCache.Init("-maxauxpowcachesize", DEFAULT_MAX_AUXPOW_CACHE_SIZE, MAX_MAX_AUXPOW_CACHE_SIZE, "auxpow cache");
+}
+
+uint256 AuxpowCacheEntry(const uint256& hashAuxBlock, const CAuxPow& auxpow)
+{
+    return auxpowCache.Entry(hashAuxBlock, auxpow);
+}
+
+bool AuxpowCacheContains(const uint256& entry, bool erase)
+{
+    return auxpowCache.Contains(entry, erase);
+}
+
+void AuxpowCacheInsert(const uint256& entry)
+{
+    auxpowCache.Insert(entry);
+}
@@ -0,0 +1,35 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_AUXPOW_CACHE_H
+#define BITCOIN_AUXPOW_CACHE_H
+
+#include "uint256.h"
+
+#include <stdint.h>
+
+class CAuxPow;
+
+// Each entry is a 32 byte hash, so the default holds about 130000 merge-mined headers.
+static const unsigned int DEFAULT_MAX_AUXPOW_CACHE_SIZE = 4;
+// Maximum auxpow cache size allowed
+static const int64_t MAX_MAX_AUXPOW_CACHE_SIZE = 1024;
+
+/**
+ * Cache of auxpows that passed CheckBlockProofOfWork (CheckAuxpow and the parent
+ * block's scrypt) for a given merge-mined block, so copies of the same header
+ * arriving again do not pay for the merkle branches and scrypt twice.
+ *
+ * Entries are SHA256d(nonce || aux block hash || auxpow), so they cover the
+ * parent block header and everything else CheckAuxpow looks at.
+ */
+uint256 AuxpowCacheEntry(const uint256& hashAuxBlock, const CAuxPow& auxpow);
+/** With erase, the entry's slot may be reused by later insertions; it keeps being found until then. */
+bool AuxpowCacheContains(const uint256& entry, bool erase = false);
+void AuxpowCacheInsert(const uint256& entry);
+
+/** Size the cache from -maxauxpowcachesize and draw a new nonce, so entries computed before no longer match. */
+void InitAuxpowCache();
+
+#endif // BITCOIN_AUXPOW_CACHE_H
@@ -0,0 +1,58 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/compress.h"
+
+const unsigned char CAuxPowCompressor::WITNESS_COMMITMENT_PREFIX[6] = { 0x6a, 0x24, 0xaa, 0x21, 0xa9, 0xed };
+
+bool CAuxPowCompressor::IsWitnessCommitment(const CScript& script)
+{
+    return script.size() == sizeof(WITNESS_COMMITMENT_PREFIX) + 32 &&
+           std::equal(WITNESS_COMMITMENT_PREFIX, WITNESS_COMMITMENT_PREFIX + sizeof(WITNESS_COMMITMENT_PREFIX), script.begin());
+}
+
+bool CAuxPowScriptDict::Find(const CScript& script, uint32_t& nId) const
+{
+    LOCK(cs);
+    std::map<CScript, uint32_t>::const_iterator it = mapScriptId.find(script);
+    if (it == mapScriptId.end())
+        return false;
+    nId = it->second;
+    return true;
+}
+
+bool CAuxPowScriptDict::Get(uint32_t nId, CScript& script) const
+{
+    LOCK(cs);
+    if (nId >= vScript.size() || vScript[nId].empty())
+        return false;
+    script = vScript[nId];
+    return true;
+}
+
+bool CAuxPowScriptDict::Add(const CScript& script, uint32_t& nId)
+{
+    LOCK(cs);
+    if (vScript.size() >= MAX_SCRIPTS)
+        return false;
+    nId = vScript.size();
+    vScript.push_back(script);
+    mapScriptId.emplace(script, nId);
+    return true;
+}
+
+void CAuxPowScriptDict::Load(uint32_t nId, const CScript& script)
+{
+    LOCK(cs);
+    if (nId >= vScript.size())
+        vScript.resize(nId + 1);
+    vScript[nId] = script;
+    mapScriptId.emplace(script, nId);
+}
+
+size_t CAuxPowScriptDict::size() const
+{
+    LOCK(cs);
+    return vScript.size();
+}
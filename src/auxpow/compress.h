@@ -0,0 +1,242 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_AUXPOW_COMPRESS_H
+#define BITCOIN_AUXPOW_COMPRESS_H
+
+#include "amount.h"
+#include "auxpow/auxpow.h"
+#include "compressor.h"
+#include "serialize.h"
+#include "sync.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * Output scripts of auxpow parent coinbases, numbered in order of first use.
+ * Pools pay to the same few scripts block after block, so the block tree
+ * stores each of them once and refers to it by number.
+ */
+class CAuxPowScriptDict
+{
+private:
+    mutable CCriticalSection cs;
+    std::vector<CScript> vScript;
+    std::map<CScript, uint32_t> mapScriptId;
+
+public:
+    //! Scripts past this many are stored inline, bounding memory use
+    static const size_t MAX_SCRIPTS = 65536;
+
+    bool Find(const CScript& script, uint32_t& nId) const;
+    bool Get(uint32_t nId, CScript& script) const;
+    //! Assign the next number to script; false if the dictionary is full
+    bool Add(const CScript& script, uint32_t& nId);
+    //! Restore a numbered script read back from disk
+    void Load(uint32_t nId, const CScript& script);
+    size_t size() const;
+};
+
+/**
+ * Compact serialization of a block index auxpow.
+ *
+ * The parent coinbase is usually a single input spending nothing, so only its
+ * scriptSig, sequence and outputs are stored, with amounts compressed. Output scripts go through the
+ * dictionary, except for the segwit commitment whose fixed prefix is dropped.
+ * The parent merkle root is left out when the coinbase and merkle branch
+ * reproduce it, which is true of every auxpow that passed CheckAuxpow.
+ * Anything unusual falls back to the plain serialization.
+ *
+ * New dictionary entries made while serializing are appended to
+ * pvNewScripts, and have to be written along with the auxpow.
+ */
+class CAuxPowCompressor
+{
+private:
+    enum {
+        AUXPOW_RAW = 1,
+        AUXPOW_COMPACT_COINBASE = 2,
+        AUXPOW_SEQUENCE_FINAL = 4,
+        AUXPOW_HASH_BLOCK = 8,
+        AUXPOW_MERKLE_ROOT = 16,
+    };
+    enum {
+        SCRIPT_INLINE = 0,
+        SCRIPT_WITNESS_COMMITMENT = 1,
+        SCRIPT_DICT = 2,
+    };
+    static const unsigned char WITNESS_COMMITMENT_PREFIX[6];
+
+    std::shared_ptr<CAuxPow>& auxpow;
+    CAuxPowScriptDict& dict;
+    std::vector<std::pair<uint32_t, CScript> >* pvNewScripts;
+
+    static bool IsWitnessCommitment(const CScript& script);
+
+    template<typename Stream>
+    void SerializeScript(Stream& s, const CScript& script) const
+    {
+        uint32_t nId;
+        if (IsWitnessCommitment(script)) {
+            s << VARINT((uint32_t)SCRIPT_WITNESS_COMMITMENT);
+            s.write((const char*)&script[sizeof(WITNESS_COMMITMENT_PREFIX)], script.size() - sizeof(WITNESS_COMMITMENT_PREFIX));
+            return;
+        }
+        if (!script.IsUnspendable()) {
+            bool fFound = dict.Find(script, nId);
+            if (!fFound && pvNewScripts && dict.Add(script, nId)) {
+                pvNewScripts->push_back(std::make_pair(nId, script));
+                fFound = true;
+            }
+            if (fFound) {
+                s << VARINT(nId + SCRIPT_DICT);
+                return;
+            }
+        }
+        s << VARINT((uint32_t)SCRIPT_INLINE);
+        s << CScriptCompressor(REF(script));
+    }
+
+    template<typename Stream>
+    void UnserializeScript(Stream& s, CScript& script)
+    {
+        uint32_t nCode;
+        s >> VARINT(nCode);
+        if (nCode == SCRIPT_INLINE) {
+            s >> REF(CScriptCompressor(script));
+        } else if (nCode == SCRIPT_WITNESS_COMMITMENT) {
+            script.assign(WITNESS_COMMITMENT_PREFIX, WITNESS_COMMITMENT_PREFIX + sizeof(WITNESS_COMMITMENT_PREFIX));
+            script.resize(sizeof(WITNESS_COMMITMENT_PREFIX) + 32);
+            s.read((char*)&script[sizeof(WITNESS_COMMITMENT_PREFIX)], 32);
+        } else if (!dict.Get(nCode - SCRIPT_DICT, script)) {
+            throw std::ios_base::failure("Unknown auxpow coinbase script");
+        }
+    }
+
+public:
+    CAuxPowCompressor(std::shared_ptr<CAuxPow>& auxpowIn, CAuxPowScriptDict& dictIn, std::vector<std::pair<uint32_t, CScript> >* pvNewScriptsIn = nullptr) :
+        auxpow(auxpowIn), dict(dictIn), pvNewScripts(pvNewScriptsIn) { }
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        const CAuxPow& aux = *auxpow;
+        const CTransaction& tx = *aux.tx;
+
+        uint32_t nFlags = 0;
+        if (aux.parentBlockHeader.IsAuxPow()) {
+            s << VARINT((uint32_t)AUXPOW_RAW);
+            s << aux;
+            return;
+        }
+        if (tx.vin.size() == 1 && tx.vin[0].prevout.IsNull() && !tx.HasWitness() &&
+            std::all_of(tx.vout.begin(), tx.vout.end(), [](const CTxOut& txout) { return MoneyRange(txout.nValue); })) {
+            nFlags |= AUXPOW_COMPACT_COINBASE;
+            if (tx.vin[0].nSequence == CTxIn::SEQUENCE_FINAL)
+                nFlags |= AUXPOW_SEQUENCE_FINAL;
+        }
+        if (!aux.hashBlock.IsNull())
+            nFlags |= AUXPOW_HASH_BLOCK;
+        if (aux.CheckMerkleBranch(aux.GetHash(), aux.vMerkleBranch, aux.nIndex) != aux.parentBlockHeader.hashMerkleRoot)
+            nFlags |= AUXPOW_MERKLE_ROOT;
+        s << VARINT(nFlags);
+
+        if (nFlags & AUXPOW_COMPACT_COINBASE) {
+            s << VARINT((uint32_t)tx.nVersion);
+            s << *(const CScriptBase*)(&tx.vin[0].scriptSig);
+            if (!(nFlags & AUXPOW_SEQUENCE_FINAL))
+                s << tx.vin[0].nSequence;
+            s << VARINT((uint64_t)tx.vout.size());
+            for (const CTxOut& txout : tx.vout) {
+                s << VARINT(CTxOutCompressor::CompressAmount(txout.nValue));
+                SerializeScript(s, txout.scriptPubKey);
+            }
+            s << VARINT(tx.nLockTime);
+        } else {
+            s << tx;
+        }
+        if (nFlags & AUXPOW_HASH_BLOCK)
+            s << aux.hashBlock;
+        s << aux.vMerkleBranch;
+        s << VARINT((uint32_t)aux.nIndex);
+        s << aux.vChainMerkleBranch;
+        s << VARINT(aux.nChainIndex);
+
+        const CBlockHeader& parent = aux.parentBlockHeader;
+        s << VARINT((uint32_t)parent.nVersion);
+        s << parent.hashPrevBlock;
+        if (nFlags & AUXPOW_MERKLE_ROOT)
+            s << parent.hashMerkleRoot;
+        s << parent.nTime;
+        s << parent.nBits;
+        s << parent.nNonce;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        auxpow.reset(new CAuxPow());
+        CAuxPow& aux = *auxpow;
+
+        uint32_t nFlags;
+        s >> VARINT(nFlags);
+        if (nFlags & AUXPOW_RAW) {
+            s >> aux;
+            return;
+        }
+
+        if (nFlags & AUXPOW_COMPACT_COINBASE) {
+            CMutableTransaction mtx;
+            uint32_t nVersion;
+            s >> VARINT(nVersion);
+            mtx.nVersion = (int32_t)nVersion;
+            mtx.vin.resize(1);
+            s >> *(CScriptBase*)(&mtx.vin[0].scriptSig);
+            if (!(nFlags & AUXPOW_SEQUENCE_FINAL))
+                s >> mtx.vin[0].nSequence;
+            uint64_t nOutputs;
+            s >> VARINT(nOutputs);
+            for (uint64_t i = 0; i < nOutputs; i++) {
+                uint64_t nValue;
+                s >> VARINT(nValue);
+                CTxOut txout;
+                txout.nValue = CTxOutCompressor::DecompressAmount(nValue);
+                UnserializeScript(s, txout.scriptPubKey);
+                mtx.vout.push_back(txout);
+            }
+            s >> VARINT(mtx.nLockTime);
+            aux.SetTx(MakeTransactionRef(std::move(mtx)));
+        } else {
+            CMutableTransaction mtx;
+            s >> mtx;
+            aux.SetTx(MakeTransactionRef(std::move(mtx)));
+        }
+        if (nFlags & AUXPOW_HASH_BLOCK)
+            s >> aux.hashBlock;
+        s >> aux.vMerkleBranch;
+        uint32_t nIndex;
+        s >> VARINT(nIndex);
+        aux.nIndex = (int)nIndex;
+        s >> aux.vChainMerkleBranch;
+        s >> VARINT(aux.nChainIndex);
+
+        CBlockHeader& parent = aux.parentBlockHeader;
+        uint32_t nVersion;
+        s >> VARINT(nVersion);
+        parent.nVersion = (int32_t)nVersion;
+        s >> parent.hashPrevBlock;
+        if (nFlags & AUXPOW_MERKLE_ROOT)
+            s >> parent.hashMerkleRoot;
+        else
+            parent.hashMerkleRoot = aux.CheckMerkleBranch(aux.GetHash(), aux.vMerkleBranch, aux.nIndex);
+        s >> parent.nTime;
+        s >> parent.nBits;
+        s >> parent.nNonce;
+    }
+};
+
+#endif // BITCOIN_AUXPOW_COMPRESS_H
@@ -0,0 +1,109 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/store.h"
+
+#include "auxpow/auxpow.h"
+#include "chain.h"
+#include "txdb.h"
+#include "validation.h"
+
+#include <algorithm>
+
+CAuxPowStore auxpowStore(DEFAULT_AUXPOW_CACHE << 20);
+
+//! List node, hash map node and the CAuxPow object itself, on top of the serialized size
+static const size_t AUXPOW_ENTRY_OVERHEAD = sizeof(CAuxPow) + 128;
+
+CAuxPowStore::CAuxPowStore(size_t nMaxBytesIn) : nBytes(0), nMaxBytes(nMaxBytesIn), nHits(0), nMisses(0)
+{
+}
+
+void CAuxPowStore::Evict()
+{
+    while (nBytes > nMaxBytes && !lru.empty()) {
+        nBytes -= lru.back().bytes;
+        map.erase(lru.back().hash);
+        lru.pop_back();
+    }
+}
+
+std::shared_ptr<CAuxPow> CAuxPowStore::Get(const uint256& hash)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = map.find(hash);
+    if (it == map.end()) {
+        nMisses++;
+        return nullptr;
+    }
+    nHits++;
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->auxpow;
+}
+
+void CAuxPowStore::Put(const uint256& hash, const std::shared_ptr<CAuxPow>& auxpow)
+{
+    const size_t bytes = ::GetSerializeSize(*auxpow, SER_NETWORK, PROTOCOL_VERSION) + AUXPOW_ENTRY_OVERHEAD;
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = map.find(hash);
+    if (it != map.end()) {
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.push_front(Entry{hash, auxpow, bytes});
+    map.emplace(hash, lru.begin());
+    nBytes += bytes;
+    Evict();
+}
+
+bool CAuxPowStore::Contains(const uint256& hash) const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    return map.count(hash) != 0;
+}
+
+void CAuxPowStore::SetMaxBytes(size_t nMaxBytesIn)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    nMaxBytes = nMaxBytesIn;
+    Evict();
+}
+
+void CAuxPowStore::Clear()
+{
+    std::lock_guard<std::mutex> lock(cs);
+    lru.clear();
+    map.clear();
+    nBytes = 0;
+}
+
+CAuxPowStore::Stats CAuxPowStore::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    Stats stats;
+    stats.entries = map.size();
+    stats.bytes = nBytes;
+    stats.max_bytes = nMaxBytes;
+    stats.hits = nHits;
+    stats.misses = nMisses;
+    return stats;
+}
+
+void PrefetchAuxPow(const std::vector<const CBlockIndex*>& vpindex)
+{
+    std::vector<uint256> vHash;
+    for (const CBlockIndex* pindex : vpindex) {
+        if ((pindex->nVersion & AuxPow::BLOCK_VERSION_AUXPOW) && !mapDirtyAuxPow.count(pindex->GetBlockHash()) &&
+            !auxpowStore.Contains(pindex->GetBlockHash()))
+            vHash.push_back(pindex->GetBlockHash());
+    }
+    // Auxpows are keyed by block hash, so reading in hash order walks the
+    // database forward instead of seeking all over it.
+    std::sort(vHash.begin(), vHash.end());
+    for (const uint256& hash : vHash) {
+        std::shared_ptr<CAuxPow> auxpow;
+        if (pblocktree->ReadAuxPow(hash, auxpow))
+            auxpowStore.Put(hash, auxpow);
+    }
+}
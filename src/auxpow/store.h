@@ -0,0 +1,83 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_AUXPOW_STORE_H
+#define BITCOIN_AUXPOW_STORE_H
+
+#include "uint256.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+class CAuxPow;
+class CBlockIndex;
+
+//! -auxpowcache default (MiB)
+static const int64_t DEFAULT_AUXPOW_CACHE = 32;
+
+/**
+ * Memory-bounded LRU of the auxpows of merge-mined block index entries, so that
+ * serving headers does not read the block tree database once per header.
+ * Sizes are estimated from the serialized auxpow plus bookkeeping overhead.
+ */
+class CAuxPowStore
+{
+public:
+    struct Stats
+    {
+        size_t entries;
+        size_t bytes;
+        size_t max_bytes;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+private:
+    struct Entry
+    {
+        uint256 hash;
+        std::shared_ptr<CAuxPow> auxpow;
+        size_t bytes;
+    };
+    struct CheapHasher
+    {
+        size_t operator()(const uint256& hash) const { return hash.GetCheapHash(); }
+    };
+    typedef std::list<Entry> entry_list;
+
+    mutable std::mutex cs;
+    //! Most recently used first
+    entry_list lru;
+    std::unordered_map<uint256, entry_list::iterator, CheapHasher> map;
+    size_t nBytes;
+    size_t nMaxBytes;
+    uint64_t nHits;
+    uint64_t nMisses;
+
+    void Evict();
+
+public:
+    explicit CAuxPowStore(size_t nMaxBytesIn);
+
+    std::shared_ptr<CAuxPow> Get(const uint256& hash);
+    void Put(const uint256& hash, const std::shared_ptr<CAuxPow>& auxpow);
+    bool Contains(const uint256& hash) const;
+    void SetMaxBytes(size_t nMaxBytesIn);
+    void Clear();
+    Stats GetStats() const;
+};
+
+extern CAuxPowStore auxpowStore;
+
+/**
+ * Load the auxpows of the merge-mined headers in vpindex that are neither dirty
+ * nor in auxpowStore, reading the block tree in key order rather than chain order.
+ * Called before serving a range of headers.
+ */
+void PrefetchAuxPow(const std::vector<const CBlockIndex*>& vpindex);
+
+#endif // BITCOIN_AUXPOW_STORE_H
@@ -4,8 +4,11 @@
 
 #include "bench.h"
 
+#include "auxpow/cache.h"
+#include "crypto/scrypt.h"
 #include "crypto/sha256.h"
 #include "key.h"
+#include "powcache.h"
 #include "validation.h"
 #include "util.h"
 #include "random.h"
@@ -14,10 +17,13 @@ int
 main(int argc, char** argv)
 {
     SHA256AutoDetect();
+    scrypt_detect_multi();
     RandomInit();
     ECC_Start();
     SetupEnvironment();
     fPrintToDebugLog = false; // don't want to write to debug.log file
+    InitAuxpowCache();
+    InitPoWCache();
 
     benchmark::BenchRunner::RunAll();
 
@@ -0,0 +1,22 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+#include "chainparams.h"
+#include "validation.h"
+
+// Sum the subsidy of a 10000 block window, as a supply audit or a reindex does.
+static void BlockSubsidy(benchmark::State& state)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    CAmount nSum = 0;
+    while (state.KeepRunning()) {
+        for (int nHeight = 2000000; nHeight < 2010000; nHeight++)
+            nSum += GetBlockSubsidy(nHeight, consensusParams);
+    }
+    assert(nSum > 0);
+}
+
+BENCHMARK(BlockSubsidy);
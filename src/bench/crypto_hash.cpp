@@ -11,6 +11,7 @@
 #include "uint256.h"
 #include "utiltime.h"
 #include "crypto/ripemd160.h"
+#include "crypto/scrypt.h"
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
 #include "crypto/sha512.h"
@@ -92,6 +93,87 @@ static void FastRandom_1bit(benchmark::State& state)
     }
 }
 
+/* Number of 80-byte headers to scrypt per iteration; hashes/s is this over the average time */
+static const size_t SCRYPT_HEADERS = 64;
+
+static void ScryptHeaders(benchmark::State& state, size_t nMaxLanes, bool fMidstate = false)
+{
+    std::vector<std::vector<char>> in(SCRYPT_HEADERS, std::vector<char>(80, 0));
+    std::vector<uint256> out(SCRYPT_HEADERS);
+    std::vector<const char*> pin;
+    std::vector<char*> pout;
+    for (size_t i = 0; i < SCRYPT_HEADERS; i++) {
+        in[i][76] = (char)i;
+        pin.push_back(in[i].data());
+        pout.push_back((char*)out[i].begin());
+    }
+    ScryptMidstate midstate;
+    scrypt_header_midstate(in[0].data(), &midstate);
+    while (state.KeepRunning())
+        scrypt_1024_1_1_256_multi(pin.data(), pout.data(), SCRYPT_HEADERS, fMidstate ? &midstate : nullptr, nMaxLanes);
+}
+
+static void Scrypt_1way(benchmark::State& state)
+{
+    ScryptHeaders(state, 1);
+}
+
+static void Scrypt_8way(benchmark::State& state)
+{
+    ScryptHeaders(state, 8);
+}
+
+static void Scrypt_16way(benchmark::State& state)
+{
+    ScryptHeaders(state, 16);
+}
+
+static void Scrypt_16way_Midstate(benchmark::State& state)
+{
+    ScryptHeaders(state, 16, true);
+}
+
+/* The PBKDF2 steps of one scrypt hash, as they were (passwd rehashed by both) and as the kernels do them now */
+static void ScryptPBKDF2_Separate(benchmark::State& state)
+{
+    std::vector<uint8_t> in(80, 0), B(128, 0);
+    uint256 out;
+    while (state.KeepRunning()) {
+        for (int i = 0; i < 1000; i++) {
+            in[76] = i;
+            PBKDF2_SHA256(in.data(), 80, in.data(), 80, 1, B.data(), 128);
+            PBKDF2_SHA256(in.data(), 80, B.data(), 128, 1, out.begin(), 32);
+        }
+    }
+}
+
+static void ScryptPBKDF2_Keyed(benchmark::State& state, bool fMidstate)
+{
+    std::vector<char> in(80, 0);
+    std::vector<uint8_t> B(128, 0);
+    uint256 out;
+    ScryptMidstate midstate;
+    ScryptHeaderKey key;
+    scrypt_header_midstate(in.data(), &midstate);
+    while (state.KeepRunning()) {
+        for (int i = 0; i < 1000; i++) {
+            in[76] = i;
+            scrypt_pbkdf2_begin(in.data(), fMidstate ? &midstate : nullptr, &key, B.data());
+            scrypt_pbkdf2_end(&key, B.data(), (char*)out.begin());
+        }
+    }
+}
+
+static void ScryptPBKDF2_SharedKey(benchmark::State& state)
+{
+    ScryptPBKDF2_Keyed(state, false);
+}
+
+static void ScryptPBKDF2_Midstate(benchmark::State& state)
+{
+    ScryptPBKDF2_Keyed(state, true);
+}
+
 BENCHMARK(RIPEMD160);
 BENCHMARK(SHA1);
 BENCHMARK(SHA256);
@@ -101,3 +183,11 @@ BENCHMARK(SHA256_32b);
 BENCHMARK(SipHash_32b);
 BENCHMARK(FastRandom_32bit);
 BENCHMARK(FastRandom_1bit);
+
+BENCHMARK(Scrypt_1way);
+BENCHMARK(Scrypt_8way);
+BENCHMARK(Scrypt_16way);
+BENCHMARK(Scrypt_16way_Midstate);
+BENCHMARK(ScryptPBKDF2_Separate);
+BENCHMARK(ScryptPBKDF2_SharedKey);
+BENCHMARK(ScryptPBKDF2_Midstate);
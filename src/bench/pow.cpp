@@ -0,0 +1,329 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "bench.h"
+
+#include "arith_uint256.h"
+#include "auxpow/auxpow.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "clientversion.h"
+#include "pow.h"
+#include "primitives/block.h"
+#include "random.h"
+#include "script/script.h"
+#include "streams.h"
+
+#include <algorithm>
+#include <vector>
+
+/* Entries in each synthetic chain; retargeting only runs on heights with at least
+ * CHAIN_HISTORY ancestors below them, which covers the whole KGW window. */
+static const int CHAIN_LENGTH = 100000;
+static const int CHAIN_HISTORY = 20000;
+/* Number of headers checked per iteration of the proof-of-work benchmarks */
+static const size_t POW_HEADERS = 64;
+/* Every POW_AUXPOW_EVERY-th header of the mixed batch is merge-mined */
+static const size_t POW_AUXPOW_EVERY = 4;
+
+static const unsigned char pchMergedMiningHeader[] = { 0xfa, 0xbe, 'm', 'm' };
+
+/**
+ * Chain of CHAIN_LENGTH block index entries ending just below nEndHeight, with block
+ * times jittered around nSpacing so that every retarget actually has work to do.
+ * It does not reach down to genesis, so there are no skip pointers.
+ */
+static void BuildChain(std::vector<CBlockIndex>& vIndex, int nEndHeight, int64_t nSpacing)
+{
+    FastRandomContext ctx(true);
+    vIndex.assign(CHAIN_LENGTH, CBlockIndex());
+    uint32_t nTime = 1369199888;
+    for (int i = 0; i < CHAIN_LENGTH; i++) {
+        CBlockIndex& index = vIndex[i];
+        index.pprev = i ? &vIndex[i - 1] : nullptr;
+        index.nHeight = nEndHeight - CHAIN_LENGTH + i;
+        nTime += nSpacing / 2 + ctx.randrange(nSpacing);
+        index.nTime = nTime;
+        index.nBits = 0x1b0404cb;
+    }
+}
+
+/** GetNextWorkRequired for every header whose height falls in [nBeginHeight, nEndHeight) */
+static void NextWorkRequired(benchmark::State& state, int nBeginHeight, int nEndHeight, int64_t nSpacing)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    std::vector<CBlockIndex> vIndex;
+    BuildChain(vIndex, nEndHeight, nSpacing);
+
+    const int nFirst = std::max(nBeginHeight - (nEndHeight - CHAIN_LENGTH), CHAIN_HISTORY) - 1;
+    int i = nFirst;
+    CBlockHeader header;
+    while (state.KeepRunning()) {
+        const CBlockIndex* pindexLast = &vIndex[i];
+        header.nTime = pindexLast->nTime + nSpacing;
+        header.nBits = GetNextWorkRequired(pindexLast, &header, params);
+        if (++i == CHAIN_LENGTH - 1)
+            i = nFirst;
+    }
+}
+
+static void NextWorkRequired_V1(benchmark::State& state)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    NextWorkRequired(state, 0, params.Fork1Height, params.nPowTargetSpacing);
+}
+
+static void NextWorkRequired_V2(benchmark::State& state)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    NextWorkRequired(state, params.Fork1Height, params.Fork2Height, params.nPowTargetSpacing2);
+}
+
+static void NextWorkRequired_KGW(benchmark::State& state)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    NextWorkRequired(state, params.Fork2Height, params.Fork3Height, params.nPowTargetSpacing3);
+}
+
+static void NextWorkRequired_KGW2(benchmark::State& state)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    NextWorkRequired(state, params.Fork3Height, params.Fork3Height + CHAIN_LENGTH, params.nPowTargetSpacing3);
+}
+
+/** GetNextWorkRequired asked over and over for the same tip, as by template creation for several pool frontends */
+static void NextWorkRequired_KGW2_SameTip(benchmark::State& state)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    std::vector<CBlockIndex> vIndex;
+    BuildChain(vIndex, params.Fork3Height + CHAIN_LENGTH, params.nPowTargetSpacing3);
+    const uint256 hashTip = uint256S("0x01");
+    CBlockIndex* pindexLast = &vIndex.back();
+    pindexLast->phashBlock = &hashTip;
+
+    CBlockHeader header;
+    header.nTime = pindexLast->nTime + params.nPowTargetSpacing3;
+    while (state.KeepRunning())
+        header.nBits = GetNextWorkRequired(pindexLast, &header, params);
+}
+
+/** Bump nNonce until the scrypt hash of header meets its nBits. */
+static void Grind(CBlockHeader& header, const Consensus::Params& params)
+{
+    while (!CheckProofOfWork(header.GetPoWHash(), header.nBits, params))
+        header.nNonce++;
+}
+
+/**
+ * Merge-mine header: a parent block whose coinbase commits to header through a chain
+ * merkle tree of four slots, and whose own merkle tree holds 1024 transactions.
+ */
+static void AttachAuxpow(CBlockHeader& header, FastRandomContext& ctx, const Consensus::Params& params)
+{
+    header.nVersion = 4 | (AuxPow::CHAIN_ID * AuxPow::BLOCK_VERSION_CHAIN_START);
+    CAuxPow* pauxpow = new CAuxPow();
+    header.SetAuxPow(pauxpow);
+
+    const uint32_t nSize = 4;
+    const uint32_t nNonce = ctx.rand32();
+    uint32_t rand = nNonce * 1103515245 + 12345;
+    rand += AuxPow::CHAIN_ID;
+    rand = rand * 1103515245 + 12345;
+    pauxpow->nChainIndex = rand % nSize;
+    for (int i = 0; i < 2; i++)
+        pauxpow->vChainMerkleBranch.push_back(ctx.rand256());
+    const uint256 hashRoot = pauxpow->CheckMerkleBranch(header.GetHash(), pauxpow->vChainMerkleBranch, pauxpow->nChainIndex);
+    std::vector<unsigned char> vchCommit(pchMergedMiningHeader, pchMergedMiningHeader + sizeof(pchMergedMiningHeader));
+    vchCommit.insert(vchCommit.end(), hashRoot.begin(), hashRoot.end());
+    std::reverse(vchCommit.end() - hashRoot.size(), vchCommit.end());
+    for (int i = 0; i < 4; i++)
+        vchCommit.push_back((nSize >> (8 * i)) & 0xff);
+    for (int i = 0; i < 4; i++)
+        vchCommit.push_back((nNonce >> (8 * i)) & 0xff);
+
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].prevout.SetNull();
+    coinbase.vin[0].scriptSig = CScript() << ctx.rand32() << vchCommit;
+    coinbase.vout.resize(1);
+    coinbase.vout[0].nValue = 25 * COIN;
+    coinbase.vout[0].scriptPubKey = CScript() << OP_TRUE;
+    pauxpow->SetTx(MakeTransactionRef(std::move(coinbase)));
+    pauxpow->nIndex = 0;
+    for (int i = 0; i < 10; i++)
+        pauxpow->vMerkleBranch.push_back(ctx.rand256());
+
+    CBlockHeader& parent = pauxpow->parentBlockHeader;
+    parent.nVersion = 2;
+    parent.hashPrevBlock = ctx.rand256();
+    parent.hashMerkleRoot = pauxpow->CheckMerkleBranch(pauxpow->GetHash(), pauxpow->vMerkleBranch, 0);
+    parent.nTime = header.nTime;
+    parent.nBits = header.nBits;
+    Grind(parent, params);
+}
+
+/**
+ * POW_HEADERS valid headers, every nAuxpowEvery-th of them merge-mined. Mainnet
+ * parameters with a proof-of-work limit that any other hash meets, so building the
+ * batch only takes a couple of scrypt runs per header.
+ */
+static void BuildHeaders(std::vector<CBlockHeader>& vHeader, size_t nAuxpowEvery, Consensus::Params& params)
+{
+    params = CreateChainParams(CBaseChainParams::MAIN)->GetConsensus();
+    params.powLimit = ArithToUint256(~arith_uint256() >> 1);
+    const uint32_t nBits = UintToArith256(params.powLimit).GetCompact();
+
+    FastRandomContext ctx(true);
+    vHeader.assign(POW_HEADERS, CBlockHeader());
+    for (size_t i = 0; i < POW_HEADERS; i++) {
+        CBlockHeader& header = vHeader[i];
+        header.nVersion = 4;
+        header.hashPrevBlock = ctx.rand256();
+        header.hashMerkleRoot = ctx.rand256();
+        header.nTime = 1500000000 + i * 60;
+        header.nBits = nBits;
+        if (nAuxpowEvery && i % nAuxpowEvery == nAuxpowEvery - 1)
+            AttachAuxpow(header, ctx, params);
+        else
+            Grind(header, params);
+    }
+}
+
+/* Header sync: CheckBlockHeadersProofOfWork on a batch of plain and merge-mined headers */
+static void CheckHeadersPoW(benchmark::State& state)
+{
+    Consensus::Params params;
+    std::vector<CBlockHeader> vHeader;
+    BuildHeaders(vHeader, POW_AUXPOW_EVERY, params);
+    std::vector<const CBlockHeader*> vpHeader;
+    for (const CBlockHeader& header : vHeader)
+        vpHeader.push_back(&header);
+
+    std::vector<bool> vChecked;
+    std::vector<uint256> vHashPoW;
+    while (state.KeepRunning()) {
+        CheckBlockHeadersProofOfWork(vpHeader, vChecked, vHashPoW, params);
+        assert(std::count(vChecked.begin(), vChecked.end(), true) == (long)POW_HEADERS);
+    }
+}
+
+/* CheckAuxpow and the parent block scrypt for merge-mined headers, one at a time */
+static void CheckAuxpowPoW(benchmark::State& state)
+{
+    Consensus::Params params;
+    std::vector<CBlockHeader> vHeader;
+    BuildHeaders(vHeader, 1, params);
+
+    uint256 hashPoW;
+    while (state.KeepRunning()) {
+        for (const CBlockHeader& header : vHeader) {
+            bool fValid = CheckBlockProofOfWork(&header, params, &hashPoW);
+            assert(fValid);
+        }
+    }
+}
+
+/* The same merge-mined headers once their auxpows are in the validation cache */
+static void CheckAuxpowPoW_Cached(benchmark::State& state)
+{
+    Consensus::Params params;
+    std::vector<CBlockHeader> vHeader;
+    BuildHeaders(vHeader, 1, params);
+
+    while (state.KeepRunning()) {
+        for (const CBlockHeader& header : vHeader) {
+            bool fValid = CheckBlockProofOfWork(&header, params);
+            assert(fValid);
+        }
+    }
+}
+
+/* Plain headers one at a time, each scrypted (as when the PoW hash is asked for) or, as for
+ * a block whose header arrived first or from another peer, answered by the proof-of-work cache */
+static void CheckHeaderPoW(benchmark::State& state, bool fCached)
+{
+    Consensus::Params params;
+    std::vector<CBlockHeader> vHeader;
+    BuildHeaders(vHeader, 0, params);
+
+    uint256 hashPoW;
+    while (state.KeepRunning()) {
+        for (const CBlockHeader& header : vHeader) {
+            bool fValid = CheckBlockProofOfWork(&header, params, fCached ? nullptr : &hashPoW);
+            assert(fValid);
+        }
+    }
+}
+
+static void CheckHeaderPoW_Scrypt(benchmark::State& state)
+{
+    CheckHeaderPoW(state, false);
+}
+
+static void CheckHeaderPoW_Cached(benchmark::State& state)
+{
+    CheckHeaderPoW(state, true);
+}
+
+/* Loading a merge-mined block index entry: the old record with the auxpow inline, or the header-only record */
+static void DeserializeBlockIndex(benchmark::State& state, bool fAuxPowInline)
+{
+    Consensus::Params params;
+    std::vector<CBlockHeader> vHeader;
+    BuildHeaders(vHeader, 1, params);
+    std::vector<CDataStream> vStream;
+    for (const CBlockHeader& header : vHeader) {
+        CBlockIndex index(header);
+        CDiskBlockIndex diskindex(&index, header.auxpow);
+        vStream.emplace_back(SER_DISK, CLIENT_VERSION);
+        if (fAuxPowInline)
+            vStream.back() << diskindex;
+        else
+            vStream.back() << CDiskBlockIndexNoAuxPow(diskindex);
+    }
+
+    while (state.KeepRunning()) {
+        for (const CDataStream& ss : vStream) {
+            CDataStream ssRead(ss);
+            CDiskBlockIndex diskindex;
+            if (fAuxPowInline) {
+                ssRead >> diskindex;
+            } else {
+                CDiskBlockIndexNoAuxPow wrapper(diskindex);
+                ssRead >> wrapper;
+            }
+        }
+    }
+}
+
+static void DeserializeBlockIndex_AuxPowInline(benchmark::State& state)
+{
+    DeserializeBlockIndex(state, true);
+}
+
+static void DeserializeBlockIndex_HeaderOnly(benchmark::State& state)
+{
+    DeserializeBlockIndex(state, false);
+}
+
+BENCHMARK(NextWorkRequired_V1);
+BENCHMARK(NextWorkRequired_V2);
+BENCHMARK(NextWorkRequired_KGW);
+BENCHMARK(NextWorkRequired_KGW2);
+BENCHMARK(NextWorkRequired_KGW2_SameTip);
+
+BENCHMARK(CheckHeadersPoW);
+BENCHMARK(CheckAuxpowPoW);
+BENCHMARK(CheckAuxpowPoW_Cached);
+BENCHMARK(CheckHeaderPoW_Scrypt);
+BENCHMARK(CheckHeaderPoW_Cached);
+
+BENCHMARK(DeserializeBlockIndex_AuxPowInline);
+BENCHMARK(DeserializeBlockIndex_HeaderOnly);
@@ -4,8 +4,20 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include "chain.h"
+#include "auxpow/store.h"
+#include "memusage.h"
 #include "txdb.h"
 
+CBlockIndexArena::Stats CBlockIndexArena::GetStats() const
+{
+    Stats stats = {0, memusage::DynamicUsage(vSlabs)};
+    for (const std::vector<CBlockIndex>& slab : vSlabs) {
+        stats.entries += slab.size();
+        stats.bytes += memusage::DynamicUsage(slab);
+    }
+    return stats;
+}
+
 /**
  * CChain implementation
  */
@@ -30,13 +42,10 @@ CBlockHeader CBlockIndex::GetBlockHeader(const std::map<uint256, std::shared_ptr
         std::map<uint256, std::shared_ptr<CAuxPow> >::const_iterator it = mapDirtyAuxPow.find(*phashBlock);
         if (it != mapDirtyAuxPow.end()) {
             block.auxpow = it->second;
-        } else {
-            CDiskBlockIndex diskblockindex;
-            // auxpow is not in memory, load CDiskBlockHeader
-            // from database to get it
-
-            assert(pblocktree->ReadDiskBlockIndex(*phashBlock, diskblockindex));
-            block.auxpow = diskblockindex.auxpow;
+        } else if (!(block.auxpow = auxpowStore.Get(*phashBlock))) {
+            // auxpow is not in memory, load it from the database
+            assert(pblocktree->ReadAuxPow(*phashBlock, block.auxpow));
+            auxpowStore.Put(*phashBlock, block.auxpow);
         }
     }
 
@@ -397,6 +397,15 @@ public:
 
     template <typename Stream, typename Operation>
     inline void SerializationOp(Stream& s, Operation ser_action) {
+        SerializeIndex(s, ser_action);
+        // auxpow is not part of the block hash
+        if ((!(s.GetType() & SER_GETHASH)) && this->IsAuxPow())
+            READWRITE(auxpow);
+    }
+
+    //! Everything but the auxpow
+    template <typename Stream, typename Operation>
+    inline void SerializeIndex(Stream& s, Operation ser_action) {
         int _nVersion = s.GetVersion();
         if (!(s.GetType() & SER_GETHASH))
             READWRITE(VARINT(_nVersion));
@@ -418,9 +427,6 @@ public:
         READWRITE(nTime);
         READWRITE(nBits);
         READWRITE(nNonce);
-        // auxpow is not part of the block hash
-        if ((!(s.GetType() & SER_GETHASH)) && this->IsAuxPow())
-            READWRITE(auxpow);
     }
 
     uint256 GetBlockHash() const
@@ -452,6 +458,58 @@ public:
     }
 };
 
+/** Wrapper that (un)serializes a CDiskBlockIndex without its auxpow, which the block tree stores under a key of its own. */
+class CDiskBlockIndexNoAuxPow
+{
+private:
+    CDiskBlockIndex& index;
+
+public:
+    explicit CDiskBlockIndexNoAuxPow(CDiskBlockIndex& indexIn) : index(indexIn) { }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        index.SerializeIndex(s, ser_action);
+    }
+};
+
+/**
+ * Allocates block index entries from slabs of SLAB_ENTRIES, rather than one
+ * heap block each. Entries are never freed one at a time; Clear() releases
+ * all of them, which is how UnloadBlockIndex() gets rid of the index.
+ */
+class CBlockIndexArena
+{
+private:
+    static const size_t SLAB_ENTRIES = 4096;
+    std::vector<std::vector<CBlockIndex> > vSlabs;
+
+public:
+    struct Stats
+    {
+        size_t entries;
+        size_t bytes;
+    };
+
+    /** Construct an entry from args. It stays valid until Clear(). */
+    template <typename... Args>
+    CBlockIndex* Allocate(Args&&... args)
+    {
+        if (vSlabs.empty() || vSlabs.back().size() == vSlabs.back().capacity()) {
+            vSlabs.emplace_back();
+            vSlabs.back().reserve(SLAB_ENTRIES);
+        }
+        vSlabs.back().emplace_back(std::forward<Args>(args)...);
+        return &vSlabs.back().back();
+    }
+
+    void Clear() { vSlabs.clear(); }
+    void Swap(CBlockIndexArena& other) { vSlabs.swap(other.vSlabs); }
+    Stats GetStats() const;
+};
+
 /** An in-memory indexed chain of blocks. */
 class CChain {
 private:
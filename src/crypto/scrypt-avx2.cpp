@@ -0,0 +1,159 @@
+/*
+ * Copyright 2009 Colin Percival, 2011 ArtForz, 2012-2013 pooler
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file was originally written by Colin Percival as part of the Tarsnap
+ * online backup system.
+ */
+
+/*
+ * 8-way interleaved scrypt(1024,1,1) core. Lane l of every __m256i holds the
+ * corresponding 32-bit word of the l-th header, so one Salsa20/8 round works
+ * on eight independent hashes at once. The scratchpad uses the same
+ * interleaved layout and the data-dependent reads of the second loop are
+ * done with a gather.
+ */
+
+#if defined(ENABLE_AVX2)
+
+#include "crypto/scrypt.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <immintrin.h>
+
+#define LANES 8
+
+static inline __m256i rotl_avx2(__m256i x, int n)
+{
+	return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n));
+}
+
+static inline void xor_salsa8_avx2(__m256i B[16], const __m256i Bx[16])
+{
+	__m256i x[16];
+	int i;
+
+	for (i = 0; i < 16; i++)
+		x[i] = B[i] = _mm256_xor_si256(B[i], Bx[i]);
+
+	for (i = 0; i < 8; i += 2) {
+		/* Operate on columns. */
+		x[ 4] = _mm256_xor_si256(x[ 4], rotl_avx2(_mm256_add_epi32(x[ 0], x[12]),  7));
+		x[ 9] = _mm256_xor_si256(x[ 9], rotl_avx2(_mm256_add_epi32(x[ 5], x[ 1]),  7));
+		x[14] = _mm256_xor_si256(x[14], rotl_avx2(_mm256_add_epi32(x[10], x[ 6]),  7));
+		x[ 3] = _mm256_xor_si256(x[ 3], rotl_avx2(_mm256_add_epi32(x[15], x[11]),  7));
+
+		x[ 8] = _mm256_xor_si256(x[ 8], rotl_avx2(_mm256_add_epi32(x[ 4], x[ 0]),  9));
+		x[13] = _mm256_xor_si256(x[13], rotl_avx2(_mm256_add_epi32(x[ 9], x[ 5]),  9));
+		x[ 2] = _mm256_xor_si256(x[ 2], rotl_avx2(_mm256_add_epi32(x[14], x[10]),  9));
+		x[ 7] = _mm256_xor_si256(x[ 7], rotl_avx2(_mm256_add_epi32(x[ 3], x[15]),  9));
+
+		x[12] = _mm256_xor_si256(x[12], rotl_avx2(_mm256_add_epi32(x[ 8], x[ 4]), 13));
+		x[ 1] = _mm256_xor_si256(x[ 1], rotl_avx2(_mm256_add_epi32(x[13], x[ 9]), 13));
+		x[ 6] = _mm256_xor_si256(x[ 6], rotl_avx2(_mm256_add_epi32(x[ 2], x[14]), 13));
+		x[11] = _mm256_xor_si256(x[11], rotl_avx2(_mm256_add_epi32(x[ 7], x[ 3]), 13));
+
+		x[ 0] = _mm256_xor_si256(x[ 0], rotl_avx2(_mm256_add_epi32(x[12], x[ 8]), 18));
+		x[ 5] = _mm256_xor_si256(x[ 5], rotl_avx2(_mm256_add_epi32(x[ 1], x[13]), 18));
+		x[10] = _mm256_xor_si256(x[10], rotl_avx2(_mm256_add_epi32(x[ 6], x[ 2]), 18));
+		x[15] = _mm256_xor_si256(x[15], rotl_avx2(_mm256_add_epi32(x[11], x[ 7]), 18));
+
+		/* Operate on rows. */
+		x[ 1] = _mm256_xor_si256(x[ 1], rotl_avx2(_mm256_add_epi32(x[ 0], x[ 3]),  7));
+		x[ 6] = _mm256_xor_si256(x[ 6], rotl_avx2(_mm256_add_epi32(x[ 5], x[ 4]),  7));
+		x[11] = _mm256_xor_si256(x[11], rotl_avx2(_mm256_add_epi32(x[10], x[ 9]),  7));
+		x[12] = _mm256_xor_si256(x[12], rotl_avx2(_mm256_add_epi32(x[15], x[14]),  7));
+
+		x[ 2] = _mm256_xor_si256(x[ 2], rotl_avx2(_mm256_add_epi32(x[ 1], x[ 0]),  9));
+		x[ 7] = _mm256_xor_si256(x[ 7], rotl_avx2(_mm256_add_epi32(x[ 6], x[ 5]),  9));
+		x[ 8] = _mm256_xor_si256(x[ 8], rotl_avx2(_mm256_add_epi32(x[11], x[10]),  9));
+		x[13] = _mm256_xor_si256(x[13], rotl_avx2(_mm256_add_epi32(x[12], x[15]),  9));
+
+		x[ 3] = _mm256_xor_si256(x[ 3], rotl_avx2(_mm256_add_epi32(x[ 2], x[ 1]), 13));
+		x[ 4] = _mm256_xor_si256(x[ 4], rotl_avx2(_mm256_add_epi32(x[ 7], x[ 6]), 13));
+		x[ 9] = _mm256_xor_si256(x[ 9], rotl_avx2(_mm256_add_epi32(x[ 8], x[11]), 13));
+		x[14] = _mm256_xor_si256(x[14], rotl_avx2(_mm256_add_epi32(x[13], x[12]), 13));
+
+		x[ 0] = _mm256_xor_si256(x[ 0], rotl_avx2(_mm256_add_epi32(x[ 3], x[ 2]), 18));
+		x[ 5] = _mm256_xor_si256(x[ 5], rotl_avx2(_mm256_add_epi32(x[ 4], x[ 7]), 18));
+		x[10] = _mm256_xor_si256(x[10], rotl_avx2(_mm256_add_epi32(x[ 9], x[ 8]), 18));
+		x[15] = _mm256_xor_si256(x[15], rotl_avx2(_mm256_add_epi32(x[14], x[13]), 18));
+	}
+
+	for (i = 0; i < 16; i++)
+		B[i] = _mm256_add_epi32(B[i], x[i]);
+}
+
+void scrypt_1024_1_1_256_sp_avx2(const char *const input[8], char *const output[8], char *scratchpad, const ScryptMidstate *midstate)
+{
+	ScryptHeaderKey key[LANES];
+	uint8_t B[LANES][128];
+	union {
+		__m256i i256[32];
+		uint32_t u32[32][LANES];
+	} X;
+	__m256i *V;
+	__m256i lane, mask, idx;
+	uint32_t i, k, l;
+
+	V = (__m256i *)(((uintptr_t)(scratchpad) + 63) & ~ (uintptr_t)(63));
+
+	for (l = 0; l < LANES; l++)
+		scrypt_pbkdf2_begin(input[l], midstate, &key[l], B[l]);
+
+	for (k = 0; k < 32; k++)
+		for (l = 0; l < LANES; l++)
+			X.u32[k][l] = le32dec(&B[l][4 * k]);
+
+	for (i = 0; i < 1024; i++) {
+		for (k = 0; k < 32; k++)
+			_mm256_store_si256(&V[i * 32 + k], X.i256[k]);
+		xor_salsa8_avx2(&X.i256[0], &X.i256[16]);
+		xor_salsa8_avx2(&X.i256[16], &X.i256[0]);
+	}
+
+	/* Word k of lane l of block j lives at 32-bit offset (j * 32 + k) * 8 + l. */
+	lane = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+	mask = _mm256_set1_epi32(1023);
+	for (i = 0; i < 1024; i++) {
+		idx = _mm256_add_epi32(_mm256_slli_epi32(_mm256_and_si256(X.i256[16], mask), 8), lane);
+		for (k = 0; k < 32; k++) {
+			__m256i v = _mm256_i32gather_epi32((const int *)V, _mm256_add_epi32(idx, _mm256_set1_epi32(k * LANES)), 4);
+			X.i256[k] = _mm256_xor_si256(X.i256[k], v);
+		}
+		xor_salsa8_avx2(&X.i256[0], &X.i256[16]);
+		xor_salsa8_avx2(&X.i256[16], &X.i256[0]);
+	}
+
+	for (k = 0; k < 32; k++)
+		for (l = 0; l < LANES; l++)
+			le32enc(&B[l][4 * k], X.u32[k][l]);
+
+	for (l = 0; l < LANES; l++)
+		scrypt_pbkdf2_end(&key[l], B[l], output[l]);
+}
+
+#endif // ENABLE_AVX2
@@ -96,6 +96,7 @@ static inline void xor_salsa8_sse2(__m128i B[4], const __m128i Bx[4])
 
 void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchpad)
 {
+	ScryptHeaderKey key;
 	uint8_t B[128];
 	union {
 		__m128i i128[8];
@@ -106,7 +107,7 @@ void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchp
 
 	V = (__m128i *)(((uintptr_t)(scratchpad) + 63) & ~ (uintptr_t)(63));
 
-	PBKDF2_SHA256((const uint8_t *)input, 80, (const uint8_t *)input, 80, 1, B, 128);
+	scrypt_pbkdf2_begin(input, nullptr, &key, B);
 
 	for (k = 0; k < 2; k++) {
 		for (i = 0; i < 16; i++) {
@@ -134,7 +135,7 @@ void scrypt_1024_1_1_256_sp_sse2(const char *input, char *output, char *scratchp
 		}
 	}
 
-	PBKDF2_SHA256((const uint8_t *)input, 80, B, 128, 1, (uint8_t *)output, 32);
+	scrypt_pbkdf2_end(&key, B, output);
 }
 
 #endif // USE_SSE2
@@ -28,12 +28,23 @@
  */
 
 #include "crypto/scrypt.h"
+#include "crypto/common.h"
 //#include "util.h"
+#include <assert.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include <openssl/sha.h>
 
+#include <atomic>
+#include <mutex>
+
+#if defined(WIN32)
+#include <malloc.h> // for _aligned_malloc
+#else
+#include <sys/mman.h> // for madvise
+#endif
+
 #if defined(USE_SSE2) && !defined(USE_SSE2_ALWAYS)
 #ifdef _MSC_VER
 // MSVC 64bit is unable to use inline asm
@@ -44,6 +55,12 @@
 #endif
 #endif
 
+#if (defined(ENABLE_AVX2) || defined(ENABLE_AVX512)) && !defined(BUILD_BITCOIN_INTERNAL) && \
+    (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+#define USE_SCRYPT_MULTI 1
+#include <cpuid.h>
+#endif
+
 static inline uint32_t be32dec(const void *pp)
 {
 	const uint8_t *p = (uint8_t const *)pp;
@@ -185,6 +202,72 @@ PBKDF2_SHA256(const uint8_t *passwd, size_t passwdlen, const uint8_t *salt,
 	memset(&PShctx, 0, sizeof(HMAC_SHA256_CTX));
 }
 
+static_assert(sizeof(SHA256_CTX) <= sizeof(ScryptMidstate::ctx), "ScryptMidstate too small");
+static_assert(sizeof(HMAC_SHA256_CTX) <= sizeof(ScryptHeaderKey::ctx), "ScryptHeaderKey too small");
+
+void scrypt_header_midstate(const char *input, ScryptMidstate *midstate)
+{
+	SHA256_CTX *ctx = (SHA256_CTX *)midstate->ctx;
+
+	SHA256_Init(ctx);
+	SHA256_Update(ctx, input, 64);
+}
+
+/* PBKDF2(P, S, 1, dkLen) with Pctx already keyed with P. */
+static void
+PBKDF2_SHA256_keyed(const HMAC_SHA256_CTX *Pctx, const uint8_t *salt,
+    size_t saltlen, uint8_t *buf, size_t dkLen)
+{
+	HMAC_SHA256_CTX PShctx, hctx;
+	size_t i;
+	uint8_t ivec[4];
+	uint8_t U[32];
+	size_t clen;
+
+	memcpy(&PShctx, Pctx, sizeof(HMAC_SHA256_CTX));
+	HMAC_SHA256_Update(&PShctx, salt, saltlen);
+
+	for (i = 0; i * 32 < dkLen; i++) {
+		be32enc(ivec, (uint32_t)(i + 1));
+		memcpy(&hctx, &PShctx, sizeof(HMAC_SHA256_CTX));
+		HMAC_SHA256_Update(&hctx, ivec, 4);
+		HMAC_SHA256_Final(U, &hctx);
+
+		clen = dkLen - i * 32;
+		if (clen > 32)
+			clen = 32;
+		memcpy(&buf[i * 32], U, clen);
+	}
+
+	memset(&PShctx, 0, sizeof(HMAC_SHA256_CTX));
+}
+
+void scrypt_pbkdf2_begin(const char *input, const ScryptMidstate *midstate, ScryptHeaderKey *key, uint8_t B[128])
+{
+	HMAC_SHA256_CTX *hctx = (HMAC_SHA256_CTX *)key->ctx;
+	SHA256_CTX kctx;
+	unsigned char khash[32];
+
+	/* An 80-byte HMAC key is really SHA256(key), of which the first block may be done already. */
+	if (midstate) {
+		memcpy(&kctx, midstate->ctx, sizeof(SHA256_CTX));
+		SHA256_Update(&kctx, input + 64, 16);
+	} else {
+		SHA256_Init(&kctx);
+		SHA256_Update(&kctx, input, 80);
+	}
+	SHA256_Final(khash, &kctx);
+	HMAC_SHA256_Init(hctx, khash, 32);
+	memset(khash, 0, 32);
+
+	PBKDF2_SHA256_keyed(hctx, (const uint8_t *)input, 80, B, 128);
+}
+
+void scrypt_pbkdf2_end(const ScryptHeaderKey *key, const uint8_t B[128], char *output)
+{
+	PBKDF2_SHA256_keyed((const HMAC_SHA256_CTX *)key->ctx, B, 128, (uint8_t *)output, 32);
+}
+
 #define ROTL(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
 
 static inline void xor_salsa8(uint32_t B[16], const uint32_t Bx[16])
@@ -255,6 +338,7 @@ static inline void xor_salsa8(uint32_t B[16], const uint32_t Bx[16])
 
 void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scratchpad)
 {
+	ScryptHeaderKey key;
 	uint8_t B[128];
 	uint32_t X[32];
 	uint32_t *V;
@@ -262,7 +346,7 @@ void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scrat
 
 	V = (uint32_t *)(((uintptr_t)(scratchpad) + 63) & ~ (uintptr_t)(63));
 
-	PBKDF2_SHA256((const uint8_t *)input, 80, (const uint8_t *)input, 80, 1, B, 128);
+	scrypt_pbkdf2_begin(input, nullptr, &key, B);
 
 	for (k = 0; k < 32; k++)
 		X[k] = le32dec(&B[4 * k]);
@@ -283,7 +367,7 @@ void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scrat
 	for (k = 0; k < 32; k++)
 		le32enc(&B[4 * k], X[k]);
 
-	PBKDF2_SHA256((const uint8_t *)input, 80, B, 128, 1, (uint8_t *)output, 32);
+	scrypt_pbkdf2_end(&key, B, output);
 }
 
 #if defined(USE_SSE2)
@@ -324,8 +408,237 @@ std::string scrypt_detect_sse2()
 }
 #endif
 
+/** Bytes of scratchpad per lane; the arenas below are already 64-byte aligned. */
+static const size_t SCRYPT_LANE_BYTES = SCRYPT_SCRATCHPAD_SIZE - 63;
+/** Scratchpads at least this big are worth backing with transparent huge pages. */
+static const size_t SCRYPT_HUGEPAGE_SIZE = 2 * 1024 * 1024;
+
+static std::atomic<uint64_t> scrypt_scratchpad_allocations{0};
+static std::atomic<uint64_t> scrypt_scratchpad_threads{0};
+static std::atomic<uint64_t> scrypt_scratchpad_bytes{0};
+static std::atomic<uint64_t> scrypt_scratchpad_hugepage_bytes{0};
+
+static void *scrypt_aligned_alloc(size_t alignment, size_t size)
+{
+#if defined(WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    void *p = nullptr;
+    return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+#endif
+}
+
+static void scrypt_aligned_free(void *p)
+{
+#if defined(WIN32)
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+namespace {
+/** Scratchpad owned by one thread, kept between hashes so they reuse warm memory. */
+class ScryptArena
+{
+private:
+    char *data = nullptr;
+    size_t size = 0;
+    bool hugepage = false;
+
+    void release()
+    {
+        if (!data)
+            return;
+        scrypt_aligned_free(data);
+        scrypt_scratchpad_bytes -= size;
+        if (hugepage)
+            scrypt_scratchpad_hugepage_bytes -= size;
+        scrypt_scratchpad_threads--;
+        data = nullptr;
+        size = 0;
+        hugepage = false;
+    }
+
+public:
+    ~ScryptArena()
+    {
+        release();
+    }
+
+    char *get(size_t lanes)
+    {
+        const size_t needed = lanes * SCRYPT_LANE_BYTES;
+        if (needed <= size)
+            return data;
+        release();
+
+        const bool huge = needed >= SCRYPT_HUGEPAGE_SIZE;
+        void *p = scrypt_aligned_alloc(huge ? SCRYPT_HUGEPAGE_SIZE : 64, needed);
+        if (!p)
+            return nullptr;
+#if defined(MADV_HUGEPAGE)
+        // Only a hint; the kernel may ignore it
+        if (huge)
+            hugepage = madvise(p, needed, MADV_HUGEPAGE) == 0;
+#endif
+        data = (char *)p;
+        size = needed;
+        scrypt_scratchpad_allocations++;
+        scrypt_scratchpad_threads++;
+        scrypt_scratchpad_bytes += size;
+        if (hugepage)
+            scrypt_scratchpad_hugepage_bytes += size;
+        return data;
+    }
+};
+} // namespace
+
+char *scrypt_scratchpad(size_t lanes)
+{
+    static thread_local ScryptArena arena;
+    return arena.get(lanes);
+}
+
+ScryptScratchpadStats scrypt_scratchpad_stats()
+{
+    ScryptScratchpadStats stats;
+    stats.allocations = scrypt_scratchpad_allocations;
+    stats.threads = scrypt_scratchpad_threads;
+    stats.bytes = scrypt_scratchpad_bytes;
+    stats.hugepage_bytes = scrypt_scratchpad_hugepage_bytes;
+    return stats;
+}
+
 void scrypt_1024_1_1_256(const char *input, char *output)
 {
-	char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
-    scrypt_1024_1_1_256_sp(input, output, scratchpad);
+    char *scratchpad = scrypt_scratchpad(1);
+    if (scratchpad) {
+        scrypt_1024_1_1_256_sp(input, output, scratchpad);
+        return;
+    }
+    char stack_scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+    scrypt_1024_1_1_256_sp(input, output, stack_scratchpad);
+}
+
+typedef void (*scrypt_multi_kernel)(const char *const input[], char *const output[], char *scratchpad, const ScryptMidstate *midstate);
+
+/* The multi-buffer kernels this CPU supports, set once by scrypt_detect_multi() */
+static scrypt_multi_kernel scrypt_multi_avx2 = nullptr;
+static scrypt_multi_kernel scrypt_multi_avx512 = nullptr;
+static std::once_flag scrypt_multi_detect_once;
+
+/** The widest supported kernel of at most nMaxLanes lanes, or nullptr */
+static scrypt_multi_kernel scrypt_multi_pick(size_t nMaxLanes, size_t *lanes)
+{
+    if (nMaxLanes >= 16 && scrypt_multi_avx512) {
+        *lanes = 16;
+        return scrypt_multi_avx512;
+    }
+    if (nMaxLanes >= 8 && scrypt_multi_avx2) {
+        *lanes = 8;
+        return scrypt_multi_avx2;
+    }
+    *lanes = 1;
+    return nullptr;
+}
+
+size_t scrypt_multi_lanes(size_t nMaxLanes)
+{
+    size_t lanes;
+    scrypt_multi_pick(nMaxLanes, &lanes);
+    return lanes;
+}
+
+void scrypt_1024_1_1_256_multi(const char *const inputs[], char *const outputs[], size_t n, const ScryptMidstate *midstate, size_t nMaxLanes)
+{
+    size_t i = 0;
+    size_t lanes;
+    scrypt_multi_kernel kernel = scrypt_multi_pick(nMaxLanes, &lanes);
+    if (kernel && n >= lanes) {
+        char *scratchpad = scrypt_scratchpad(lanes);
+        if (scratchpad) {
+            for (; i + lanes <= n; i += lanes)
+                kernel(&inputs[i], &outputs[i], scratchpad, midstate);
+        }
+    }
+    for (; i < n; i++)
+        scrypt_1024_1_1_256(inputs[i], outputs[i]);
+}
+
+#if defined(USE_SCRYPT_MULTI)
+/** Check that a multi-buffer kernel agrees with the generic code on distinct inputs in every lane. */
+static bool scrypt_multi_self_test(scrypt_multi_kernel kernel, size_t lanes)
+{
+    char in[SCRYPT_MULTI_MAX_LANES][80];
+    char out[SCRYPT_MULTI_MAX_LANES][32];
+    char expected[32];
+    const char *pin[SCRYPT_MULTI_MAX_LANES];
+    char *pout[SCRYPT_MULTI_MAX_LANES];
+    char *scratchpad = (char *)malloc(lanes * (SCRYPT_SCRATCHPAD_SIZE - 63) + 63);
+    char generic_scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+    bool ret = scratchpad != nullptr;
+
+    for (size_t l = 0; l < lanes; l++) {
+        for (int b = 0; b < 80; b++)
+            in[l][b] = (char)(l * 80 + b);
+        pin[l] = in[l];
+        pout[l] = out[l];
+    }
+    if (ret)
+        kernel(pin, pout, scratchpad, nullptr);
+    for (size_t l = 0; ret && l < lanes; l++) {
+        scrypt_1024_1_1_256_sp_generic(in[l], expected, generic_scratchpad);
+        ret = memcmp(out[l], expected, 32) == 0;
+    }
+    free(scratchpad);
+    return ret;
+}
+
+/** Whether the OS saves the given XCR0 state components on context switch. */
+static bool scrypt_xcr0_enabled(uint32_t mask)
+{
+    uint32_t eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !((ecx >> 27) & 1))
+        return false; // no OSXSAVE
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    return (xcr0_lo & mask) == mask;
+}
+#endif
+
+static void scrypt_detect_multi_kernels()
+{
+#if defined(USE_SCRYPT_MULTI)
+    uint32_t eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+#if defined(ENABLE_AVX512)
+        // AVX512F, with opmask, ZMM_Hi256 and Hi16_ZMM state enabled by the OS.
+        if (((ebx >> 16) & 1) && scrypt_xcr0_enabled(0xe6)) {
+            assert(scrypt_multi_self_test(&scrypt_1024_1_1_256_sp_avx512, 16));
+            scrypt_multi_avx512 = &scrypt_1024_1_1_256_sp_avx512;
+        }
+#endif
+#if defined(ENABLE_AVX2)
+        // AVX2, with XMM and YMM state enabled by the OS.
+        if (((ebx >> 5) & 1) && scrypt_xcr0_enabled(0x6)) {
+            assert(scrypt_multi_self_test(&scrypt_1024_1_1_256_sp_avx2, 8));
+            scrypt_multi_avx2 = &scrypt_1024_1_1_256_sp_avx2;
+        }
+#endif
+    }
+#endif
+}
+
+std::string scrypt_detect_multi()
+{
+    // Kernels are only found once: miners and block validation may already
+    // be hashing through them when this is called again.
+    std::call_once(scrypt_multi_detect_once, scrypt_detect_multi_kernels);
+    switch (scrypt_multi_lanes()) {
+    case 16: return "scrypt: using 16-way avx512 multi-buffer kernel";
+    case 8: return "scrypt: using 8-way avx2 multi-buffer kernel";
+    }
+    return "scrypt: no multi-buffer kernel, hashing one input at a time";
 }
@@ -2,14 +2,88 @@
 #define SCRYPT_H
 #include <stdlib.h>
 #include <stdint.h>
+#include <string>
 
 static const int SCRYPT_SCRATCHPAD_SIZE = 131072 + 63;
 
+/** Widest multi-buffer kernel (AVX-512F, 16 lanes of 32-bit words). */
+static const size_t SCRYPT_MULTI_MAX_LANES = 16;
+
+/** Hash one 80-byte input using this thread's scratchpad (see scrypt_scratchpad). */
 void scrypt_1024_1_1_256(const char *input, char *output);
 void scrypt_1024_1_1_256_sp_generic(const char *input, char *output, char *scratchpad);
 
+/**
+ * SHA256 state after the first 64 bytes of an 80-byte header, which stay the same
+ * while grinding nonces. Holds an OpenSSL SHA256_CTX, opaque outside scrypt.cpp.
+ */
+struct ScryptMidstate
+{
+    alignas(8) unsigned char ctx[128];
+};
+
+/** HMAC-SHA256 inner and outer states keyed with one 80-byte header. */
+struct ScryptHeaderKey
+{
+    alignas(8) unsigned char ctx[256];
+};
+
+void scrypt_header_midstate(const char *input, ScryptMidstate *midstate);
+
+/**
+ * The PBKDF2-SHA256 steps around the scrypt core: B = PBKDF2(input, input, 1, 128)
+ * and output = PBKDF2(input, B, 1, 32). The HMAC key is set up once, in
+ * scrypt_pbkdf2_begin, and reused by scrypt_pbkdf2_end. If midstate is not null it
+ * must come from a header with the same first 64 bytes as input.
+ */
+void scrypt_pbkdf2_begin(const char *input, const ScryptMidstate *midstate, ScryptHeaderKey *key, uint8_t B[128]);
+void scrypt_pbkdf2_end(const ScryptHeaderKey *key, const uint8_t B[128], char *output);
+
+/**
+ * Hash n 80-byte inputs, scrypt_multi_lanes(nMaxLanes) at a time with the
+ * widest kernel found by scrypt_detect_multi() of at most nMaxLanes lanes.
+ * Inputs left over after the last full pass (or all of them if no multi-buffer
+ * kernel is available) go through scrypt_1024_1_1_256_sp.
+ * If midstate is not null all inputs must share the first 64 bytes it was made
+ * from, and the multi-buffer kernels skip hashing them for every input.
+ * Tests and benchmarks pass nMaxLanes to exercise the narrower kernels.
+ */
+void scrypt_1024_1_1_256_multi(const char *const inputs[], char *const outputs[], size_t n, const ScryptMidstate *midstate = nullptr, size_t nMaxLanes = SCRYPT_MULTI_MAX_LANES);
+
+/** Number of inputs the kernel used for nMaxLanes hashes per pass (1 if none). */
+size_t scrypt_multi_lanes(size_t nMaxLanes = SCRYPT_MULTI_MAX_LANES);
+
+/**
+ * Find the multi-buffer kernels this CPU supports and self-test them against
+ * the generic code, the first time it is called.
+ * Returns a description of the widest one.
+ */
+std::string scrypt_detect_multi();
+
+/**
+ * This thread's scratchpad, 64-byte aligned, with room for `lanes` interleaved
+ * hashes. Allocated on first use, grown when a wider kernel asks for more and
+ * freed when the thread exits; scratchpads of 2 MiB or more are backed by
+ * transparent huge pages where the OS supports them. Returns nullptr if the
+ * allocation fails.
+ */
+char *scrypt_scratchpad(size_t lanes);
+
+struct ScryptScratchpadStats
+{
+    uint64_t allocations; //!< Scratchpads allocated or grown since startup
+    uint64_t threads;     //!< Threads currently holding a scratchpad
+    uint64_t bytes;       //!< Bytes currently held by all threads
+    uint64_t hugepage_bytes; //!< Part of bytes advised to use huge pages
+};
+
+ScryptScratchpadStats scrypt_scratchpad_stats();
+
+/** Multi-buffer kernels, only built with ENABLE_AVX2/ENABLE_AVX512 and only safe to call after scrypt_detect_multi(). */
+void scrypt_1024_1_1_256_sp_avx2(const char *const input[8], char *const output[8], char *scratchpad, const ScryptMidstate *midstate);
+void scrypt_1024_1_1_256_sp_avx512(const char *const input[16], char *const output[16], char *scratchpad, const ScryptMidstate *midstate);
+
 #if defined(USE_SSE2)
-#include <string>
 #if defined(_M_X64) || defined(__x86_64__) || defined(_M_AMD64) || (defined(MAC_OSX) && defined(__i386__))
 #define USE_SSE2_ALWAYS 1
 #define scrypt_1024_1_1_256_sp(input, output, scratchpad) scrypt_1024_1_1_256_sp_sse2((input), (output), (scratchpad))
@@ -7,7 +7,9 @@
 
 #include <assert.h>
 #include <string.h>
+#include <algorithm>
 #include <atomic>
+#include <mutex>
 
 #if defined(__x86_64__) || defined(__amd64__)
 #if defined(EXPERIMENTAL_ASM)
@@ -17,6 +19,18 @@ namespace sha256_sse4
 void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 }
 #endif
+namespace sha256_sse2
+{
+void Transform_4way(uint32_t* s, const unsigned char* const chunk[4]);
+}
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+#define USE_SHA256_AVX2 1
+#include <cpuid.h>
+namespace sha256_avx2
+{
+void Transform_8way(uint32_t* s, const unsigned char* const chunk[8]);
+}
+#endif
 #endif
 
 // Internal implementation code.
@@ -174,21 +188,214 @@ bool SelfTest(TransformType tr) {
 
 TransformType Transform = sha256::Transform;
 
+/**
+ * One 64-byte block for each lane of a multi-lane transform. The states are
+ * interleaved: word w of lane l is at s[w * lanes + l].
+ */
+typedef void (*TransformLanesType)(uint32_t* s, const unsigned char* const chunk[]);
+
+/** The multi-lane transforms this CPU supports, set once by DetectLanes. */
+TransformLanesType Transform4Way = nullptr;
+TransformLanesType Transform8Way = nullptr;
+std::once_flag detectLanesOnce;
+
+/** The widest supported transform of at most nMaxLanes lanes, or nullptr */
+TransformLanesType PickLanes(size_t nMaxLanes, size_t& lanes)
+{
+    if (nMaxLanes >= 8 && Transform8Way) {
+        lanes = 8;
+        return Transform8Way;
+    }
+    if (nMaxLanes >= 4 && Transform4Way) {
+        lanes = 4;
+        return Transform4Way;
+    }
+    lanes = 1;
+    return nullptr;
+}
+
+/**
+ * Double-SHA256 of n inputs through the multi-lane transform. Each lane
+ * works through one input: its full 64-byte blocks straight from memory,
+ * then the padded tail, then the single block of the second hash. A lane
+ * that finishes its input picks up the next one, so inputs of different
+ * lengths keep all lanes busy until the last few.
+ */
+void SHA256DLanes(TransformLanesType transform, size_t lanes, unsigned char* const out[], const unsigned char* const in[], const size_t len[], size_t n)
+{
+    static const unsigned char zero[64] = {0};
+    struct Lane {
+        size_t job;               //!< input being hashed, or n when idle
+        const unsigned char* data; //!< next full block of the input
+        size_t nFull;             //!< full blocks of the input left
+        unsigned char tail[128];  //!< padded tail, or the second hash's block
+        size_t nTail;             //!< blocks in tail
+        size_t iTail;             //!< next block of tail
+        bool fSecond;             //!< working on the second hash
+    };
+    Lane lane[SHA256_MAX_LANES];
+    uint32_t s[8 * SHA256_MAX_LANES];
+    const unsigned char* chunk[SHA256_MAX_LANES];
+    uint32_t init[8];
+    sha256::Initialize(init);
+
+    size_t next = 0;
+    for (size_t l = 0; l < lanes; l++)
+        lane[l].job = n;
+    while (true) {
+        size_t nActive = 0;
+        for (size_t l = 0; l < lanes; l++) {
+            Lane& ln = lane[l];
+            if (ln.job == n && next < n) {
+                ln.job = next++;
+                size_t nRem = len[ln.job] % 64;
+                ln.data = in[ln.job];
+                ln.nFull = len[ln.job] / 64;
+                ln.nTail = nRem + 9 > 64 ? 2 : 1;
+                ln.iTail = 0;
+                ln.fSecond = false;
+                if (nRem)
+                    memcpy(ln.tail, ln.data + ln.nFull * 64, nRem);
+                ln.tail[nRem] = 0x80;
+                memset(ln.tail + nRem + 1, 0, ln.nTail * 64 - nRem - 9);
+                WriteBE64(ln.tail + ln.nTail * 64 - 8, (uint64_t)len[ln.job] << 3);
+                for (int w = 0; w < 8; w++)
+                    s[w * lanes + l] = init[w];
+            }
+            if (ln.job == n) {
+                chunk[l] = zero;
+            } else {
+                chunk[l] = ln.nFull ? ln.data : ln.tail + ln.iTail * 64;
+                nActive++;
+            }
+        }
+        if (!nActive)
+            break;
+
+        transform(s, chunk);
+
+        for (size_t l = 0; l < lanes; l++) {
+            Lane& ln = lane[l];
+            if (ln.job == n)
+                continue;
+            if (ln.nFull) {
+                ln.data += 64;
+                ln.nFull--;
+            } else {
+                ln.iTail++;
+            }
+            if (ln.nFull || ln.iTail < ln.nTail)
+                continue;
+            unsigned char* digest = ln.fSecond ? out[ln.job] : ln.tail;
+            for (int w = 0; w < 8; w++)
+                WriteBE32(digest + 4 * w, s[w * lanes + l]);
+            if (ln.fSecond) {
+                ln.job = n;
+                continue;
+            }
+            // Hash the 32-byte digest again, padded to a single block
+            ln.tail[32] = 0x80;
+            memset(ln.tail + 33, 0, 64 - 33 - 8);
+            WriteBE64(ln.tail + 56, 256);
+            ln.nTail = 1;
+            ln.iTail = 0;
+            ln.fSecond = true;
+            for (int w = 0; w < 8; w++)
+                s[w * lanes + l] = init[w];
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__amd64__)
+void Transform_4way(uint32_t* s, const unsigned char* const chunk[]) { sha256_sse2::Transform_4way(s, chunk); }
+#endif
+#if defined(USE_SHA256_AVX2)
+void Transform_8way(uint32_t* s, const unsigned char* const chunk[]) { sha256_avx2::Transform_8way(s, chunk); }
+
+/** Whether the OS saves the given XCR0 state components on context switch. */
+bool XCR0Enabled(uint32_t mask)
+{
+    uint32_t eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !((ecx >> 27) & 1))
+        return false; // no OSXSAVE
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    return (xcr0_lo & mask) == mask;
+}
+#endif
+
+void SHA256DScalar(unsigned char* out, const unsigned char* in, size_t len)
+{
+    unsigned char buf[CSHA256::OUTPUT_SIZE];
+    CSHA256().Write(in, len).Finalize(buf);
+    CSHA256().Write(buf, sizeof(buf)).Finalize(out);
+}
+
+/** Check a multi-lane transform against the scalar one on inputs around the padding boundaries. */
+bool SelfTestLanes(TransformLanesType transform, size_t lanes)
+{
+    static const size_t lengths[] = {0, 1, 32, 55, 56, 63, 64, 65, 119, 120, 128, 200, 1000};
+    static const size_t n = sizeof(lengths) / sizeof(lengths[0]);
+    unsigned char data[1000];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = i * 7 + 1;
+    const unsigned char* in[n];
+    unsigned char digests[n][32];
+    unsigned char* out[n];
+    for (size_t i = 0; i < n; i++) {
+        in[i] = data + i;
+        out[i] = digests[i];
+    }
+    SHA256DLanes(transform, lanes, out, in, lengths, n);
+    for (size_t i = 0; i < n; i++) {
+        unsigned char expected[32];
+        SHA256DScalar(expected, in[i], lengths[i]);
+        if (memcmp(expected, digests[i], 32)) return false;
+    }
+    return true;
+}
+
+void DetectLanes()
+{
+#if defined(USE_SHA256_AVX2)
+    uint32_t eax, ebx, ecx, edx;
+    // AVX2, with XMM and YMM state enabled by the OS.
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        if (((ebx >> 5) & 1) && XCR0Enabled(0x6)) {
+            assert(SelfTestLanes(Transform_8way, 8));
+            Transform8Way = Transform_8way;
+        }
+    }
+#endif
+#if defined(__x86_64__) || defined(__amd64__)
+    assert(SelfTestLanes(Transform_4way, 4));
+    Transform4Way = Transform_4way;
+#endif
+}
+
 } // namespace
 
 std::string SHA256AutoDetect()
 {
+    std::string ret = "standard";
 #if defined(EXPERIMENTAL_ASM) && (defined(__x86_64__) || defined(__amd64__))
     uint32_t eax, ebx, ecx, edx;
     if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx >> 19) & 1) {
         Transform = sha256_sse4::Transform;
-        assert(SelfTest(Transform));
-        return "sse4";
+        ret = "sse4";
     }
 #endif
 
     assert(SelfTest(Transform));
-    return "standard";
+    // The multi-lane transforms are found once, as other threads may be
+    // hashing through them by the time this is called again
+    std::call_once(detectLanesOnce, DetectLanes);
+    size_t lanes;
+    PickLanes(SHA256_MAX_LANES, lanes);
+    if (lanes > 1)
+        ret += ", " + std::to_string(lanes) + "-way batches";
+    return ret;
 }
 
 ////// SHA-256
@@ -247,3 +454,42 @@ CSHA256& CSHA256::Reset()
     sha256::Initialize(s);
     return *this;
 }
+
+////// Batched double SHA-256
+
+void SHA256DBatch(unsigned char* const out[], const unsigned char* const in[], const size_t len[], size_t n, size_t nMaxLanes)
+{
+    size_t lanes;
+    TransformLanesType transform = PickLanes(nMaxLanes, lanes);
+    if (transform && n > 1) {
+        SHA256DLanes(transform, lanes, out, in, len, n);
+        return;
+    }
+    for (size_t i = 0; i < n; i++)
+        SHA256DScalar(out[i], in[i], len[i]);
+}
+
+void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks, size_t nMaxLanes)
+{
+    // Copy each batch of inputs aside first, as out may overlap in
+    unsigned char buf[SHA256_MAX_LANES * 64];
+    const unsigned char* pin[SHA256_MAX_LANES];
+    unsigned char* pout[SHA256_MAX_LANES];
+    size_t len[SHA256_MAX_LANES];
+    size_t batch;
+    PickLanes(nMaxLanes, batch);
+    for (size_t i = 0; i < batch; i++) {
+        pin[i] = buf + 64 * i;
+        len[i] = 64;
+    }
+    while (blocks) {
+        size_t n = std::min(blocks, batch);
+        memcpy(buf, in, 64 * n);
+        for (size_t i = 0; i < n; i++)
+            pout[i] = out + 32 * i;
+        SHA256DBatch(pout, pin, len, n, batch);
+        in += 64 * n;
+        out += 32 * n;
+        blocks -= n;
+    }
+}
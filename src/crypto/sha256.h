@@ -31,4 +31,20 @@ public:
  */
 std::string SHA256AutoDetect();
 
+/** Widest multi-lane transform, in inputs hashed at a time */
+static const size_t SHA256_MAX_LANES = 8;
+
+/** Compute the double-SHA256 of each of n inputs, in[i] being len[i] bytes
+ *  long, into the 32 bytes at out[i]. Inputs are hashed several at a time
+ *  when SHA256AutoDetect found a multi-lane transform, using the widest one
+ *  of at most nMaxLanes lanes; tests pass fewer to exercise the narrower ones.
+ */
+void SHA256DBatch(unsigned char* const out[], const unsigned char* const in[], const size_t len[], size_t n, size_t nMaxLanes = SHA256_MAX_LANES);
+
+/** Compute the double-SHA256 of blocks consecutive 64-byte inputs into as
+ *  many consecutive 32-byte outputs, as for one level of a merkle tree.
+ *  out may equal in.
+ */
+void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks, size_t nMaxLanes = SHA256_MAX_LANES);
+
 #endif // BITCOIN_CRYPTO_SHA256_H
@@ -0,0 +1,150 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+/*
+ * 4-way SHA-256 transform using SSE2 intrinsics. Lane l of every vector holds
+ * the corresponding 32-bit word of the l-th state, so each round works on
+ * 4 independent hashes at once. SSE2 is part of x86-64, so no runtime
+ * check is needed.
+ */
+
+#if defined(__x86_64__) || defined(__amd64__)
+
+#include "crypto/common.h"
+
+#include <stdint.h>
+#include <emmintrin.h>
+
+namespace sha256_sse2
+{
+namespace
+{
+__m128i inline K(uint32_t x) { return _mm_set1_epi32(x); }
+
+__m128i inline Add(__m128i x, __m128i y) { return _mm_add_epi32(x, y); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z) { return Add(Add(x, y), z); }
+__m128i inline Add(__m128i x, __m128i y, __m128i z, __m128i w) { return Add(Add(x, y), Add(z, w)); }
+__m128i inline Xor(__m128i x, __m128i y) { return _mm_xor_si128(x, y); }
+__m128i inline Xor(__m128i x, __m128i y, __m128i z) { return Xor(Xor(x, y), z); }
+__m128i inline Or(__m128i x, __m128i y) { return _mm_or_si128(x, y); }
+__m128i inline And(__m128i x, __m128i y) { return _mm_and_si128(x, y); }
+__m128i inline ShR(__m128i x, int n) { return _mm_srli_epi32(x, n); }
+__m128i inline ShL(__m128i x, int n) { return _mm_slli_epi32(x, n); }
+__m128i inline RotR(__m128i x, int n) { return Or(ShR(x, n), ShL(x, 32 - n)); }
+
+__m128i inline Ch(__m128i x, __m128i y, __m128i z) { return Xor(z, And(x, Xor(y, z))); }
+__m128i inline Maj(__m128i x, __m128i y, __m128i z) { return Or(And(x, y), And(z, Or(x, y))); }
+__m128i inline Sigma0(__m128i x) { return Xor(RotR(x, 2), RotR(x, 13), RotR(x, 22)); }
+__m128i inline Sigma1(__m128i x) { return Xor(RotR(x, 6), RotR(x, 11), RotR(x, 25)); }
+__m128i inline sigma0(__m128i x) { return Xor(RotR(x, 7), RotR(x, 18), ShR(x, 3)); }
+__m128i inline sigma1(__m128i x) { return Xor(RotR(x, 17), RotR(x, 19), ShR(x, 10)); }
+
+/** One round of SHA-256 in every lane; kw is the round constant plus the message word. */
+void inline Round(__m128i a, __m128i b, __m128i c, __m128i& d, __m128i e, __m128i f, __m128i g, __m128i& h, __m128i kw)
+{
+    __m128i t1 = Add(h, Sigma1(e), Ch(e, f, g), kw);
+    __m128i t2 = Add(Sigma0(a), Maj(a, b, c));
+    d = Add(d, t1);
+    h = Add(t1, t2);
+}
+
+/** The big endian word at offset of every lane's chunk. */
+__m128i inline Read(const unsigned char* const chunk[4], int offset)
+{
+    return _mm_set_epi32(ReadBE32(chunk[3] + offset), ReadBE32(chunk[2] + offset), ReadBE32(chunk[1] + offset), ReadBE32(chunk[0] + offset));
+}
+
+} // namespace
+
+void Transform_4way(uint32_t* s, const unsigned char* const chunk[4])
+{
+    __m128i a = _mm_loadu_si128((const __m128i*)(s + 0));
+    __m128i b = _mm_loadu_si128((const __m128i*)(s + 4));
+    __m128i c = _mm_loadu_si128((const __m128i*)(s + 8));
+    __m128i d = _mm_loadu_si128((const __m128i*)(s + 12));
+    __m128i e = _mm_loadu_si128((const __m128i*)(s + 16));
+    __m128i f = _mm_loadu_si128((const __m128i*)(s + 20));
+    __m128i g = _mm_loadu_si128((const __m128i*)(s + 24));
+    __m128i h = _mm_loadu_si128((const __m128i*)(s + 28));
+    __m128i w0, w1, w2, w3, w4, w5, w6, w7, w8, w9, w10, w11, w12, w13, w14, w15;
+
+    Round(a, b, c, d, e, f, g, h, Add(K(0x428a2f98), w0 = Read(chunk, 0)));
+    Round(h, a, b, c, d, e, f, g, Add(K(0x71374491), w1 = Read(chunk, 4)));
+    Round(g, h, a, b, c, d, e, f, Add(K(0xb5c0fbcf), w2 = Read(chunk, 8)));
+    Round(f, g, h, a, b, c, d, e, Add(K(0xe9b5dba5), w3 = Read(chunk, 12)));
+    Round(e, f, g, h, a, b, c, d, Add(K(0x3956c25b), w4 = Read(chunk, 16)));
+    Round(d, e, f, g, h, a, b, c, Add(K(0x59f111f1), w5 = Read(chunk, 20)));
+    Round(c, d, e, f, g, h, a, b, Add(K(0x923f82a4), w6 = Read(chunk, 24)));
+    Round(b, c, d, e, f, g, h, a, Add(K(0xab1c5ed5), w7 = Read(chunk, 28)));
+    Round(a, b, c, d, e, f, g, h, Add(K(0xd807aa98), w8 = Read(chunk, 32)));
+    Round(h, a, b, c, d, e, f, g, Add(K(0x12835b01), w9 = Read(chunk, 36)));
+    Round(g, h, a, b, c, d, e, f, Add(K(0x243185be), w10 = Read(chunk, 40)));
+    Round(f, g, h, a, b, c, d, e, Add(K(0x550c7dc3), w11 = Read(chunk, 44)));
+    Round(e, f, g, h, a, b, c, d, Add(K(0x72be5d74), w12 = Read(chunk, 48)));
+    Round(d, e, f, g, h, a, b, c, Add(K(0x80deb1fe), w13 = Read(chunk, 52)));
+    Round(c, d, e, f, g, h, a, b, Add(K(0x9bdc06a7), w14 = Read(chunk, 56)));
+    Round(b, c, d, e, f, g, h, a, Add(K(0xc19bf174), w15 = Read(chunk, 60)));
+
+    Round(a, b, c, d, e, f, g, h, Add(K(0xe49b69c1), w0 = Add(w0, sigma1(w14), w9, sigma0(w1))));
+    Round(h, a, b, c, d, e, f, g, Add(K(0xefbe4786), w1 = Add(w1, sigma1(w15), w10, sigma0(w2))));
+    Round(g, h, a, b, c, d, e, f, Add(K(0x0fc19dc6), w2 = Add(w2, sigma1(w0), w11, sigma0(w3))));
+    Round(f, g, h, a, b, c, d, e, Add(K(0x240ca1cc), w3 = Add(w3, sigma1(w1), w12, sigma0(w4))));
+    Round(e, f, g, h, a, b, c, d, Add(K(0x2de92c6f), w4 = Add(w4, sigma1(w2), w13, sigma0(w5))));
+    Round(d, e, f, g, h, a, b, c, Add(K(0x4a7484aa), w5 = Add(w5, sigma1(w3), w14, sigma0(w6))));
+    Round(c, d, e, f, g, h, a, b, Add(K(0x5cb0a9dc), w6 = Add(w6, sigma1(w4), w15, sigma0(w7))));
+    Round(b, c, d, e, f, g, h, a, Add(K(0x76f988da), w7 = Add(w7, sigma1(w5), w0, sigma0(w8))));
+    Round(a, b, c, d, e, f, g, h, Add(K(0x983e5152), w8 = Add(w8, sigma1(w6), w1, sigma0(w9))));
+    Round(h, a, b, c, d, e, f, g, Add(K(0xa831c66d), w9 = Add(w9, sigma1(w7), w2, sigma0(w10))));
+    Round(g, h, a, b, c, d, e, f, Add(K(0xb00327c8), w10 = Add(w10, sigma1(w8), w3, sigma0(w11))));
+    Round(f, g, h, a, b, c, d, e, Add(K(0xbf597fc7), w11 = Add(w11, sigma1(w9), w4, sigma0(w12))));
+    Round(e, f, g, h, a, b, c, d, Add(K(0xc6e00bf3), w12 = Add(w12, sigma1(w10), w5, sigma0(w13))));
+    Round(d, e, f, g, h, a, b, c, Add(K(0xd5a79147), w13 = Add(w13, sigma1(w11), w6, sigma0(w14))));
+    Round(c, d, e, f, g, h, a, b, Add(K(0x06ca6351), w14 = Add(w14, sigma1(w12), w7, sigma0(w15))));
+    Round(b, c, d, e, f, g, h, a, Add(K(0x14292967), w15 = Add(w15, sigma1(w13), w8, sigma0(w0))));
+    Round(a, b, c, d, e, f, g, h, Add(K(0x27b70a85), w0 = Add(w0, sigma1(w14), w9, sigma0(w1))));
+    Round(h, a, b, c, d, e, f, g, Add(K(0x2e1b2138), w1 = Add(w1, sigma1(w15), w10, sigma0(w2))));
+    Round(g, h, a, b, c, d, e, f, Add(K(0x4d2c6dfc), w2 = Add(w2, sigma1(w0), w11, sigma0(w3))));
+    Round(f, g, h, a, b, c, d, e, Add(K(0x53380d13), w3 = Add(w3, sigma1(w1), w12, sigma0(w4))));
+    Round(e, f, g, h, a, b, c, d, Add(K(0x650a7354), w4 = Add(w4, sigma1(w2), w13, sigma0(w5))));
+    Round(d, e, f, g, h, a, b, c, Add(K(0x766a0abb), w5 = Add(w5, sigma1(w3), w14, sigma0(w6))));
+    Round(c, d, e, f, g, h, a, b, Add(K(0x81c2c92e), w6 = Add(w6, sigma1(w4), w15, sigma0(w7))));
+    Round(b, c, d, e, f, g, h, a, Add(K(0x92722c85), w7 = Add(w7, sigma1(w5), w0, sigma0(w8))));
+    Round(a, b, c, d, e, f, g, h, Add(K(0xa2bfe8a1), w8 = Add(w8, sigma1(w6), w1, sigma0(w9))));
+    Round(h, a, b, c, d, e, f, g, Add(K(0xa81a664b), w9 = Add(w9, sigma1(w7), w2, sigma0(w10))));
+    Round(g, h, a, b, c, d, e, f, Add(K(0xc24b8b70), w10 = Add(w10, sigma1(w8), w3, sigma0(w11))));
+    Round(f, g, h, a, b, c, d, e, Add(K(0xc76c51a3), w11 = Add(w11, sigma1(w9), w4, sigma0(w12))));
+    Round(e, f, g, h, a, b, c, d, Add(K(0xd192e819), w12 = Add(w12, sigma1(w10), w5, sigma0(w13))));
+    Round(d, e, f, g, h, a, b, c, Add(K(0xd6990624), w13 = Add(w13, sigma1(w11), w6, sigma0(w14))));
+    Round(c, d, e, f, g, h, a, b, Add(K(0xf40e3585), w14 = Add(w14, sigma1(w12), w7, sigma0(w15))));
+    Round(b, c, d, e, f, g, h, a, Add(K(0x106aa070), w15 = Add(w15, sigma1(w13), w8, sigma0(w0))));
+    Round(a, b, c, d, e, f, g, h, Add(K(0x19a4c116), w0 = Add(w0, sigma1(w14), w9, sigma0(w1))));
+    Round(h, a, b, c, d, e, f, g, Add(K(0x1e376c08), w1 = Add(w1, sigma1(w15), w10, sigma0(w2))));
+    Round(g, h, a, b, c, d, e, f, Add(K(0x2748774c), w2 = Add(w2, sigma1(w0), w11, sigma0(w3))));
+    Round(f, g, h, a, b, c, d, e, Add(K(0x34b0bcb5), w3 = Add(w3, sigma1(w1), w12, sigma0(w4))));
+    Round(e, f, g, h, a, b, c, d, Add(K(0x391c0cb3), w4 = Add(w4, sigma1(w2), w13, sigma0(w5))));
+    Round(d, e, f, g, h, a, b, c, Add(K(0x4ed8aa4a), w5 = Add(w5, sigma1(w3), w14, sigma0(w6))));
+    Round(c, d, e, f, g, h, a, b, Add(K(0x5b9cca4f), w6 = Add(w6, sigma1(w4), w15, sigma0(w7))));
+    Round(b, c, d, e, f, g, h, a, Add(K(0x682e6ff3), w7 = Add(w7, sigma1(w5), w0, sigma0(w8))));
+    Round(a, b, c, d, e, f, g, h, Add(K(0x748f82ee), w8 = Add(w8, sigma1(w6), w1, sigma0(w9))));
+    Round(h, a, b, c, d, e, f, g, Add(K(0x78a5636f), w9 = Add(w9, sigma1(w7), w2, sigma0(w10))));
+    Round(g, h, a, b, c, d, e, f, Add(K(0x84c87814), w10 = Add(w10, sigma1(w8), w3, sigma0(w11))));
+    Round(f, g, h, a, b, c, d, e, Add(K(0x8cc70208), w11 = Add(w11, sigma1(w9), w4, sigma0(w12))));
+    Round(e, f, g, h, a, b, c, d, Add(K(0x90befffa), w12 = Add(w12, sigma1(w10), w5, sigma0(w13))));
+    Round(d, e, f, g, h, a, b, c, Add(K(0xa4506ceb), w13 = Add(w13, sigma1(w11), w6, sigma0(w14))));
+    Round(c, d, e, f, g, h, a, b, Add(K(0xbef9a3f7), Add(w14, sigma1(w12), w7, sigma0(w15))));
+    Round(b, c, d, e, f, g, h, a, Add(K(0xc67178f2), Add(w15, sigma1(w13), w8, sigma0(w0))));
+
+    _mm_storeu_si128((__m128i*)(s + 0), Add(_mm_loadu_si128((const __m128i*)(s + 0)), a));
+    _mm_storeu_si128((__m128i*)(s + 4), Add(_mm_loadu_si128((const __m128i*)(s + 4)), b));
+    _mm_storeu_si128((__m128i*)(s + 8), Add(_mm_loadu_si128((const __m128i*)(s + 8)), c));
+    _mm_storeu_si128((__m128i*)(s + 12), Add(_mm_loadu_si128((const __m128i*)(s + 12)), d));
+    _mm_storeu_si128((__m128i*)(s + 16), Add(_mm_loadu_si128((const __m128i*)(s + 16)), e));
+    _mm_storeu_si128((__m128i*)(s + 20), Add(_mm_loadu_si128((const __m128i*)(s + 20)), f));
+    _mm_storeu_si128((__m128i*)(s + 24), Add(_mm_loadu_si128((const __m128i*)(s + 24)), g));
+    _mm_storeu_si128((__m128i*)(s + 28), Add(_mm_loadu_si128((const __m128i*)(s + 28)), h));
+}
+
+} // namespace sha256_sse2
+
+#endif
@@ -167,6 +167,14 @@ public:
         return true;
     }
 
+    /** Copy the deobfuscated value into ssValue, leaving it to the caller to deserialize. */
+    void GetValueStream(CDataStream& ssValue) {
+        leveldb::Slice slValue = piter->value();
+        ssValue.clear();
+        ssValue.write(slValue.data(), slValue.size());
+        ssValue.Xor(dbwrapper_private::GetObfuscateKey(parent));
+    }
+
     unsigned int GetValueSize() {
         return piter->value().size();
     }
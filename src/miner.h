@@ -21,6 +21,8 @@ class CScript;
 namespace Consensus { struct Params; };
 
 static const bool DEFAULT_PRINTPRIORITY = false;
+/** Threads generate/generatetoaddress hash with, -1 for one per core */
+static const int DEFAULT_GENERATE_THREADS = 1;
 
 struct CBlockTemplate
 {
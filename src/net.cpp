@@ -28,6 +28,10 @@
 #include <fcntl.h>
 #endif
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 #ifdef USE_UPNP
 #include <miniupnpc/miniupnpc.h>
 #include <miniupnpc/miniwget.h>
@@ -386,7 +390,7 @@ CNode* CConnman::ConnectNode(CAddress addrConnect, const char *pszDest, bool fCo
     if (pszDest ? ConnectSocketByName(addrConnect, hSocket, pszDest, Params().GetDefaultPort(), nConnectTimeout, &proxyConnectionFailed) :
                   ConnectSocket(addrConnect, hSocket, nConnectTimeout, &proxyConnectionFailed))
     {
-        if (!IsSelectableSocket(hSocket)) {
+        if (!IsUsableSocket(hSocket)) {
             LogPrintf("Cannot create connection: non-selectable socket created (fd >= FD_SETSIZE ?)\n");
             CloseSocket(hSocket);
             return nullptr;
@@ -697,7 +701,7 @@ void CNode::copyStats(CNodeStats &stats)
 }
 #undef X
 
-bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete)
+bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete, CNetBufferPool* pool)
 {
     complete = false;
     int64_t nTimeMicros = GetTimeMicros();
@@ -709,7 +713,7 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete
         // get current incomplete message, or create a new one
         if (vRecvMsg.empty() ||
             vRecvMsg.back().complete())
-            vRecvMsg.push_back(CNetMessage(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION));
+            vRecvMsg.emplace_back(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION, pool);
 
         CNetMessage& msg = vRecvMsg.back();
 
@@ -801,6 +805,22 @@ int CNetMessage::readHeader(const char *pch, unsigned int nBytes)
     if (hdr.nMessageSize > MAX_SIZE)
         return -1;
 
+    // Set aside room for the payload up front, as much as readData would
+    // allocate ahead. Small messages fit in the header's pooled buffer.
+    size_t nReserve = std::min<size_t>(hdr.nMessageSize, 256 * 1024);
+    if (pool) {
+        CSerializeData buf;
+        hdrbuf.SwapBuffer(buf);
+        if (buf.capacity() < nReserve) {
+            pool->Put(buf);
+            pool->Get(buf, nReserve);
+        }
+        buf.clear();
+        vRecv.SwapBuffer(buf);
+    } else {
+        vRecv.reserve(nReserve);
+    }
+
     // switch state to reading message data
     in_data = true;
 
@@ -817,21 +837,50 @@ int CNetMessage::readData(const char *pch, unsigned int nBytes)
         vRecv.resize(std::min(hdr.nMessageSize, nDataPos + nCopy + 256 * 1024));
     }
 
-    hasher.Write((const unsigned char*)pch, nCopy);
     memcpy(&vRecv[nDataPos], pch, nCopy);
     nDataPos += nCopy;
 
     return nCopy;
 }
 
+CNetMessage::~CNetMessage()
+{
+    if (pool) {
+        CSerializeData buf;
+        hdrbuf.SwapBuffer(buf);
+        pool->Put(buf);
+        vRecv.SwapBuffer(buf);
+        pool->Put(buf);
+    }
+}
+
+// The payload is hashed here rather than as it arrives, so the socket
+// thread only copies bytes and the message handlers can hash a node's
+// queued messages in one batch. Must be called before vRecv is read from.
 const uint256& CNetMessage::GetMessageHash() const
 {
     assert(complete());
-    if (data_hash.IsNull())
-        hasher.Finalize(data_hash.begin());
+    if (data_hash.IsNull()) {
+        const CNetMessage* self = this;
+        ComputeMessageHashes(&self, 1);
+    }
     return data_hash;
 }
 
+void CNetMessage::ComputeMessageHashes(const CNetMessage* const msgs[], size_t n)
+{
+    std::vector<const unsigned char*> vIn(n);
+    std::vector<unsigned char*> vOut(n);
+    std::vector<size_t> vLen(n);
+    for (size_t i = 0; i < n; i++) {
+        assert(msgs[i]->complete() && msgs[i]->vRecv.size() == msgs[i]->hdr.nMessageSize);
+        vIn[i] = (const unsigned char*)msgs[i]->vRecv.data();
+        vLen[i] = msgs[i]->hdr.nMessageSize;
+        vOut[i] = msgs[i]->data_hash.begin();
+    }
+    SHA256DBatch(vOut.data(), vIn.data(), vLen.data(), n);
+}
+
 
 
 
@@ -841,13 +890,13 @@ const uint256& CNetMessage::GetMessageHash() const
 
 
 // requires LOCK(cs_vSend)
-size_t CConnman::SocketSendData(CNode *pnode) const
+size_t CConnman::SocketSendData(CNode *pnode)
 {
     auto it = pnode->vSendMsg.begin();
     size_t nSentSize = 0;
 
     while (it != pnode->vSendMsg.end()) {
-        const auto &data = *it;
+        auto &data = *it;
         assert(data.size() > pnode->nSendOffset);
         int nBytes = 0;
         {
@@ -865,6 +914,7 @@ size_t CConnman::SocketSendData(CNode *pnode) const
                 pnode->nSendOffset = 0;
                 pnode->nSendSize -= data.size();
                 pnode->fPauseSend = pnode->nSendSize > nSendBufferMaxSize;
+                netBufferPool.Put(data);
                 it++;
             } else {
                 // could not send full message; stop sending more
@@ -1075,7 +1125,7 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
         return;
     }
 
-    if (!IsSelectableSocket(hSocket))
+    if (!IsUsableSocket(hSocket))
     {
         LogPrintf("connection from %s dropped: non-selectable socket\n", addr.ToString());
         CloseSocket(hSocket);
@@ -1117,12 +1167,435 @@ void CConnman::AcceptConnection(const ListenSocket& hListenSocket) {
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
+        RegisterNodeSocket(pnode);
+    }
+}
+
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode)
+{
+    if (str == "select") {
+        mode = SOCKETEVENTS_SELECT;
+        return true;
+    }
+#ifdef USE_EPOLL
+    if (str == "epoll") {
+        mode = SOCKETEVENTS_EPOLL;
+        return true;
+    }
+#endif
+    return false;
+}
+
+std::string GetSocketEventsModeName(SocketEventsMode mode)
+{
+    switch (mode) {
+    case SOCKETEVENTS_SELECT: return "select";
+    case SOCKETEVENTS_EPOLL: return "epoll";
+    }
+    assert(false);
+}
+
+std::string GetSupportedSocketEventsModes()
+{
+#ifdef USE_EPOLL
+    return "select, epoll";
+#else
+    return "select";
+#endif
+}
+
+bool CConnman::IsUsableSocket(SOCKET hSocket) const
+{
+    return socketEventsMode != SOCKETEVENTS_SELECT || IsSelectableSocket(hSocket);
+}
+
+void CConnman::RegisterNodeSocket(CNode* pnode)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode != SOCKETEVENTS_EPOLL)
+        return;
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket == INVALID_SOCKET)
+        return;
+    // Edge-triggered: readiness is reported once per change and latched in
+    // the node until recv() or send() use it up.
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.ptr = pnode;
+    if (epoll_ctl(epollfd, EPOLL_CTL_ADD, pnode->hSocket, &event) != 0) {
+        LogPrintf("epoll_ctl failed to add peer=%d: %s\n", pnode->GetId(), NetworkErrorString(errno));
+        pnode->fDisconnect = true;
+    }
+#endif
+}
+
+void CConnman::UnregisterNodeSocket(CNode* pnode)
+{
+#ifdef USE_EPOLL
+    if (socketEventsMode != SOCKETEVENTS_EPOLL)
+        return;
+    // Closing the socket would drop it from the epoll set as well; removing
+    // it first keeps the set exact when the descriptor is shared.
+    LOCK(pnode->cs_hSocket);
+    if (pnode->hSocket != INVALID_SOCKET)
+        epoll_ctl(epollfd, EPOLL_CTL_DEL, pnode->hSocket, nullptr);
+#endif
+}
+
+void CConnman::SocketEventsSelect(std::vector<const ListenSocket*>& vListenReady, std::vector<NodeSocketReady>& vNodeReady)
+{
+    //
+    // Find which sockets have data to receive
+    //
+    struct timeval timeout;
+    timeout.tv_sec  = 0;
+    timeout.tv_usec = 50000; // frequency to poll pnode->vSend
+
+    fd_set fdsetRecv;
+    fd_set fdsetSend;
+    fd_set fdsetError;
+    FD_ZERO(&fdsetRecv);
+    FD_ZERO(&fdsetSend);
+    FD_ZERO(&fdsetError);
+    SOCKET hSocketMax = 0;
+    bool have_fds = false;
+
+    for (const ListenSocket& hListenSocket : vhListenSocket) {
+        FD_SET(hListenSocket.socket, &fdsetRecv);
+        hSocketMax = std::max(hSocketMax, hListenSocket.socket);
+        have_fds = true;
+    }
+
+    {
+        LOCK(cs_vNodes);
+        for (CNode* pnode : vNodes)
+        {
+            // Implement the following logic:
+            // * If there is data to send, select() for sending data. As this only
+            //   happens when optimistic write failed, we choose to first drain the
+            //   write buffer in this case before receiving more. This avoids
+            //   needlessly queueing received data, if the remote peer is not themselves
+            //   receiving data. This means properly utilizing TCP flow control signalling.
+            // * Otherwise, if there is space left in the receive buffer, select() for
+            //   receiving data.
+            // * Hand off all complete messages to the processor, to be handled without
+            //   blocking here.
+
+            bool select_recv = !pnode->fPauseRecv;
+            bool select_send;
+            {
+                LOCK(pnode->cs_vSend);
+                select_send = !pnode->vSendMsg.empty();
+            }
+
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET)
+                continue;
+
+            FD_SET(pnode->hSocket, &fdsetError);
+            hSocketMax = std::max(hSocketMax, pnode->hSocket);
+            have_fds = true;
+
+            if (select_send) {
+                FD_SET(pnode->hSocket, &fdsetSend);
+                continue;
+            }
+            if (select_recv) {
+                FD_SET(pnode->hSocket, &fdsetRecv);
+            }
+        }
+    }
+
+    int nSelect = select(have_fds ? hSocketMax + 1 : 0,
+                         &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+    if (interruptNet)
+        return;
+
+    if (nSelect == SOCKET_ERROR)
+    {
+        if (have_fds)
+        {
+            int nErr = WSAGetLastError();
+            LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
+            for (unsigned int i = 0; i <= hSocketMax; i++)
+                FD_SET(i, &fdsetRecv);
+        }
+        FD_ZERO(&fdsetSend);
+        FD_ZERO(&fdsetError);
+        if (!interruptNet.sleep_for(std::chrono::milliseconds(timeout.tv_usec/1000)))
+            return;
+    }
+
+    for (const ListenSocket& hListenSocket : vhListenSocket)
+    {
+        if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+            vListenReady.push_back(&hListenSocket);
+    }
+
+    {
+        LOCK(cs_vNodes);
+        for (CNode* pnode : vNodes) {
+            pnode->AddRef();
+            vNodeReady.push_back(NodeSocketReady{pnode, false, false, false});
+        }
+    }
+    for (NodeSocketReady& ready : vNodeReady)
+    {
+        LOCK(ready.pnode->cs_hSocket);
+        if (ready.pnode->hSocket == INVALID_SOCKET)
+            continue;
+        ready.fRecv = FD_ISSET(ready.pnode->hSocket, &fdsetRecv);
+        ready.fSend = FD_ISSET(ready.pnode->hSocket, &fdsetSend);
+        ready.fError = FD_ISSET(ready.pnode->hSocket, &fdsetError);
+    }
+}
+
+#ifdef USE_EPOLL
+void CConnman::SocketEventsEpoll(std::vector<const ListenSocket*>& vListenReady, std::vector<NodeSocketReady>& vNodeReady)
+{
+    // Nodes left over from the last round come first, as no new event will
+    // be reported for data they have not read yet. Only a node that can read
+    // right away keeps the wait below from blocking. The others wait for
+    // their receive queue or send buffer to drain, which is checked again
+    // every 50ms, as select() mode polls vSend.
+    int nTimeout = 50;
+    std::vector<CNode*> vPending;
+    vPending.swap(vEpollPending);
+    for (CNode* pnode : vPending) {
+        pnode->fSocketQueued = true;
+        vNodeReady.push_back(NodeSocketReady{pnode, false, false, false});
+        if (!pnode->fPauseRecv) {
+            LOCK(pnode->cs_vSend);
+            if (pnode->vSendMsg.empty())
+                nTimeout = 0;
+        }
+    }
+
+    struct epoll_event events[256];
+    int nEvents = epoll_wait(epollfd, events, ARRAYLEN(events), nTimeout);
+    if (interruptNet)
+        return;
+    if (nEvents < 0) {
+        nEvents = 0;
+        if (errno != EINTR) {
+            LogPrintf("socket epoll_wait error %s\n", NetworkErrorString(errno));
+            if (!interruptNet.sleep_for(std::chrono::milliseconds(50)))
+                return;
+        }
+    }
+
+    for (int i = 0; i < nEvents; i++) {
+        const ListenSocket* plisten = nullptr;
+        for (const ListenSocket& hListenSocket : vhListenSocket) {
+            if (events[i].data.ptr == &hListenSocket)
+                plisten = &hListenSocket;
+        }
+        if (plisten) {
+            vListenReady.push_back(plisten);
+            continue;
+        }
+
+        // Nodes are only deleted by this thread, after their socket, and
+        // with it any pending events, are gone.
+        CNode* pnode = static_cast<CNode*>(events[i].data.ptr);
+        if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            pnode->fSocketRecvReady = true;
+        if (events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+            pnode->fSocketHangup = true;
+        if (events[i].events & EPOLLOUT)
+            pnode->fSocketSendReady = true;
+        if (!pnode->fSocketQueued) {
+            pnode->fSocketQueued = true;
+            pnode->AddRef();
+            vNodeReady.push_back(NodeSocketReady{pnode, false, false, false});
+        }
+    }
+
+    // Same order as in select() mode: drain the send buffer before receiving more
+    for (NodeSocketReady& ready : vNodeReady) {
+        CNode* pnode = ready.pnode;
+        pnode->fSocketQueued = false;
+        bool fSendQueued;
+        {
+            LOCK(pnode->cs_vSend);
+            fSendQueued = !pnode->vSendMsg.empty();
+        }
+        ready.fSend = fSendQueued && pnode->fSocketSendReady;
+        ready.fRecv = !fSendQueued && pnode->fSocketRecvReady && !pnode->fPauseRecv;
     }
 }
+#endif
+
+void CConnman::SocketHandlerNode(CNode* pnode, bool fRecv, bool fSend, bool fError)
+{
+    //
+    // Receive
+    //
+    if (fRecv || fError)
+    {
+        // typical socket buffer is 8K-64K
+        char pchBuf[0x10000];
+        int nBytes = 0;
+        {
+            LOCK(pnode->cs_hSocket);
+            if (pnode->hSocket == INVALID_SOCKET)
+                return;
+            nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+        }
+        // A short read means the socket was drained, and the next data to
+        // arrive will raise a new edge-triggered event. The end of the stream
+        // raises none once it has been reported, possibly together with the
+        // last data, so after a hangup the node is kept ready until recv()
+        // returns 0 or fails.
+        pnode->fSocketRecvReady = nBytes == (int)sizeof(pchBuf) || (nBytes > 0 && pnode->fSocketHangup);
+        if (nBytes > 0)
+        {
+            bool notify = false;
+            CNetBufferPool* pool = nullptr;
+            {
+                LOCK(pnode->cs_vProcessMsg);
+                if (pnode->nProcessQueueSize < MAX_NETBUFFERPOOL_NODE_BYTES)
+                    pool = &netBufferPool;
+            }
+            if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify, pool))
+                pnode->CloseSocketDisconnect();
+            RecordBytesRecv(nBytes);
+            if (notify) {
+                size_t nSizeAdded = 0;
+                auto it(pnode->vRecvMsg.begin());
+                for (; it != pnode->vRecvMsg.end(); ++it) {
+                    if (!it->complete())
+                        break;
+                    // Charge what the buffers take, not just the payload, so
+                    // that -maxreceivebuffer bounds memory with pooled buffers
+                    nSizeAdded += it->GetMemoryUsage();
+                }
+                {
+                    LOCK(pnode->cs_vProcessMsg);
+                    pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
+                    pnode->nProcessQueueSize += nSizeAdded;
+                    pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
+                }
+                WakeMessageHandler(pnode);
+            }
+        }
+        else if (nBytes == 0)
+        {
+            // socket closed gracefully
+            if (!pnode->fDisconnect) {
+                LogPrint(BCLog::NET, "socket closed\n");
+            }
+            pnode->CloseSocketDisconnect();
+        }
+        else if (nBytes < 0)
+        {
+            // error
+            int nErr = WSAGetLastError();
+            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+            {
+                if (!pnode->fDisconnect)
+                    LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
+                pnode->CloseSocketDisconnect();
+            }
+        }
+    }
+
+    //
+    // Send
+    //
+    if (fSend)
+    {
+        LOCK(pnode->cs_vSend);
+        size_t nBytes = SocketSendData(pnode);
+        if (nBytes) {
+            RecordBytesSent(nBytes);
+        }
+        // Whatever is left could not be sent without blocking
+        pnode->fSocketSendReady = pnode->vSendMsg.empty();
+    }
+}
+
+void CConnman::InactivityCheck(CNode* pnode)
+{
+    int64_t nTime = GetSystemTimeInSeconds();
+    if (nTime - pnode->nTimeConnected > 60)
+    {
+        if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
+        {
+            LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d from %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->GetId());
+            pnode->fDisconnect = true;
+        }
+        else if (nTime - pnode->nLastSend > TIMEOUT_INTERVAL)
+        {
+            LogPrintf("socket sending timeout: %is\n", nTime - pnode->nLastSend);
+            pnode->fDisconnect = true;
+        }
+        else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? TIMEOUT_INTERVAL : 90*60))
+        {
+            LogPrintf("socket receive timeout: %is\n", nTime - pnode->nLastRecv);
+            pnode->fDisconnect = true;
+        }
+        else if (pnode->nPingNonceSent && pnode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
+        {
+            LogPrintf("ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
+            pnode->fDisconnect = true;
+        }
+        else if (!pnode->fSuccessfullyConnected)
+        {
+            LogPrintf("version handshake timeout from %d\n", pnode->GetId());
+            pnode->fDisconnect = true;
+        }
+    }
+}
+
+bool CConnman::ServiceSockets()
+{
+    std::vector<const ListenSocket*> vListenReady;
+    std::vector<NodeSocketReady> vNodeReady;
+#ifdef USE_EPOLL
+    if (socketEventsMode == SOCKETEVENTS_EPOLL)
+        SocketEventsEpoll(vListenReady, vNodeReady);
+    else
+#endif
+        SocketEventsSelect(vListenReady, vNodeReady);
+    if (interruptNet)
+        return false;
+
+    //
+    // Accept new connections
+    //
+    for (const ListenSocket* pListenSocket : vListenReady)
+        AcceptConnection(*pListenSocket);
+
+    //
+    // Service each socket
+    //
+    for (const NodeSocketReady& ready : vNodeReady)
+    {
+        if (interruptNet)
+            return false;
+        SocketHandlerNode(ready.pnode, ready.fRecv, ready.fSend, ready.fError);
+    }
+    {
+        LOCK(cs_vNodes);
+        for (const NodeSocketReady& ready : vNodeReady) {
+#ifdef USE_EPOLL
+            // Keep the reference of nodes with received data left to read
+            if (socketEventsMode == SOCKETEVENTS_EPOLL && ready.pnode->fSocketRecvReady && !ready.pnode->fDisconnect) {
+                vEpollPending.push_back(ready.pnode);
+                continue;
+            }
+#endif
+            ready.pnode->Release();
+        }
+    }
+    return true;
+}
 
 void CConnman::ThreadSocketHandler()
 {
     unsigned int nPrevNodeCount = 0;
+    int64_t nLastInactivityCheck = 0;
     while (!interruptNet)
     {
         //
@@ -1143,6 +1616,7 @@ void CConnman::ThreadSocketHandler()
                     pnode->grantOutbound.Release();
 
                     // close socket and cleanup
+                    UnregisterNodeSocket(pnode);
                     pnode->CloseSocketDisconnect();
 
                     // hold in disconnected pool until all refs are released
@@ -1186,233 +1660,30 @@ void CConnman::ThreadSocketHandler()
                 clientInterface->NotifyNumConnectionsChanged(nPrevNodeCount);
         }
 
-        //
-        // Find which sockets have data to receive
-        //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
-
-        for (const ListenSocket& hListenSocket : vhListenSocket) {
-            FD_SET(hListenSocket.socket, &fdsetRecv);
-            hSocketMax = std::max(hSocketMax, hListenSocket.socket);
-            have_fds = true;
-        }
-
-        {
-            LOCK(cs_vNodes);
-            for (CNode* pnode : vNodes)
-            {
-                // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
-                //   happens when optimistic write failed, we choose to first drain the
-                //   write buffer in this case before receiving more. This avoids
-                //   needlessly queueing received data, if the remote peer is not themselves
-                //   receiving data. This means properly utilizing TCP flow control signalling.
-                // * Otherwise, if there is space left in the receive buffer, select() for
-                //   receiving data.
-                // * Hand off all complete messages to the processor, to be handled without
-                //   blocking here.
-
-                bool select_recv = !pnode->fPauseRecv;
-                bool select_send;
-                {
-                    LOCK(pnode->cs_vSend);
-                    select_send = !pnode->vSendMsg.empty();
-                }
-
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-
-                FD_SET(pnode->hSocket, &fdsetError);
-                hSocketMax = std::max(hSocketMax, pnode->hSocket);
-                have_fds = true;
-
-                if (select_send) {
-                    FD_SET(pnode->hSocket, &fdsetSend);
-                    continue;
-                }
-                if (select_recv) {
-                    FD_SET(pnode->hSocket, &fdsetRecv);
-                }
-            }
-        }
-
-        int nSelect = select(have_fds ? hSocketMax + 1 : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
-        if (interruptNet)
+        if (!ServiceSockets())
             return;
 
-        if (nSelect == SOCKET_ERROR)
-        {
-            if (have_fds)
-            {
-                int nErr = WSAGetLastError();
-                LogPrintf("socket select error %s\n", NetworkErrorString(nErr));
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
-            }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
-            if (!interruptNet.sleep_for(std::chrono::milliseconds(timeout.tv_usec/1000)))
-                return;
-        }
-
         //
-        // Accept new connections
+        // Inactivity checking
         //
-        for (const ListenSocket& hListenSocket : vhListenSocket)
-        {
-            if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+        int64_t nTime = GetTimeMillis();
+        if (nTime - nLastInactivityCheck >= 1000) {
+            nLastInactivityCheck = nTime;
+            std::vector<CNode*> vNodesCopy;
             {
-                AcceptConnection(hListenSocket);
+                LOCK(cs_vNodes);
+                vNodesCopy = vNodes;
+                for (CNode* pnode : vNodesCopy)
+                    pnode->AddRef();
             }
-        }
-
-        //
-        // Service each socket
-        //
-        std::vector<CNode*> vNodesCopy;
-        {
-            LOCK(cs_vNodes);
-            vNodesCopy = vNodes;
             for (CNode* pnode : vNodesCopy)
-                pnode->AddRef();
-        }
-        for (CNode* pnode : vNodesCopy)
-        {
-            if (interruptNet)
-                return;
-
-            //
-            // Receive
-            //
-            bool recvSet = false;
-            bool sendSet = false;
-            bool errorSet = false;
-            {
-                LOCK(pnode->cs_hSocket);
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-                recvSet = FD_ISSET(pnode->hSocket, &fdsetRecv);
-                sendSet = FD_ISSET(pnode->hSocket, &fdsetSend);
-                errorSet = FD_ISSET(pnode->hSocket, &fdsetError);
-            }
-            if (recvSet || errorSet)
+                InactivityCheck(pnode);
             {
-                // typical socket buffer is 8K-64K
-                char pchBuf[0x10000];
-                int nBytes = 0;
-                {
-                    LOCK(pnode->cs_hSocket);
-                    if (pnode->hSocket == INVALID_SOCKET)
-                        continue;
-                    nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                }
-                if (nBytes > 0)
-                {
-                    bool notify = false;
-                    if (!pnode->ReceiveMsgBytes(pchBuf, nBytes, notify))
-                        pnode->CloseSocketDisconnect();
-                    RecordBytesRecv(nBytes);
-                    if (notify) {
-                        size_t nSizeAdded = 0;
-                        auto it(pnode->vRecvMsg.begin());
-                        for (; it != pnode->vRecvMsg.end(); ++it) {
-                            if (!it->complete())
-                                break;
-                            nSizeAdded += it->vRecv.size() + CMessageHeader::HEADER_SIZE;
-                        }
-                        {
-                            LOCK(pnode->cs_vProcessMsg);
-                            pnode->vProcessMsg.splice(pnode->vProcessMsg.end(), pnode->vRecvMsg, pnode->vRecvMsg.begin(), it);
-                            pnode->nProcessQueueSize += nSizeAdded;
-                            pnode->fPauseRecv = pnode->nProcessQueueSize > nReceiveFloodSize;
-                        }
-                        WakeMessageHandler();
-                    }
-                }
-                else if (nBytes == 0)
-                {
-                    // socket closed gracefully
-                    if (!pnode->fDisconnect) {
-                        LogPrint(BCLog::NET, "socket closed\n");
-                    }
-                    pnode->CloseSocketDisconnect();
-                }
-                else if (nBytes < 0)
-                {
-                    // error
-                    int nErr = WSAGetLastError();
-                    if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                    {
-                        if (!pnode->fDisconnect)
-                            LogPrintf("socket recv error %s\n", NetworkErrorString(nErr));
-                        pnode->CloseSocketDisconnect();
-                    }
-                }
-            }
-
-            //
-            // Send
-            //
-            if (sendSet)
-            {
-                LOCK(pnode->cs_vSend);
-                size_t nBytes = SocketSendData(pnode);
-                if (nBytes) {
-                    RecordBytesSent(nBytes);
-                }
-            }
-
-            //
-            // Inactivity checking
-            //
-            int64_t nTime = GetSystemTimeInSeconds();
-            if (nTime - pnode->nTimeConnected > 60)
-            {
-                if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
-                {
-                    LogPrint(BCLog::NET, "socket no message in first 60 seconds, %d %d from %d\n", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->GetId());
-                    pnode->fDisconnect = true;
-                }
-                else if (nTime - pnode->nLastSend > TIMEOUT_INTERVAL)
-                {
-                    LogPrintf("socket sending timeout: %is\n", nTime - pnode->nLastSend);
-                    pnode->fDisconnect = true;
-                }
-                else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? TIMEOUT_INTERVAL : 90*60))
-                {
-                    LogPrintf("socket receive timeout: %is\n", nTime - pnode->nLastRecv);
-                    pnode->fDisconnect = true;
-                }
-                else if (pnode->nPingNonceSent && pnode->nPingUsecStart + TIMEOUT_INTERVAL * 1000000 < GetTimeMicros())
-                {
-                    LogPrintf("ping timeout: %fs\n", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
-                    pnode->fDisconnect = true;
-                }
-                else if (!pnode->fSuccessfullyConnected)
-                {
-                    LogPrintf("version handshake timeout from %d\n", pnode->GetId());
-                    pnode->fDisconnect = true;
-                }
+                LOCK(cs_vNodes);
+                for (CNode* pnode : vNodesCopy)
+                    pnode->Release();
             }
         }
-        {
-            LOCK(cs_vNodes);
-            for (CNode* pnode : vNodesCopy)
-                pnode->Release();
-        }
     }
 }
 
@@ -1420,9 +1691,27 @@ void CConnman::WakeMessageHandler()
 {
     {
         std::lock_guard<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = true;
+        vMsgProcWake.assign(vMsgProcWake.size(), true);
     }
-    condMsgProc.notify_one();
+    condMsgProc.notify_all();
+}
+
+void CConnman::WakeMessageHandler(const CNode* pnode)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutexMsgProc);
+        if (vMsgProcWake.empty())
+            return;
+        vMsgProcWake[GetMessageHandlerIndex(pnode)] = true;
+    }
+    // All handlers wait on the same condition variable, so a single
+    // notify_one could wake one that has nothing to do.
+    condMsgProc.notify_all();
+}
+
+int CConnman::GetMessageHandlerIndex(const CNode* pnode) const
+{
+    return pnode->GetId() % nMessageHandlerThreads;
 }
 
 
@@ -1998,21 +2287,25 @@ bool CConnman::OpenNetworkConnection(const CAddress& addrConnect, bool fCountFai
     {
         LOCK(cs_vNodes);
         vNodes.push_back(pnode);
+        RegisterNodeSocket(pnode);
     }
 
     return true;
 }
 
-void CConnman::ThreadMessageHandler()
+void CConnman::ThreadMessageHandler(int nWorker)
 {
     while (!flagInterruptMsgProc)
     {
         std::vector<CNode*> vNodesCopy;
         {
             LOCK(cs_vNodes);
-            vNodesCopy = vNodes;
-            for (CNode* pnode : vNodesCopy) {
+            vNodesCopy.reserve(vNodes.size() / nMessageHandlerThreads + 1);
+            for (CNode* pnode : vNodes) {
+                if (GetMessageHandlerIndex(pnode) != nWorker)
+                    continue;
                 pnode->AddRef();
+                vNodesCopy.push_back(pnode);
             }
         }
 
@@ -2046,9 +2339,51 @@ void CConnman::ThreadMessageHandler()
 
         std::unique_lock<std::mutex> lock(mutexMsgProc);
         if (!fMoreWork) {
-            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this] { return fMsgProcWake; });
+            condMsgProc.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::milliseconds(100), [this, nWorker] { return vMsgProcWake[nWorker] || flagInterruptMsgProc; });
+        }
+        vMsgProcWake[nWorker] = false;
+    }
+}
+
+bool CConnman::ScheduleBlockIO(CNode* pnode, std::function<void()> func)
+{
+    if (nBlockIOThreads == 0)
+        return false;
+    {
+        std::lock_guard<std::mutex> lock(mutexBlockIO);
+        if (threadBlockIO.empty())
+            return false;
+        pnode->AddRef();
+        pnode->fPendingBlockIO = true;
+        queueBlockIO.push_back(BlockIOJob{pnode, std::move(func)});
+    }
+    condBlockIO.notify_one();
+    return true;
+}
+
+void CConnman::ThreadBlockIO()
+{
+    while (true)
+    {
+        BlockIOJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutexBlockIO);
+            condBlockIO.wait(lock, [this] { return !queueBlockIO.empty() || flagInterruptMsgProc; });
+            if (flagInterruptMsgProc)
+                return;
+            job = std::move(queueBlockIO.front());
+            queueBlockIO.pop_front();
+        }
+
+        if (!job.pnode->fDisconnect)
+            job.func();
+
+        job.pnode->fPendingBlockIO = false;
+        WakeMessageHandler(job.pnode);
+        {
+            LOCK(cs_vNodes);
+            job.pnode->Release();
         }
-        fMsgProcWake = false;
     }
 }
 
@@ -2079,7 +2414,7 @@ bool CConnman::BindListenPort(const CService &addrBind, std::string& strError, b
         LogPrintf("%s\n", strError);
         return false;
     }
-    if (!IsSelectableSocket(hListenSocket))
+    if (!IsUsableSocket(hListenSocket))
     {
         strError = "Error: Couldn't create a listenable socket for incoming connections";
         LogPrintf("%s\n", strError);
@@ -2238,6 +2573,9 @@ CConnman::CConnman(uint64_t nSeed0In, uint64_t nSeed1In) : nSeed0(nSeed0In), nSe
     nReceiveFloodSize = 0;
     semOutbound = nullptr;
     semAddnode = nullptr;
+#ifdef USE_EPOLL
+    epollfd = -1;
+#endif
     flagInterruptMsgProc = false;
     SetTryNewOutboundPeer(false);
 
@@ -2290,6 +2628,16 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
     nMaxOutboundTotalBytesSentInCycle = 0;
     nMaxOutboundCycleStartTime = 0;
 
+#ifdef USE_EPOLL
+    if (socketEventsMode == SOCKETEVENTS_EPOLL) {
+        epollfd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollfd == -1) {
+            LogPrintf("epoll_create1 failed: %s, using -socketevents=select\n", NetworkErrorString(errno));
+            socketEventsMode = SOCKETEVENTS_SELECT;
+        }
+    }
+#endif
+
     if (fListen && !InitBinds(connOptions.vBinds, connOptions.vWhiteBinds)) {
         if (clientInterface) {
             clientInterface->ThreadSafeMessageBox(
@@ -2299,6 +2647,21 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         return false;
     }
 
+#ifdef USE_EPOLL
+    // Listening sockets stay level-triggered, one connection is accepted per round
+    if (socketEventsMode == SOCKETEVENTS_EPOLL) {
+        for (ListenSocket& hListenSocket : vhListenSocket) {
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.ptr = &hListenSocket;
+            if (epoll_ctl(epollfd, EPOLL_CTL_ADD, hListenSocket.socket, &event) != 0) {
+                LogPrintf("epoll_ctl failed to add listening socket: %s\n", NetworkErrorString(errno));
+                return false;
+            }
+        }
+    }
+#endif
+
     for (const auto& strDest : connOptions.vSeedNodes) {
         AddOneShot(strDest);
     }
@@ -2360,7 +2723,7 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
 
     {
         std::unique_lock<std::mutex> lock(mutexMsgProc);
-        fMsgProcWake = false;
+        vMsgProcWake.assign(nMessageHandlerThreads, false);
     }
 
     // Send and receive from sockets, accept connections
@@ -2379,7 +2742,21 @@ bool CConnman::Start(CScheduler& scheduler, const Options& connOptions)
         threadOpenConnections = std::thread(&TraceThread<std::function<void()> >, "opencon", std::function<void()>(std::bind(&CConnman::ThreadOpenConnections, this)));
 
     // Process messages
-    threadMessageHandler = std::thread(&TraceThread<std::function<void()> >, "msghand", std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this)));
+    for (int i = 0; i < nMessageHandlerThreads; i++) {
+        // TraceThread keeps using the name, so the thread owns its copy.
+        std::string strThreadName = nMessageHandlerThreads == 1 ? "msghand" : strprintf("msghand.%d", i);
+        threadMessageHandlers.emplace_back([this, i, strThreadName] { TraceThread(strThreadName.c_str(), std::function<void()>(std::bind(&CConnman::ThreadMessageHandler, this, i))); });
+    }
+
+    // Read blocks requested by peers
+    {
+        std::lock_guard<std::mutex> lock(mutexBlockIO);
+        for (int i = 0; i < nBlockIOThreads; i++) {
+            std::string strThreadName = strprintf("blockio.%d", i);
+            threadBlockIO.emplace_back([this, strThreadName] { TraceThread(strThreadName.c_str(), std::function<void()>(std::bind(&CConnman::ThreadBlockIO, this))); });
+        }
+    }
+    LogPrintf("Using %d message handler threads and %d block I/O threads\n", nMessageHandlerThreads, nBlockIOThreads);
 
     // Dump network addresses
     scheduler.scheduleEvery(std::bind(&CConnman::DumpData, this), DUMP_ADDRESSES_INTERVAL * 1000);
@@ -2409,6 +2786,11 @@ void CConnman::Interrupt()
         flagInterruptMsgProc = true;
     }
     condMsgProc.notify_all();
+    {
+        // Block I/O threads test flagInterruptMsgProc under mutexBlockIO
+        std::lock_guard<std::mutex> lock(mutexBlockIO);
+    }
+    condBlockIO.notify_all();
 
     interruptNet();
     InterruptSocks5(true);
@@ -2428,8 +2810,29 @@ void CConnman::Interrupt()
 
 void CConnman::Stop()
 {
-    if (threadMessageHandler.joinable())
-        threadMessageHandler.join();
+    for (std::thread& thread : threadMessageHandlers) {
+        if (thread.joinable())
+            thread.join();
+    }
+    threadMessageHandlers.clear();
+    std::vector<std::thread> vBlockIOThreads;
+    {
+        std::lock_guard<std::mutex> lock(mutexBlockIO);
+        vBlockIOThreads.swap(threadBlockIO);
+    }
+    for (std::thread& thread : vBlockIOThreads) {
+        if (thread.joinable())
+            thread.join();
+    }
+    {
+        // Jobs still queued when the threads stopped are dropped
+        LOCK(cs_vNodes);
+        for (BlockIOJob& job : queueBlockIO) {
+            job.pnode->fPendingBlockIO = false;
+            job.pnode->Release();
+        }
+        queueBlockIO.clear();
+    }
     if (threadOpenConnections.joinable())
         threadOpenConnections.join();
     if (threadOpenAddedConnections.joinable())
@@ -2453,6 +2856,14 @@ void CConnman::Stop()
             if (!CloseSocket(hListenSocket.socket))
                 LogPrintf("CloseSocket(hListenSocket) failed with error %s\n", NetworkErrorString(WSAGetLastError()));
 
+#ifdef USE_EPOLL
+    vEpollPending.clear();
+    if (epollfd != -1) {
+        close(epollfd);
+        epollfd = -1;
+    }
+#endif
+
     // clean up some globals (to help leak detection)
     for (CNode *pnode : vNodes) {
         DeleteNode(pnode);
@@ -2690,6 +3101,11 @@ uint64_t CConnman::GetTotalBytesSent()
     return nTotalBytesSent;
 }
 
+CNetBufferPool::Stats CConnman::GetBufferPoolStats() const
+{
+    return netBufferPool.GetStats();
+}
+
 ServiceFlags CConnman::GetLocalServices() const
 {
     return nLocalServices;
@@ -2767,6 +3183,11 @@ CNode::CNode(NodeId idIn, ServiceFlags nLocalServicesIn, int nMyStartingHeightIn
     nextSendTimeFeeFilter = 0;
     fPauseRecv = false;
     fPauseSend = false;
+    fSocketRecvReady = false;
+    fSocketHangup = false;
+    fSocketSendReady = false;
+    fSocketQueued = false;
+    fPendingBlockIO = false;
     nProcessQueueSize = 0;
 
     for (const std::string &msg : getAllNetMessageTypes())
@@ -2833,13 +3254,29 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
     size_t nTotalSize = nMessageSize + CMessageHeader::HEADER_SIZE;
     LogPrint(BCLog::NET, "sending %s (%d bytes) peer=%d\n",  SanitizeString(msg.command.c_str()), nMessageSize, pnode->GetId());
 
+    // Small messages go out as a single pooled buffer holding the header
+    // and the payload; larger ones keep their payload buffer as it is.
+    bool fCoalesce = nMessageSize > 0 && nTotalSize <= 4096;
+    bool fPooled;
+    {
+        LOCK(pnode->cs_vSend);
+        fPooled = pnode->nSendSize < MAX_NETBUFFERPOOL_NODE_BYTES;
+    }
+    const size_t nHeaderCapacity = fCoalesce ? nTotalSize : size_t(CMessageHeader::HEADER_SIZE);
     std::vector<unsigned char> serializedHeader;
-    serializedHeader.reserve(CMessageHeader::HEADER_SIZE);
+    if (fPooled)
+        netBufferPool.Get(serializedHeader, nHeaderCapacity);
+    else
+        serializedHeader.reserve(nHeaderCapacity);
     uint256 hash = Hash(msg.data.data(), msg.data.data() + nMessageSize);
     CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), nMessageSize);
     memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
 
     CVectorWriter{SER_NETWORK, INIT_PROTO_VERSION, serializedHeader, 0, hdr};
+    if (fCoalesce) {
+        serializedHeader.insert(serializedHeader.end(), msg.data.begin(), msg.data.end());
+        netBufferPool.Put(msg.data);
+    }
 
     size_t nBytesSent = 0;
     {
@@ -2853,7 +3290,7 @@ void CConnman::PushMessage(CNode* pnode, CSerializedNetMsg&& msg)
         if (pnode->nSendSize > nSendBufferMaxSize)
             pnode->fPauseSend = true;
         pnode->vSendMsg.push_back(std::move(serializedHeader));
-        if (nMessageSize)
+        if (nMessageSize && !fCoalesce)
             pnode->vSendMsg.push_back(std::move(msg.data));
 
         // If write queue empty, attempt "optimistic write"
@@ -14,6 +14,7 @@
 #include "hash.h"
 #include "limitedmap.h"
 #include "netaddress.h"
+#include "netbufferpool.h"
 #include "policy/feerate.h"
 #include "protocol.h"
 #include "random.h"
@@ -73,6 +74,34 @@ static const size_t MAPASKFOR_MAX_SZ = MAX_INV_SZ;
 static const size_t SETASKFOR_MAX_SZ = 2 * MAX_INV_SZ;
 /** The maximum number of peer connections to maintain. */
 static const unsigned int DEFAULT_MAX_PEER_CONNECTIONS = 125;
+
+/** How the socket handler thread waits for network sockets to become ready (-socketevents) */
+enum SocketEventsMode {
+    SOCKETEVENTS_SELECT, //!< select(), limited to FD_SETSIZE descriptors
+    SOCKETEVENTS_EPOLL,  //!< edge-triggered epoll, Linux only
+};
+#ifdef USE_EPOLL
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_EPOLL;
+#else
+static const SocketEventsMode DEFAULT_SOCKETEVENTS = SOCKETEVENTS_SELECT;
+#endif
+
+/** Parse a -socketevents value. Fails for modes this build does not support. */
+bool ParseSocketEventsMode(const std::string& str, SocketEventsMode& mode);
+/** Name of a mode as taken by -socketevents */
+std::string GetSocketEventsModeName(SocketEventsMode mode);
+/** Comma separated names of the modes this build supports */
+std::string GetSupportedSocketEventsModes();
+/** -msghandlers default, 0 = one thread per core up to DEFAULT_MAX_MSGHANDLER_THREADS */
+static const int DEFAULT_MSGHANDLER_THREADS = 0;
+/** Number of message handler threads autodetection picks at most */
+static const int DEFAULT_MAX_MSGHANDLER_THREADS = 4;
+/** Maximum number of message handler threads */
+static const int MAX_MSGHANDLER_THREADS = 16;
+/** -blockiothreads default, 0 = read blocks for getdata on the message handler thread */
+static const int DEFAULT_BLOCKIO_THREADS = 2;
+/** Maximum number of block I/O threads */
+static const int MAX_BLOCKIO_THREADS = 16;
 /** The default for -maxuploadtarget. 0 = Unlimited */
 static const uint64_t DEFAULT_MAX_UPLOAD_TARGET = 0;
 /** The default timeframe for -maxuploadtarget. 1 day. */
@@ -145,6 +174,9 @@ public:
         std::vector<std::string> vSeedNodes;
         std::vector<CSubNet> vWhitelistedRange;
         std::vector<CService> vBinds, vWhiteBinds;
+        SocketEventsMode socketEventsMode = DEFAULT_SOCKETEVENTS;
+        int nMessageHandlerThreads = 1;
+        int nBlockIOThreads = 0;
     };
 
     void Init(const Options& connOptions) {
@@ -162,6 +194,9 @@ public:
         nMaxOutboundTimeframe = connOptions.nMaxOutboundTimeframe;
         nMaxOutboundLimit = connOptions.nMaxOutboundLimit;
         vWhitelistedRange = connOptions.vWhitelistedRange;
+        socketEventsMode = connOptions.socketEventsMode;
+        nMessageHandlerThreads = std::max(connOptions.nMessageHandlerThreads, 1);
+        nBlockIOThreads = std::max(connOptions.nBlockIOThreads, 0);
     }
 
     CConnman(uint64_t seed0, uint64_t seed1);
@@ -298,6 +333,7 @@ public:
 
     uint64_t GetTotalBytesRecv();
     uint64_t GetTotalBytesSent();
+    CNetBufferPool::Stats GetBufferPoolStats() const;
 
     void SetBestHeight(int height);
     int GetBestHeight() const;
@@ -307,7 +343,19 @@ public:
 
     unsigned int GetReceiveFloodSize() const;
 
+    /** Wake every message handler thread. */
     void WakeMessageHandler();
+    /** Wake the message handler thread that pnode is assigned to. */
+    void WakeMessageHandler(const CNode* pnode);
+
+    /**
+     * Run func on a block I/O thread so that a slow disk read does not hold
+     * up the message handler. pnode is referenced until func has run, and
+     * fPendingBlockIO is set for that time so that the node's other messages
+     * wait and responses keep their order. Returns false without running func
+     * if there are no block I/O threads.
+     */
+    bool ScheduleBlockIO(CNode* pnode, std::function<void()> func);
 private:
     struct ListenSocket {
         SOCKET socket;
@@ -323,8 +371,38 @@ private:
     void AddOneShot(const std::string& strDest);
     void ProcessOneShot();
     void ThreadOpenConnections();
-    void ThreadMessageHandler();
+    void ThreadMessageHandler(int nWorker);
+    void ThreadBlockIO();
+    int GetMessageHandlerIndex(const CNode* pnode) const;
     void AcceptConnection(const ListenSocket& hListenSocket);
+
+    /** A node socket to be serviced by the socket handler thread, which holds a reference to the node. */
+    struct NodeSocketReady
+    {
+        CNode* pnode;
+        bool fRecv;
+        bool fSend;
+        bool fError;
+    };
+
+    /** Wait up to 50ms for socket readiness with select(). Every node is returned in vNodeReady. */
+    void SocketEventsSelect(std::vector<const ListenSocket*>& vListenReady, std::vector<NodeSocketReady>& vNodeReady);
+#ifdef USE_EPOLL
+    /** Wait up to 50ms for socket readiness with epoll. Only nodes with readiness to act on are returned. */
+    void SocketEventsEpoll(std::vector<const ListenSocket*>& vListenReady, std::vector<NodeSocketReady>& vNodeReady);
+#endif
+    /** Add the socket of a new node to the event backend. Requires cs_vNodes. */
+    void RegisterNodeSocket(CNode* pnode);
+    /** Remove the socket of a node from the event backend, before it is closed. */
+    void UnregisterNodeSocket(CNode* pnode);
+    /** Whether the event backend can watch hSocket. */
+    bool IsUsableSocket(SOCKET hSocket) const;
+    /** Receive from and send to the socket of pnode, as reported ready. */
+    void SocketHandlerNode(CNode* pnode, bool fRecv, bool fSend, bool fError);
+    /** Wait for socket readiness, accept connections and service the ready nodes once. Returns false if interrupted. */
+    bool ServiceSockets();
+    /** Disconnect pnode if it has been silent for too long. */
+    void InactivityCheck(CNode* pnode);
     void ThreadSocketHandler();
     void ThreadDNSAddressSeed();
 
@@ -343,7 +421,7 @@ private:
 
     NodeId GetNewNodeId();
 
-    size_t SocketSendData(CNode *pnode) const;
+    size_t SocketSendData(CNode *pnode);
     //!check is the banlist has unwritten changes
     bool BannedSetIsDirty();
     //!set the "dirty" flag for the banlist
@@ -367,6 +445,9 @@ private:
     uint64_t nTotalBytesRecv;
     uint64_t nTotalBytesSent;
 
+    // Recycled receive and send buffers
+    CNetBufferPool netBufferPool;
+
     // outbound limit & stats
     uint64_t nMaxOutboundTotalBytesSentInCycle;
     uint64_t nMaxOutboundCycleStartTime;
@@ -381,6 +462,12 @@ private:
     unsigned int nReceiveFloodSize;
 
     std::vector<ListenSocket> vhListenSocket;
+    SocketEventsMode socketEventsMode;
+#ifdef USE_EPOLL
+    int epollfd;
+    //! Nodes, with a reference held, whose latched readiness was not used up in the last round (socket handler thread only)
+    std::vector<CNode*> vEpollPending;
+#endif
     std::atomic<bool> fNetworkActive;
     banmap_t setBanned;
     CCriticalSection cs_setBanned;
@@ -415,8 +502,12 @@ private:
     /** SipHasher seeds for deterministic randomness */
     const uint64_t nSeed0, nSeed1;
 
-    /** flag for waking the message processor. */
-    bool fMsgProcWake;
+    /** Peers are pinned to message handler threads by node id, so each
+     *  node's receive and send processing runs on one thread only. */
+    int nMessageHandlerThreads;
+
+    /** flags for waking the message handler threads, one per thread. */
+    std::vector<bool> vMsgProcWake;
 
     std::condition_variable condMsgProc;
     std::mutex mutexMsgProc;
@@ -428,7 +519,19 @@ private:
     std::thread threadSocketHandler;
     std::thread threadOpenAddedConnections;
     std::thread threadOpenConnections;
-    std::thread threadMessageHandler;
+    std::vector<std::thread> threadMessageHandlers;
+
+    struct BlockIOJob
+    {
+        CNode* pnode;
+        std::function<void()> func;
+    };
+
+    int nBlockIOThreads;
+    std::deque<BlockIOJob> queueBlockIO;
+    std::condition_variable condBlockIO;
+    std::mutex mutexBlockIO;
+    std::vector<std::thread> threadBlockIO;
 
     /** flag for deciding to connect to an extra outbound peer,
      *  in excess of nMaxOutbound
@@ -552,8 +655,7 @@ public:
 
 class CNetMessage {
 private:
-    mutable CHash256 hasher;
-    mutable uint256 data_hash;
+    mutable uint256 data_hash;      // checksum hash, computed on first use
 public:
     bool in_data;                   // parsing header (false) or data (true)
 
@@ -566,7 +668,15 @@ public:
 
     int64_t nTime;                  // time (in microseconds) of message receipt.
 
-    CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, int nTypeIn, int nVersionIn) : hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn), vRecv(nTypeIn, nVersionIn) {
+    CNetBufferPool* pool;           // where the buffers come from and go back to, if anywhere
+
+    CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, int nTypeIn, int nVersionIn, CNetBufferPool* poolIn = nullptr) : hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn), vRecv(nTypeIn, nVersionIn), pool(poolIn) {
+        if (pool) {
+            // Small messages keep using this buffer for their payload
+            CSerializeData buf;
+            pool->Get(buf, CMessageHeader::HEADER_SIZE);
+            hdrbuf.SwapBuffer(buf);
+        }
         hdrbuf.resize(24);
         in_data = false;
         nHdrPos = 0;
@@ -574,6 +684,11 @@ public:
         nTime = 0;
     }
 
+    ~CNetMessage();
+    CNetMessage(CNetMessage&&) = default;
+    CNetMessage(const CNetMessage&) = delete;
+    CNetMessage& operator=(const CNetMessage&) = delete;
+
     bool complete() const
     {
         if (!in_data)
@@ -581,7 +696,13 @@ public:
         return (hdr.nMessageSize == nDataPos);
     }
 
+    //! Memory held by the buffers, which pooled ones round up to their size class
+    size_t GetMemoryUsage() const { return hdrbuf.capacity() + vRecv.capacity(); }
+
     const uint256& GetMessageHash() const;
+    bool HasMessageHash() const { return !data_hash.IsNull(); }
+    /** Compute the hashes of n complete messages together, several at a time where the CPU allows. */
+    static void ComputeMessageHashes(const CNetMessage* const msgs[], size_t n);
 
     void SetVersion(int nVersionIn)
     {
@@ -658,6 +779,15 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv;
     std::atomic_bool fPauseSend;
+    // Readiness reported by an edge-triggered event backend, kept until
+    // recv() finds the socket drained or send() finds it full. Used by the
+    // socket handler thread only.
+    bool fSocketRecvReady;
+    bool fSocketHangup; //!< the peer closed its end or the socket failed, recv() will not block
+    bool fSocketSendReady;
+    bool fSocketQueued; //!< already in this round's list of sockets to service
+    //! A getdata response is being read from disk on a block I/O thread
+    std::atomic_bool fPendingBlockIO;
 protected:
 
     mapMsgCmdSize mapSendBytesPerMsgCmd;
@@ -668,6 +798,9 @@ public:
     std::atomic<int> nStartingHeight;
 
     // flood relay
+    // Other peers' message handlers push addresses to relay here, so
+    // vAddrToSend and addrKnown are protected by cs_addrSend.
+    CCriticalSection cs_addrSend;
     std::vector<CAddress> vAddrToSend;
     CRollingBloomFilter addrKnown;
     bool fGetAddr;
@@ -760,7 +893,7 @@ public:
         return nRefCount;
     }
 
-    bool ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete);
+    bool ReceiveMsgBytes(const char *pch, unsigned int nBytes, bool& complete, CNetBufferPool* pool = nullptr);
 
     void SetRecvVersion(int nVersionIn)
     {
@@ -792,6 +925,7 @@ public:
 
     void AddAddressKnown(const CAddress& _addr)
     {
+        LOCK(cs_addrSend);
         addrKnown.insert(_addr.GetKey());
     }
 
@@ -800,6 +934,7 @@ public:
         // Known checking here is only to save space from duplicates.
         // SendMessages will filter it again for knowns that were added
         // after addresses were pushed.
+        LOCK(cs_addrSend);
         if (_addr.IsValid() && !addrKnown.contains(_addr.GetKey())) {
             if (vAddrToSend.size() >= MAX_ADDR_TO_SEND) {
                 vAddrToSend[insecure_rand.randrange(vAddrToSend.size())] = _addr;
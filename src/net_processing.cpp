@@ -6,6 +6,7 @@
 #include "net_processing.h"
 
 #include "addrman.h"
+#include "auxpow/store.h"
 #include "arith_uint256.h"
 #include "blockencodings.h"
 #include "chainparams.h"
@@ -63,6 +64,25 @@ static std::vector<std::pair<uint256, CTransactionRef>> vExtraTxnForCompact GUAR
 
 static const uint64_t RANDOMIZER_ID_ADDRESS_RELAY = 0x3cac0035b5866b90ULL; // SHA256("main address relay")[0:8]
 
+/**
+ * Messages are processed on several threads, each owning a fixed set of
+ * peers, so per-peer state in CNode needs no locking of its own. State
+ * shared between peers is protected by:
+ *  - cs_main: CNodeState, block download and orphan tracking, mapRelay.
+ *  - CNode::cs_inventory, cs_filter, cs_addrSend: relay queues that other
+ *    peers' handlers push to.
+ *  - cs_most_recent_block: the cached most recent block.
+ *  - cs_process_block: taken before cs_main around ProcessNewBlock, so that
+ *    blocks from different peers are connected and announced one at a time.
+ */
+static CCriticalSection cs_process_block;
+
+static bool ProcessNewBlockFromPeer(const CChainParams& chainparams, const std::shared_ptr<const CBlock>& pblock, bool fForceProcessing, bool* fNewBlock)
+{
+    LOCK(cs_process_block);
+    return ProcessNewBlock(chainparams, pblock, fForceProcessing, fNewBlock);
+}
+
 // Internal stuff
 namespace {
     /** Number of nodes with fSyncStarted. */
@@ -1013,6 +1033,68 @@ static void RelayAddress(const CAddress& addr, bool fReachable, CConnman* connma
     connman->ForEachNodeThen(std::move(sortfunc), std::move(pushfunc));
 }
 
+/**
+ * Send a full block from disk. When the bytes stored on disk are exactly
+ * the message payload (a witness block, or a block from before segwit could
+ * have added witness data), they are pushed as they are instead of being
+ * deserialized and serialized again.
+ */
+static void SendBlockFromDisk(CNode* pfrom, CConnman* connman, const CDiskBlockPos& pos, const uint256& hash, int nSendFlags, bool fRaw, const uint256& hashContinueTip)
+{
+    const CNetMsgMaker msgMaker(pfrom->GetSendVersion());
+    bool fRead;
+    if (fRaw) {
+        CSerializedNetMsg msg;
+        msg.command = NetMsgType::BLOCK;
+        fRead = ReadRawBlockFromDisk(msg.data, pos, hash, Params().MessageStart(), Params().GetConsensus());
+        if (fRead)
+            connman->PushMessage(pfrom, std::move(msg));
+    } else {
+        CBlock block;
+        fRead = ReadBlockFromDisk(block, pos, hash, Params().GetConsensus());
+        if (fRead)
+            connman->PushMessage(pfrom, msgMaker.Make(nSendFlags, NetMsgType::BLOCK, block));
+    }
+    if (!fRead) {
+        // The block file may have been pruned since the request was queued
+        LogPrintf("%s: could not read block %s for peer=%d, disconnecting\n", "ProcessGetData", hash.ToString(), pfrom->GetId());
+        pfrom->fDisconnect = true;
+        return;
+    }
+    if (!hashContinueTip.IsNull()) {
+        // Trigger the peer node to send a getblocks request for the next batch of inventory
+        std::vector<CInv> vInv;
+        vInv.push_back(CInv(MSG_BLOCK, hashContinueTip));
+        connman->PushMessage(pfrom, msgMaker.Make(NetMsgType::INV, vInv));
+    }
+}
+
+/**
+ * Answer a getdata for a full block from disk, on a block I/O thread if
+ * there is one. The block position and the hashContinue reply are taken
+ * here under cs_main; the read and the send happen without it.
+ */
+static void ServeBlockFromDisk(CNode* pfrom, const CInv& inv, const CBlockIndex* pindex, CConnman* connman, const Consensus::Params& consensusParams) EXCLUSIVE_LOCKS_REQUIRED(cs_main)
+{
+    AssertLockHeld(cs_main);
+    const CDiskBlockPos pos = pindex->GetBlockPos();
+    const uint256 hash = pindex->GetBlockHash();
+    const int nSendFlags = inv.type == MSG_BLOCK ? SERIALIZE_TRANSACTION_NO_WITNESS : 0;
+    // Blocks are stored with witness serialization
+    const bool fRaw = inv.type == MSG_WITNESS_BLOCK || !IsWitnessEnabled(pindex->pprev, consensusParams);
+    uint256 hashContinueTip;
+    if (inv.hash == pfrom->hashContinue) {
+        hashContinueTip = chainActive.Tip()->GetBlockHash();
+        pfrom->hashContinue.SetNull();
+    }
+
+    auto func = [pfrom, connman, pos, hash, nSendFlags, fRaw, hashContinueTip] {
+        SendBlockFromDisk(pfrom, connman, pos, hash, nSendFlags, fRaw, hashContinueTip);
+    };
+    if (!connman->ScheduleBlockIO(pfrom, func))
+        func();
+}
+
 void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParams, CConnman* connman, const std::atomic<bool>& interruptMsgProc)
 {
     std::deque<CInv>::iterator it = pfrom->vRecvGetData.begin();
@@ -1083,6 +1165,14 @@ void static ProcessGetData(CNode* pfrom, const Consensus::Params& consensusParam
                     pfrom->fDisconnect = true;
                     send = false;
                 }
+                // Full blocks that are not cached are read on a block I/O
+                // thread, so serving history to one peer does not stall the
+                // others behind the disk read.
+                if (send && (mi->second->nStatus & BLOCK_HAVE_DATA) && (inv.type == MSG_BLOCK || inv.type == MSG_WITNESS_BLOCK) &&
+                        !(a_recent_block && a_recent_block->GetHash() == mi->second->GetBlockHash())) {
+                    ServeBlockFromDisk(pfrom, inv, mi->second, connman, consensusParams);
+                    send = false;
+                }
                 // Pruned nodes may have deleted the block, so check whether
                 // it's available before trying to send.
                 if (send && (mi->second->nStatus & BLOCK_HAVE_DATA))
@@ -2039,14 +2129,19 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
 
         // we must use CBlocks, as CBlockHeaders won't include the 0x00 nTx count at the end
         std::vector<CBlock> vHeaders;
+        std::vector<const CBlockIndex*> vIndex;
         int nLimit = MAX_HEADERS_RESULTS;
         LogPrint(BCLog::NET, "getheaders %d to %s from peer=%d\n", (pindex ? pindex->nHeight : -1), hashStop.IsNull() ? "end" : hashStop.ToString(), pfrom->GetId());
         for (; pindex; pindex = chainActive.Next(pindex))
         {
-            vHeaders.push_back(pindex->GetBlockHeader(mapDirtyAuxPow));
+            vIndex.push_back(pindex);
             if (--nLimit <= 0 || pindex->GetBlockHash() == hashStop)
                 break;
         }
+        PrefetchAuxPow(vIndex);
+        vHeaders.reserve(vIndex.size());
+        for (const CBlockIndex* pindexHeader : vIndex)
+            vHeaders.push_back(pindexHeader->GetBlockHeader(mapDirtyAuxPow));
         // pindex can be nullptr either if we sent chainActive.Tip() OR
         // if our peer has chainActive.Tip() (and thus we are sending an empty
         // headers message). In both cases it's safe to update
@@ -2452,7 +2547,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             // we have a chain with at least nMinimumChainWork), and we ignore
             // compact blocks with less work than our tip, it is safe to treat
             // reconstructed compact blocks as having been requested.
-            ProcessNewBlock(chainparams, pblock, /*fForceProcessing=*/true, &fNewBlock);
+            ProcessNewBlockFromPeer(chainparams, pblock, /*fForceProcessing=*/true, &fNewBlock);
             if (fNewBlock) {
                 pfrom->nLastBlockTime = GetTime();
             } else {
@@ -2536,7 +2631,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             // disk-space attacks), but this should be safe due to the
             // protections in the compact block handler -- see related comment
             // in compact block optimistic reconstruction handling.
-            ProcessNewBlock(chainparams, pblock, /*fForceProcessing=*/true, &fNewBlock);
+            ProcessNewBlockFromPeer(chainparams, pblock, /*fForceProcessing=*/true, &fNewBlock);
             if (fNewBlock) {
                 pfrom->nLastBlockTime = GetTime();
             } else {
@@ -2591,7 +2686,7 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
             mapBlockSource.emplace(hash, std::make_pair(pfrom->GetId(), true));
         }
         bool fNewBlock = false;
-        ProcessNewBlock(chainparams, pblock, forceProcessing, &fNewBlock);
+        ProcessNewBlockFromPeer(chainparams, pblock, forceProcessing, &fNewBlock);
         if (fNewBlock) {
             pfrom->nLastBlockTime = GetTime();
         } else {
@@ -2621,7 +2716,10 @@ bool static ProcessMessage(CNode* pfrom, const std::string& strCommand, CDataStr
         }
         pfrom->fSentAddr = true;
 
-        pfrom->vAddrToSend.clear();
+        {
+            LOCK(pfrom->cs_addrSend);
+            pfrom->vAddrToSend.clear();
+        }
         std::vector<CAddress> vAddr = connman->GetAddresses();
         FastRandomContext insecure_rand;
         for (const CAddress &addr : vAddr)
@@ -2856,12 +2954,21 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
     //
     bool fMoreWork = false;
 
+    // A block for this peer is still being read from disk. Its response
+    // goes out first; the block I/O thread wakes us when it is sent.
+    if (pfrom->fPendingBlockIO)
+        return false;
+
     if (!pfrom->vRecvGetData.empty())
         ProcessGetData(pfrom, chainparams.GetConsensus(), connman, interruptMsgProc);
 
     if (pfrom->fDisconnect)
         return false;
 
+    // ProcessGetData may have just handed a block to the block I/O thread
+    if (pfrom->fPendingBlockIO)
+        return false;
+
     // this maintains the order of responses
     if (!pfrom->vRecvGetData.empty()) return true;
 
@@ -2870,16 +2977,28 @@ bool PeerLogicValidation::ProcessMessages(CNode* pfrom, std::atomic<bool>& inter
         return false;
 
     std::list<CNetMessage> msgs;
+    const CNetMessage* vToHash[MAX_CHECKSUM_BATCH];
+    size_t nToHash = 0;
     {
         LOCK(pfrom->cs_vProcessMsg);
         if (pfrom->vProcessMsg.empty())
             return false;
         // Just take one message
         msgs.splice(msgs.begin(), pfrom->vProcessMsg, pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().vRecv.size() + CMessageHeader::HEADER_SIZE;
+        pfrom->nProcessQueueSize -= msgs.front().GetMemoryUsage();
         pfrom->fPauseRecv = pfrom->nProcessQueueSize > connman->GetReceiveFloodSize();
         fMoreWork = !pfrom->vProcessMsg.empty();
+        // If its checksum is still to be computed, do so together with the
+        // messages queued behind it. Only this thread removes messages from
+        // vProcessMsg, so they stay valid once the lock is released.
+        if (!msgs.front().HasMessageHash()) {
+            vToHash[nToHash++] = &msgs.front();
+            for (auto it = pfrom->vProcessMsg.begin(); it != pfrom->vProcessMsg.end() && nToHash < MAX_CHECKSUM_BATCH; ++it)
+                vToHash[nToHash++] = &*it;
+        }
     }
+    if (nToHash)
+        CNetMessage::ComputeMessageHashes(vToHash, nToHash);
     CNetMessage& msg(msgs.front());
 
     msg.SetVersion(pfrom->GetRecvVersion());
@@ -3169,6 +3288,7 @@ bool PeerLogicValidation::SendMessages(CNode* pto, std::atomic<bool>& interruptM
         //
         if (pto->nNextAddrSend < nNow) {
             pto->nNextAddrSend = PoissonNextSend(nNow, AVG_ADDRESS_BROADCAST_INTERVAL);
+            LOCK(pto->cs_addrSend);
             std::vector<CAddress> vAddr;
             vAddr.reserve(pto->vAddrToSend.size());
             for (const CAddress& addr : pto->vAddrToSend)
@@ -34,6 +34,8 @@ static constexpr int64_t STALE_CHECK_INTERVAL = 60; // 1 minutes
 static constexpr int64_t EXTRA_PEER_CHECK_INTERVAL = 45;
 /** Minimum time an outbound-peer-eviction candidate must be connected for, in order to evict, in seconds */
 static constexpr int64_t MINIMUM_CONNECT_TIME = 30;
+/** Maximum number of a peer's queued messages whose checksums are computed in one batch */
+static const size_t MAX_CHECKSUM_BATCH = 16;
 
 class PeerLogicValidation : public CValidationInterface, public NetEventsInterface {
 private:
@@ -0,0 +1,123 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "netbufferpool.h"
+
+const std::array<size_t, CNetBufferPool::NUM_CLASSES> CNetBufferPool::CLASS_SIZES = {{256, 1024, 4096, 32 * 1024, 256 * 1024}};
+
+namespace {
+
+/** The smallest class that holds nSize bytes, or -1 if none does */
+int ClassFor(size_t nSize)
+{
+    for (size_t c = 0; c < CNetBufferPool::NUM_CLASSES; c++) {
+        if (nSize <= CNetBufferPool::CLASS_SIZES[c])
+            return c;
+    }
+    return -1;
+}
+
+/** The largest class a buffer of nCapacity can serve, or -1 if it is too
+ *  small for any or so large that keeping it would waste memory */
+int ClassOf(size_t nCapacity)
+{
+    if (nCapacity > 2 * CNetBufferPool::CLASS_SIZES.back())
+        return -1;
+    for (int c = CNetBufferPool::NUM_CLASSES - 1; c >= 0; c--) {
+        if (nCapacity >= CNetBufferPool::CLASS_SIZES[c])
+            return c;
+    }
+    return -1;
+}
+
+} // namespace
+
+CNetBufferPool::CNetBufferPool(size_t nClassBytesIn) : nClassBytes(nClassBytesIn), nHits(0), nMisses(0), nRecycled(0), nDropped(0)
+{
+    vClassFreeBytes.fill(0);
+}
+
+template <typename V>
+void CNetBufferPool::GetBuffer(FreeLists<V>& lists, V& buf, size_t nSize)
+{
+    buf.clear();
+    if (buf.capacity() >= nSize)
+        return;
+
+    int c = ClassFor(nSize);
+    if (c >= 0) {
+        std::unique_lock<std::mutex> lock(cs);
+        std::vector<V>& vFree = lists[c];
+        if (!vFree.empty()) {
+            buf.swap(vFree.back());
+            vFree.pop_back();
+            vClassFreeBytes[c] -= buf.capacity();
+            lock.unlock();
+            nHits++;
+            return;
+        }
+    }
+    nMisses++;
+    // Round up to the class so the buffer can serve the class again later
+    buf.reserve(c >= 0 ? CLASS_SIZES[c] : nSize);
+}
+
+template <typename V>
+void CNetBufferPool::PutBuffer(FreeLists<V>& lists, V& buf)
+{
+    if (buf.capacity() == 0)
+        return;
+    buf.clear();
+
+    int c = ClassOf(buf.capacity());
+    if (c >= 0) {
+        std::lock_guard<std::mutex> lock(cs);
+        if (vClassFreeBytes[c] + buf.capacity() <= nClassBytes) {
+            vClassFreeBytes[c] += buf.capacity();
+            lists[c].emplace_back();
+            lists[c].back().swap(buf);
+            nRecycled++;
+            return;
+        }
+    }
+    nDropped++;
+    V().swap(buf);
+}
+
+void CNetBufferPool::Get(CSerializeData& buf, size_t nSize)
+{
+    GetBuffer(freeRecv, buf, nSize);
+}
+
+void CNetBufferPool::Get(std::vector<unsigned char>& buf, size_t nSize)
+{
+    GetBuffer(freeSend, buf, nSize);
+}
+
+void CNetBufferPool::Put(CSerializeData& buf)
+{
+    PutBuffer(freeRecv, buf);
+}
+
+void CNetBufferPool::Put(std::vector<unsigned char>& buf)
+{
+    PutBuffer(freeSend, buf);
+}
+
+CNetBufferPool::Stats CNetBufferPool::GetStats() const
+{
+    Stats stats;
+    stats.nHits = nHits;
+    stats.nMisses = nMisses;
+    stats.nRecycled = nRecycled;
+    stats.nDropped = nDropped;
+    stats.nFreeBuffers = 0;
+    stats.nFreeBytes = 0;
+    std::lock_guard<std::mutex> lock(cs);
+    for (size_t c = 0; c < NUM_CLASSES; c++) {
+        stats.nFreeBuffers += freeRecv[c].size() + freeSend[c].size();
+        stats.nFreeBytes += vClassFreeBytes[c];
+    }
+    return stats;
+}
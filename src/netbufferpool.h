@@ -0,0 +1,79 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NETBUFFERPOOL_H
+#define BITCOIN_NETBUFFERPOOL_H
+
+#include "support/allocators/zeroafterfree.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+/** Bytes of free buffers kept at most in each size class */
+static const size_t DEFAULT_NETBUFFERPOOL_CLASS_BYTES = 1024 * 1024;
+/** Queued bytes up to which a connection takes its receive or send buffers
+ *  from the pool. Beyond that they are allocated exactly, so a single peer
+ *  cannot hold on to the free buffers shared by all of them. */
+static const size_t MAX_NETBUFFERPOOL_NODE_BYTES = 256 * 1024;
+
+/**
+ * Free buffers for network messages in a few size classes, shared by all
+ * connections of a CConnman. Receive and send buffers are taken from here
+ * and given back once the message is processed or sent, so the steady
+ * stream of small inv, tx and ping messages does not go through malloc.
+ */
+class CNetBufferPool
+{
+public:
+    static const size_t NUM_CLASSES = 5;
+    //! Capacities handed out. Larger requests are allocated as asked.
+    static const std::array<size_t, NUM_CLASSES> CLASS_SIZES;
+
+    struct Stats
+    {
+        uint64_t nHits;       //!< requests served with a free buffer
+        uint64_t nMisses;     //!< requests that had to allocate
+        uint64_t nRecycled;   //!< buffers kept for reuse
+        uint64_t nDropped;    //!< buffers freed, their class being full or them too small or large
+        size_t nFreeBuffers;
+        size_t nFreeBytes;
+    };
+
+    explicit CNetBufferPool(size_t nClassBytesIn = DEFAULT_NETBUFFERPOOL_CLASS_BYTES);
+
+    /** Make buf an empty buffer with room for nSize bytes, reusing a free one if possible. */
+    void Get(CSerializeData& buf, size_t nSize);
+    void Get(std::vector<unsigned char>& buf, size_t nSize);
+    /** Keep buf's storage for reuse if there is room, and leave buf empty. */
+    void Put(CSerializeData& buf);
+    void Put(std::vector<unsigned char>& buf);
+
+    Stats GetStats() const;
+
+private:
+    template <typename V>
+    using FreeLists = std::array<std::vector<V>, NUM_CLASSES>;
+
+    template <typename V>
+    void GetBuffer(FreeLists<V>& lists, V& buf, size_t nSize);
+    template <typename V>
+    void PutBuffer(FreeLists<V>& lists, V& buf);
+
+    const size_t nClassBytes;
+
+    mutable std::mutex cs;
+    FreeLists<CSerializeData> freeRecv;
+    FreeLists<std::vector<unsigned char>> freeSend;
+    std::array<size_t, NUM_CLASSES> vClassFreeBytes;
+
+    std::atomic<uint64_t> nHits;
+    std::atomic<uint64_t> nMisses;
+    std::atomic<uint64_t> nRecycled;
+    std::atomic<uint64_t> nDropped;
+};
+
+#endif // BITCOIN_NETBUFFERPOOL_H
@@ -8,7 +8,15 @@
 #include "arith_uint256.h"
 #include "chain.h"
 #include "util.h"
+#include "auxpow/cache.h"
 #include "auxpow/check.h"
+#include "crypto/scrypt.h"
+#include "powcache.h"
+#include "sync.h"
+
+#include <deque>
+#include <map>
+#include <tuple>
 
 unsigned int CalculateNextWorkRequired_V1(const CBlockIndex* pindexLast, int64_t nFirstBlockTime, const Consensus::Params& params)
 {
@@ -166,6 +174,25 @@ unsigned int GetNextWorkRequired_V2(const CBlockIndex* pindexLast, const CBlockH
     return CalculateNextWorkRequired_V2(pindexLast, pindexFirst->GetBlockTime(), params);
 }
 
+/** Number of blocks KimotoGravityWell looks back at most: seven days of 60 second blocks. */
+static const uint64_t KGW_PAST_BLOCKS_MAX = 60 * 60 * 24 * 7 / 60;
+
+/**
+ * The event horizon only depends on how many blocks have been read, so it is
+ * computed once per block count instead of calling pow() on every step.
+ */
+static double KGWEventHorizonDeviation(uint64_t PastBlocksMass)
+{
+    static const std::vector<double> vDeviation = [] {
+        std::vector<double> v(KGW_PAST_BLOCKS_MAX + 1);
+        for (uint64_t i = 1; i <= KGW_PAST_BLOCKS_MAX; i++)
+            v[i] = 1 + (0.7084 * pow((double(i)/double(144)), -1.228));
+        return v;
+    }();
+    assert(PastBlocksMass >= 1 && PastBlocksMass <= KGW_PAST_BLOCKS_MAX);
+    return vDeviation[PastBlocksMass];
+}
+
 unsigned int KimotoGravityWell(const CBlockIndex* pindexLast, const Consensus::Params& params) {
 
     const CBlockIndex   *BlockLastSolved                 = pindexLast;
@@ -188,6 +215,7 @@ unsigned int KimotoGravityWell(const CBlockIndex* pindexLast, const Consensus::P
     int64_t              PastSecondsMax                  = TimeDaySeconds * 7;
     uint64_t             PastBlocksMin                   = PastSecondsMin / TargetBlockSpacing;
     uint64_t             PastBlocksMax                   = PastSecondsMax / TargetBlockSpacing;
+    static_assert(KGW_PAST_BLOCKS_MAX == 60 * 60 * 24 * 7 / TargetBlockSpacing, "KGW_PAST_BLOCKS_MAX must match PastBlocksMax");
     arith_uint256        nProofOfWorkLimit               = UintToArith256(params.powLimit);
     
     int64_t              TimeWarpFixHeight               = params.Fork3Height;
@@ -209,11 +237,12 @@ unsigned int KimotoGravityWell(const CBlockIndex* pindexLast, const Consensus::P
         if (i == 1) {
             PastDifficultyAverage.SetCompact(BlockReading->nBits);
         } else {
+            // DivideBy(i) gives the same quotient as "/ i" without a 256-bit long division
             BlockReadingDifficulty.SetCompact(BlockReading->nBits);
             if (BlockReadingDifficulty > PastDifficultyAveragePrev) {
-                PastDifficultyAverage = PastDifficultyAveragePrev + ((BlockReadingDifficulty - PastDifficultyAveragePrev) / i);
+                PastDifficultyAverage = PastDifficultyAveragePrev + arith_uint256(BlockReadingDifficulty - PastDifficultyAveragePrev).DivideBy(i);
             } else {
-                PastDifficultyAverage = PastDifficultyAveragePrev - ((PastDifficultyAveragePrev - BlockReadingDifficulty) / i);
+                PastDifficultyAverage = PastDifficultyAveragePrev - arith_uint256(PastDifficultyAveragePrev - BlockReadingDifficulty).DivideBy(i);
             }
         }
         PastDifficultyAveragePrev = PastDifficultyAverage;
@@ -234,11 +263,10 @@ unsigned int KimotoGravityWell(const CBlockIndex* pindexLast, const Consensus::P
         if (PastRateActualSeconds != 0 && PastRateTargetSeconds != 0) {
             PastRateAdjustmentRatio = double(PastRateTargetSeconds) / double(PastRateActualSeconds);
         }
-        EventHorizonDeviation                   = 1 + (0.7084 * pow((double(PastBlocksMass)/double(144)), -1.228));
-        EventHorizonDeviationFast               = EventHorizonDeviation;
-        EventHorizonDeviationSlow               = 1 / EventHorizonDeviation;
-
         if (PastBlocksMass >= PastBlocksMin) {
+            EventHorizonDeviation               = KGWEventHorizonDeviation(PastBlocksMass);
+            EventHorizonDeviationFast           = EventHorizonDeviation;
+            EventHorizonDeviationSlow           = 1 / EventHorizonDeviation;
             if ((PastRateAdjustmentRatio <= EventHorizonDeviationSlow) ||
                 (PastRateAdjustmentRatio >= EventHorizonDeviationFast)) {
                 assert(BlockReading);
@@ -270,12 +298,8 @@ unsigned int KimotoGravityWell(const CBlockIndex* pindexLast, const Consensus::P
     return bnNew.GetCompact();
 }
 
-unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params)
+static unsigned int ComputeNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params)
 {
-    // -regtest mode
-    if (params.fPowNoRetargeting)
-        return pindexLast->nBits;
-
     if (pindexLast->nHeight+1 >= params.Fork3Height || (params.fPowAllowMinDifficultyBlocks && pindexLast->nHeight+1 >= 300000)) {
         //return AntiGravityWave(2, pindexLast, pblock, params);
         return KimotoGravityWell(pindexLast, params);
@@ -292,6 +316,103 @@ unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHead
     }
 }
 
+/** Whether the work required after pindexLast depends on the new block's time (testnet minimum difficulty blocks) */
+static bool NextWorkDependsOnTime(const CBlockIndex* pindexLast, const Consensus::Params& params)
+{
+    // Mirrors the switch in ComputeNextWorkRequired; KGW ignores the new block
+    const int nHeight = pindexLast->nHeight + 1;
+    return params.fPowAllowMinDifficultyBlocks && nHeight < params.Fork2Height && nHeight < params.Fork3Height && nHeight < 300000;
+}
+
+namespace {
+/**
+ * Results of ComputeNextWorkRequired, which template creation (for every pool
+ * frontend), getauxblock and header checks all ask for the same tip. Entries are
+ * keyed by block hash, which fixes every ancestor the retarget looks at, so they
+ * never go stale when the chain reorganizes; the oldest are just dropped.
+ */
+class CNextWorkCache
+{
+private:
+    struct Key
+    {
+        const Consensus::Params* params;
+        uint256 hashPrev;
+        int64_t nTime; //!< Block time, or 0 when the result does not depend on it
+
+        bool operator<(const Key& other) const
+        {
+            return std::tie(params, hashPrev, nTime) < std::tie(other.params, other.hashPrev, other.nTime);
+        }
+    };
+
+    CCriticalSection cs;
+    std::map<Key, unsigned int> mapBits;
+    std::deque<Key> queueKeys; //!< Insertion order, for eviction
+    uint64_t nHits = 0;
+    uint64_t nMisses = 0;
+
+public:
+    static const size_t MAX_ENTRIES = 64;
+
+    unsigned int Get(const CBlockIndex* pindexLast, const CBlockHeader* pblock, const Consensus::Params& params)
+    {
+        const Key key{&params, pindexLast->GetBlockHash(), NextWorkDependsOnTime(pindexLast, params) ? pblock->GetBlockTime() : 0};
+        {
+            LOCK(cs);
+            auto it = mapBits.find(key);
+            if (it != mapBits.end()) {
+                nHits++;
+                return it->second;
+            }
+            nMisses++;
+        }
+
+        // Computed without the lock held; racing callers store the same answer
+        const unsigned int nBits = ComputeNextWorkRequired(pindexLast, pblock, params);
+        LOCK(cs);
+        if (mapBits.emplace(key, nBits).second) {
+            queueKeys.push_back(key);
+            if (queueKeys.size() > MAX_ENTRIES) {
+                mapBits.erase(queueKeys.front());
+                queueKeys.pop_front();
+            }
+        }
+        return nBits;
+    }
+
+    NextWorkCacheStats GetStats()
+    {
+        LOCK(cs);
+        NextWorkCacheStats stats;
+        stats.entries = mapBits.size();
+        stats.hits = nHits;
+        stats.misses = nMisses;
+        return stats;
+    }
+};
+
+static CNextWorkCache nextWorkCache;
+} // namespace
+
+unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params& params)
+{
+    // -regtest mode
+    if (params.fPowNoRetargeting)
+        return pindexLast->nBits;
+
+    // Index entries not in mapBlockIndex (benchmarks, tests) have no hash to key on
+    if (!pindexLast->phashBlock)
+        return ComputeNextWorkRequired(pindexLast, pblock, params);
+
+    return nextWorkCache.Get(pindexLast, pblock, params);
+}
+
+NextWorkCacheStats GetNextWorkCacheStats()
+{
+    return nextWorkCache.GetStats();
+}
+
 bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params& params)
 {
     bool fNegative;
@@ -309,27 +430,90 @@ bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&
 
 }
 
-bool CheckBlockProofOfWork(const CBlockHeader *pblock, const Consensus::Params& params)
+bool CheckBlockProofOfWork(const CBlockHeader *pblock, const Consensus::Params& params, uint256* phashPoW)
 {
     // LogPrint("txdb", "CheckBlockProofOfWork(): block: %s\n", pblock->ToString());  // LEDTMP
 
+    // A cache hit cannot hand back the scrypt hash, so only callers that do not
+    // ask for it are served from the caches. All successful checks fill them, so
+    // a block whose header came first is served when the block itself arrives.
+    const uint256 hash = pblock->GetHash();
     if (pblock->auxpow && (pblock->auxpow.get() != nullptr))
     {
-        if (!CheckAuxpow(pblock->auxpow, pblock->GetHash(), pblock->GetChainID(), params))
+        const uint256 entry = AuxpowCacheEntry(hash, *pblock->auxpow);
+        if (!phashPoW && AuxpowCacheContains(entry))
+            return true;
+        if (!CheckAuxpow(pblock->auxpow, hash, pblock->GetChainID(), params))
             return error("CheckBlockProofOfWork() : AUX POW is not valid");
         // Check proof of work matches claimed amount
-        if (!CheckProofOfWork(pblock->auxpow->GetParentBlockHash(), pblock->nBits, params))
+        const uint256 hashPoW = pblock->auxpow->GetParentBlockHash();
+        if (!CheckProofOfWork(hashPoW, pblock->nBits, params))
             return error("CheckBlockProofOfWork() : AUX proof of work failed");
+        if (phashPoW)
+            *phashPoW = hashPoW;
+        AuxpowCacheInsert(entry);
     }
     else
     {
+        const uint256 entry = PoWCacheEntry(hash, params.powLimit);
+        if (!phashPoW && PoWCacheContains(entry))
+            return true;
         // Check proof of work matches claimed amount
-        if (!CheckProofOfWork(pblock->GetPoWHash(), pblock->nBits, params))
+        const uint256 hashPoW = pblock->GetPoWHash();
+        if (!CheckProofOfWork(hashPoW, pblock->nBits, params))
             return error("CheckBlockProofOfWork() : proof of work failed");
+        if (phashPoW)
+            *phashPoW = hashPoW;
+        PoWCacheInsert(entry);
     }
     return true;
 }
 
+void CheckBlockHeadersProofOfWork(const std::vector<const CBlockHeader*>& vpblock, std::vector<bool>& vPoWChecked, std::vector<uint256>& vHashPoW, const Consensus::Params& params)
+{
+    const size_t nLanes = scrypt_multi_lanes();
+    std::vector<size_t> vIndex;
+    std::vector<const char*> vInput;
+    std::vector<uint256> vHash(nLanes);
+    std::vector<char*> vOutput;
+    for (uint256& hash : vHash)
+        vOutput.push_back(BEGIN(hash));
+
+    vPoWChecked.assign(vpblock.size(), false);
+    vHashPoW.assign(vpblock.size(), uint256());
+    for (size_t i = 0; i < vpblock.size(); ) {
+        vIndex.clear();
+        vInput.clear();
+        bool fFailed = false;
+        for (; i < vpblock.size() && vIndex.size() < nLanes; i++) {
+            // Merge-mined headers are checked against their parent block by CheckBlockProofOfWork
+            if (vpblock[i]->auxpow) {
+                uint256 hashPoW;
+                if (CheckBlockProofOfWork(vpblock[i], params, &hashPoW)) {
+                    vPoWChecked[i] = true;
+                    vHashPoW[i] = hashPoW;
+                } else {
+                    fFailed = true;
+                }
+                continue;
+            }
+            vIndex.push_back(i);
+            vInput.push_back(BEGIN(vpblock[i]->nVersion));
+        }
+        scrypt_1024_1_1_256_multi(vInput.data(), vOutput.data(), vInput.size());
+        for (size_t j = 0; j < vIndex.size(); j++) {
+            if (CheckProofOfWork(vHash[j], vpblock[vIndex[j]]->nBits, params)) {
+                vPoWChecked[vIndex[j]] = true;
+                vHashPoW[vIndex[j]] = vHash[j];
+                PoWCacheInsert(PoWCacheEntry(vpblock[vIndex[j]]->GetHash(), params.powLimit));
+            } else
+                fFailed = true;
+        }
+        if (fFailed)
+            return;
+    }
+}
+
 bool CheckAuxPowValidity(const CBlockHeader* pblock, const Consensus::Params& params)
 {
     if (!params.fPowAllowMinDifficultyBlocks)
@@ -9,19 +9,47 @@
 #include "consensus/params.h"
 
 #include <stdint.h>
+#include <vector>
 
 class CBlockHeader;
 class CBlockIndex;
 class uint256;
 
+/**
+ * nBits a child of pindexLast must have. Answers for block index entries are
+ * remembered for the last few (pindexLast, block time) pairs, with the block time
+ * only part of the key where the testnet minimum difficulty rule looks at it.
+ */
 unsigned int GetNextWorkRequired(const CBlockIndex* pindexLast, const CBlockHeader *pblock, const Consensus::Params&);
 unsigned int CalculateNextWorkRequired(const CBlockIndex* pindexLast, int64_t nFirstBlockTime, const Consensus::Params&);
 
 /** Check whether a block hash satisfies the proof-of-work requirement specified by nBits */
 bool CheckProofOfWork(uint256 hash, unsigned int nBits, const Consensus::Params&);
-bool CheckBlockProofOfWork(const CBlockHeader *pblock, const Consensus::Params&);
+/**
+ * Check the proof of work of a block header (its own scrypt hash, or that of the
+ * parent block for merge-mined blocks). On success the checked hash is stored in
+ * *phashPoW if given. Without phashPoW, headers that passed before are answered
+ * from the proof-of-work and auxpow caches.
+ */
+bool CheckBlockProofOfWork(const CBlockHeader *pblock, const Consensus::Params&, uint256* phashPoW = nullptr);
+/**
+ * Check the proof of work of several headers, hashing the non-merge-mined ones with the
+ * multi-buffer scrypt kernel. vPoWChecked[i] is set for headers that passed, and vHashPoW[i]
+ * then holds their PoW hash as returned by CheckBlockProofOfWork. Checking stops at the
+ * first batch containing a failure.
+ */
+void CheckBlockHeadersProofOfWork(const std::vector<const CBlockHeader*>& vpblock, std::vector<bool>& vPoWChecked, std::vector<uint256>& vHashPoW, const Consensus::Params&);
 
 bool CheckAuxPowValidity(const CBlockHeader *pblock, const Consensus::Params&);
 
+struct NextWorkCacheStats
+{
+    uint64_t entries;
+    uint64_t hits;   //!< GetNextWorkRequired calls answered from the cache
+    uint64_t misses; //!< GetNextWorkRequired calls that ran the retarget
+};
+
+NextWorkCacheStats GetNextWorkCacheStats();
+
 
 #endif // BITCOIN_POW_H
@@ -0,0 +1,36 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "powcache.h"
+
+#include "saltedcache.h"
+
+namespace {
+/**
+ * Valid header proof-of-work cache, shared by header sync (including the header
+ * check threads) and CheckBlock for compact and full blocks. Entries are
+ * SHA256d(nonce || block hash || powLimit).
+ */
+CSaltedCache<uint256, uint256> powCache;
+} // namespace
+
+void InitPoWCache()
+{
+    powCache.Init("-maxpowcachesize", DEFAULT_MAX_POW_CACHE_SIZE, MAX_MAX_POW_CACHE_SIZE, "proof-of-work cache");
+}
+
+uint256 PoWCacheEntry(const uint256& hashBlock, const uint256& powLimit)
+{
+    return powCache.Entry(hashBlock, powLimit);
+}
+
+bool PoWCacheContains(const uint256& entry)
+{
+    return powCache.Contains(entry, false);
+}
+
+void PoWCacheInsert(const uint256& entry)
+{
+    powCache.Insert(entry);
+}
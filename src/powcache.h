@@ -0,0 +1,31 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_POWCACHE_H
+#define BITCOIN_POWCACHE_H
+
+#include "uint256.h"
+
+#include <stdint.h>
+
+// Each entry is a 32 byte hash, so the default holds about 32000 headers.
+static const unsigned int DEFAULT_MAX_POW_CACHE_SIZE = 1;
+// Maximum proof-of-work cache size allowed
+static const int64_t MAX_MAX_POW_CACHE_SIZE = 1024;
+
+/**
+ * Cache of block headers (not merge-mined ones, see auxpow/cache.h) whose own
+ * scrypt hash passed CheckBlockProofOfWork, so the same header arriving again,
+ * from another peer or with its block after the headers, skips scrypt.
+ *
+ * Entries are SHA256d(nonce || block hash || powLimit). The block hash covers
+ * all 80 bytes scrypt reads, nBits included.
+ */
+uint256 PoWCacheEntry(const uint256& hashBlock, const uint256& powLimit);
+bool PoWCacheContains(const uint256& entry);
+void PoWCacheInsert(const uint256& entry);
+
+void InitPoWCache();
+
+#endif // BITCOIN_POWCACHE_H
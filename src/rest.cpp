@@ -3,6 +3,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "auxpow/store.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "core_io.h"
@@ -156,6 +157,7 @@ static bool rest_headers(HTTPRequest* req,
                 break;
             pindex = chainActive.Next(pindex);
         }
+        PrefetchAuxPow(headers);
     }
 
     CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
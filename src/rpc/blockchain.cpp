@@ -973,6 +973,55 @@ UniValue gettxoutsetinfo(const JSONRPCRequest& request)
     return ret;
 }
 
+UniValue getsupplyinfo(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 1)
+        throw std::runtime_error(
+            "getsupplyinfo ( height )\n"
+            "\nReturns the coins issued up to and including the block at the given height of the main chain.\n"
+            "Requires -supplyindex.\n"
+            "\nArguments:\n"
+            "1. height         (numeric, optional) The block height, defaults to the current tip\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"height\": n,            (numeric) The block height\n"
+            "  \"blockhash\": \"hash\",   (string) The block hash\n"
+            "  \"subsidy\": x.xxx,       (numeric) Total block rewards allowed up to this block\n"
+            "  \"fees\": x.xxx,          (numeric) Total transaction fees paid\n"
+            "  \"unclaimed\": x.xxx,     (numeric) Total subsidy and fees not claimed by coinbase transactions\n"
+            "  \"burned\": x.xxx,        (numeric) Total value sent to provably unspendable outputs\n"
+            "  \"supply\": x.xxx         (numeric) Coins in circulation: subsidy - unclaimed - burned\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getsupplyinfo", "1000")
+            + HelpExampleRpc("getsupplyinfo", "1000")
+        );
+
+    LOCK(cs_main);
+
+    if (!psupplyindex)
+        throw JSONRPCError(RPC_MISC_ERROR, "Supply index is not enabled. Use -supplyindex to enable it.");
+
+    int nHeight = request.params[0].isNull() ? chainActive.Height() : request.params[0].get_int();
+    if (nHeight < 0 || nHeight > chainActive.Height())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Block height out of range");
+    const uint256 hashBlock = chainActive[nHeight]->GetBlockHash();
+
+    CSupplyInfo info;
+    if (!psupplyindex->ReadSupplyInfo(hashBlock, info))
+        throw JSONRPCError(RPC_MISC_ERROR, "Supply index has not reached this block yet");
+
+    UniValue ret(UniValue::VOBJ);
+    ret.push_back(Pair("height", nHeight));
+    ret.push_back(Pair("blockhash", hashBlock.GetHex()));
+    ret.push_back(Pair("subsidy", ValueFromAmount(info.nSubsidy)));
+    ret.push_back(Pair("fees", ValueFromAmount(info.nFees)));
+    ret.push_back(Pair("unclaimed", ValueFromAmount(info.nUnclaimed)));
+    ret.push_back(Pair("burned", ValueFromAmount(info.nBurned)));
+    ret.push_back(Pair("supply", ValueFromAmount(info.GetSupply())));
+    return ret;
+}
+
 UniValue gettxout(const JSONRPCRequest& request)
 {
     if (request.fHelp || request.params.size() < 2 || request.params.size() > 3)
@@ -1601,6 +1650,7 @@ static const CRPCCommand commands[] =
     { "blockchain",         "getmempoolinfo",         &getmempoolinfo,         true,  {} },
     { "blockchain",         "getrawmempool",          &getrawmempool,          true,  {"verbose"} },
     { "blockchain",         "gettxout",               &gettxout,               true,  {"txid","n","include_mempool"} },
+    { "blockchain",         "getsupplyinfo",          &getsupplyinfo,          true,  {"height"} },
     { "blockchain",         "gettxoutsetinfo",        &gettxoutsetinfo,        true,  {} },
     { "blockchain",         "pruneblockchain",        &pruneblockchain,        true,  {"height"} },
     { "blockchain",         "verifychain",            &verifychain,            true,  {"checklevel","nblocks"} },
@@ -5,12 +5,16 @@
 
 #include "base58.h"
 #include "amount.h"
+#include "arith_uint256.h"
+#include "auxpow/blockcache.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "consensus/consensus.h"
 #include "consensus/params.h"
 #include "consensus/validation.h"
 #include "core_io.h"
+#include "crypto/common.h"
+#include "crypto/scrypt.h"
 #include "init.h"
 #include "validation.h"
 #include "miner.h"
@@ -26,8 +30,14 @@
 #include "validationinterface.h"
 #include "warnings.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <stdint.h>
+#include <thread>
 
 #include <univalue.h>
 
@@ -105,6 +115,137 @@ UniValue getnetworkhashps(const JSONRPCRequest& request)
     return GetNetworkHashPS(!request.params[0].isNull() ? request.params[0].get_int() : 120, !request.params[1].isNull() ? request.params[1].get_int() : -1);
 }
 
+/**
+ * Try nonces from pblock->nNonce up to nNonceEnd, hashing scrypt_multi_lanes() of them per
+ * pass, and leave pblock->nNonce at the first one that meets the target. Every nonce tried
+ * without success is deducted from nMaxTries. Gives up between passes once *pfStop is set.
+ */
+static bool ScanNonces(CBlockHeader* pblock, uint32_t nNonceEnd, uint64_t& nMaxTries, const std::atomic<bool>* pfStop = nullptr)
+{
+    // When a nonce is expected to succeed within one pass (regtest), most of a
+    // full pass would be spent on nonces after the winning one.
+    arith_uint256 bnTarget;
+    bnTarget.SetCompact(pblock->nBits);
+    const size_t nLanes = bnTarget > ~arith_uint256() / scrypt_multi_lanes() ? 1 : scrypt_multi_lanes();
+    std::vector<std::vector<char>> vHeader(nLanes, std::vector<char>(80));
+    std::vector<uint256> vHash(nLanes);
+    std::vector<const char*> vInput;
+    std::vector<char*> vOutput;
+    for (size_t i = 0; i < nLanes; i++) {
+        memcpy(vHeader[i].data(), BEGIN(pblock->nVersion), 80);
+        vInput.push_back(vHeader[i].data());
+        vOutput.push_back(BEGIN(vHash[i]));
+    }
+    // Only the nonce changes, and it is past the first 64 bytes
+    ScryptMidstate midstate;
+    scrypt_header_midstate(vHeader[0].data(), &midstate);
+    while (nMaxTries > 0 && pblock->nNonce < nNonceEnd && !(pfStop && *pfStop)) {
+        size_t nCount = std::min<uint64_t>(std::min<uint64_t>(nLanes, nMaxTries), nNonceEnd - pblock->nNonce);
+        for (size_t i = 0; i < nCount; i++)
+            WriteLE32((unsigned char*)&vHeader[i][76], pblock->nNonce + i);
+        scrypt_1024_1_1_256_multi(vInput.data(), vOutput.data(), nCount, &midstate);
+        for (size_t i = 0; i < nCount; i++) {
+            if (CheckProofOfWork(vHash[i], pblock->nBits, Params().GetConsensus())) {
+                pblock->nNonce += i;
+                nMaxTries -= i;
+                return true;
+            }
+        }
+        pblock->nNonce += nCount;
+        nMaxTries -= nCount;
+    }
+    return false;
+}
+
+/** Nonces a miner thread claims at a time */
+static const uint64_t MINER_NONCE_CHUNK = 0x400;
+
+/** Nonce range and tries budget shared by the threads of one ScanNoncesParallel call */
+struct NonceSearch
+{
+    std::atomic<uint64_t> nNext;      //!< First nonce no thread has claimed yet
+    std::atomic<uint64_t> nTriesLeft; //!< Tries not handed out to a thread yet, or given back
+    std::atomic<int> nRunning;        //!< Threads still searching
+    std::atomic<bool> fStop;
+    std::atomic<bool> fFound;
+    uint32_t nNonce;                  //!< Winning nonce, written once by whoever sets fFound
+    std::mutex cs;                    //!< Held to signal cond
+    std::condition_variable cond;     //!< Signalled when a thread finds the nonce or runs out of tries
+
+    NonceSearch(uint64_t nMaxTries, int nThreads) : nNext(0), nTriesLeft(nMaxTries), nRunning(nThreads), fStop(false), fFound(false), nNonce(0) {}
+};
+
+static void ScanNoncesThread(CBlockHeader header, NonceSearch& search)
+{
+    RenameThread("sexcoin-miner");
+    while (!search.fStop) {
+        // Take the tries before the nonces, so the threads together never try more than nMaxTries
+        uint64_t nTries = search.nTriesLeft;
+        while (nTries > 0 && !search.nTriesLeft.compare_exchange_weak(nTries, nTries - std::min(nTries, MINER_NONCE_CHUNK)));
+        nTries = std::min(nTries, MINER_NONCE_CHUNK);
+        if (nTries == 0)
+            break;
+        const uint64_t nStart = search.nNext.fetch_add(nTries);
+        const uint64_t nEnd = std::max(nStart, std::min<uint64_t>(nStart + nTries, std::numeric_limits<uint32_t>::max()));
+        uint64_t nChunkTries = nEnd - nStart;
+        search.nTriesLeft += nTries - nChunkTries;
+        if (nChunkTries == 0)
+            break;
+
+        header.nNonce = nStart;
+        bool fFound = ScanNonces(&header, nEnd, nChunkTries, &search.fStop);
+        search.nTriesLeft += nChunkTries;
+        if (fFound) {
+            bool fFirst = false;
+            if (search.fFound.compare_exchange_strong(fFirst, true))
+                search.nNonce = header.nNonce;
+            search.fStop = true;
+            break;
+        }
+    }
+    if (--search.nRunning == 0 || search.fStop) {
+        // Wake up the thread waiting in ScanNoncesParallel
+        { std::lock_guard<std::mutex> lock(search.cs); }
+        search.cond.notify_all();
+    }
+}
+
+bool ScanNoncesParallel(CBlockHeader* pblock, int nThreads, uint64_t& nMaxTries)
+{
+    NonceSearch search(nMaxTries, nThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < nThreads; i++)
+        threads.emplace_back(ScanNoncesThread, *pblock, std::ref(search));
+
+    // The tip and shutdown are polled, a thread that is done signals right away
+    while (!search.fStop && search.nRunning > 0 && IsRPCRunning() && !ShutdownRequested()) {
+        {
+            LOCK(cs_main);
+            if (chainActive.Tip()->GetBlockHash() != pblock->hashPrevBlock)
+                break;
+        }
+        std::unique_lock<std::mutex> lock(search.cs);
+        search.cond.wait_for(lock, std::chrono::milliseconds(250), [&search] { return search.fStop || search.nRunning == 0; });
+    }
+    search.fStop = true;
+    for (std::thread& thread : threads)
+        thread.join();
+
+    nMaxTries = search.nTriesLeft;
+    if (search.fFound)
+        pblock->nNonce = search.nNonce;
+    return search.fFound;
+}
+
+/** Number of threads to generate with, from -genproclimit */
+static int GetGenerateThreads()
+{
+    int nThreads = gArgs.GetArg("-genproclimit", DEFAULT_GENERATE_THREADS);
+    if (nThreads < 0)
+        nThreads = GetNumCores();
+    return std::max(nThreads, 1);
+}
+
 UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGenerate, uint64_t nMaxTries, bool keepScript)
 {
     static const int nInnerLoopCount = 0x10000;
@@ -116,10 +257,14 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGen
         nHeight = chainActive.Height();
         nHeightEnd = nHeight+nGenerate;
     }
+    const int nThreads = GetGenerateThreads();
     unsigned int nExtraNonce = 0;
     UniValue blockHashes(UniValue::VARR);
     while (nHeight < nHeightEnd)
     {
+        // A search cut short by shutdown leaves nMaxTries as it was
+        if (!IsRPCRunning() || ShutdownRequested())
+            throw JSONRPCError(RPC_CLIENT_NOT_CONNECTED, "Shutting down");
         std::unique_ptr<CBlockTemplate> pblocktemplate(BlockAssembler(Params()).CreateNewBlock(coinbaseScript->reserveScript));
         if (!pblocktemplate.get())
             throw JSONRPCError(RPC_INTERNAL_ERROR, "Couldn't create new block");
@@ -128,14 +273,19 @@ UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGen
             LOCK(cs_main);
             IncrementExtraNonce(pblock, chainActive.Tip(), nExtraNonce);
         }
-        while (nMaxTries > 0 && pblock->nNonce < nInnerLoopCount && !CheckProofOfWork(pblock->GetPoWHash(), pblock->nBits, Params().GetConsensus())) {
-            ++pblock->nNonce;
-            --nMaxTries;
-        }
+        // Starting threads costs more than hashing when one pass of every
+        // thread is expected to find several blocks (regtest).
+        arith_uint256 bnTarget;
+        bnTarget.SetCompact(pblock->nBits);
+        bool fFound;
+        if (nThreads > 1 && bnTarget <= ~arith_uint256() / (scrypt_multi_lanes() * nThreads * 16))
+            fFound = ScanNoncesParallel(pblock, nThreads, nMaxTries);
+        else
+            fFound = ScanNonces(pblock, nInnerLoopCount, nMaxTries);
         if (nMaxTries == 0) {
             break;
         }
-        if (pblock->nNonce == nInnerLoopCount) {
+        if (!fFound) {
             continue;
         }
         std::shared_ptr<const CBlock> shared_pblock = std::make_shared<const CBlock>(*pblock);
@@ -202,6 +352,11 @@ UniValue getmininginfo(const JSONRPCRequest& request)
             "  \"networkhashps\": nnn,      (numeric) The network hashes per second\n"
             "  \"pooledtx\": n              (numeric) The size of the mempool\n"
             "  \"chain\": \"xxxx\",           (string) current network name as defined in BIP70 (main, test, regtest)\n"
+            "  \"retargetcache\": {           (json object) Remembered difficulty retarget results\n"
+            "    \"entries\": n,              (numeric) Results currently held\n"
+            "    \"hits\": n,                 (numeric) Lookups answered without a retarget since startup\n"
+            "    \"misses\": n                (numeric) Lookups that ran the retarget since startup\n"
+            "  }\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getmininginfo", "")
@@ -220,6 +375,12 @@ UniValue getmininginfo(const JSONRPCRequest& request)
     obj.push_back(Pair("networkhashps",    getnetworkhashps(request)));
     obj.push_back(Pair("pooledtx",         (uint64_t)mempool.size()));
     obj.push_back(Pair("chain",            Params().NetworkIDString()));
+    NextWorkCacheStats retargetStats = GetNextWorkCacheStats();
+    UniValue retargetCache(UniValue::VOBJ);
+    retargetCache.push_back(Pair("entries", retargetStats.entries));
+    retargetCache.push_back(Pair("hits",    retargetStats.hits));
+    retargetCache.push_back(Pair("misses",  retargetStats.misses));
+    obj.push_back(Pair("retargetcache",    retargetCache));
     return obj;
 }
 
@@ -771,6 +932,8 @@ CKeyID GetAuxpowMiningKey()
     CKeyID result;
     CBitcoinAddress auxminingaddr(gArgs.GetArg("-auxminingaddr", ""));
     if (!auxminingaddr.GetKeyID(result)) {
+        if (vpwallets.empty())
+            throw std::runtime_error("No wallet to take an auxpow mining key from, and -auxminingaddr is not set");
         CReserveKey reservekey(vpwallets[0]);
         CPubKey pubkey;
         reservekey.GetReservedKey(pubkey);
@@ -779,109 +942,101 @@ CKeyID GetAuxpowMiningKey()
     return result;
 }
 
-UniValue getauxblock(const JSONRPCRequest& request)
+CScript GetAuxpowMiningScript()
 {
-    if (request.fHelp || (request.params.size() != 0 && request.params.size() != 2))
-        throw std::runtime_error(
-                "getauxblock <hash> <auxpow>\n"
-                        " create a new block\n"
-                        "If <hash>, <auxpow> is not specified, returns a new block hash.\n"
-                        "If <hash>, <auxpow> is specified, tries to solve the block based on\n"
-                        "the aux proof of work and returns true if it was successful."
-                + HelpExampleCli("getauxblock", "\"myhash\" \"auxpow\"")
-                + HelpExampleRpc("getauxblock", "\"myhash\" \"auxpow\"")
-        );
+    static const CKeyID keyID = GetAuxpowMiningKey();
+    return GetScriptForDestination(keyID);
+}
 
+static void AuxMiningCheck()
+{
     if (g_connman->GetNodeCount(CConnman::CONNECTIONS_ALL) == 0)
         throw JSONRPCError(-9, "Sexcoin is not connected!");
 
     if (IsInitialBlockDownload())
         throw JSONRPCError(-10, "Sexcoin is downloading blocks...");
+}
 
-    static std::map<uint256, CBlock*> mapNewBlock;
-    static std::vector< std::unique_ptr<CBlockTemplate> > vNewBlockTemplate;
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-
-    LOCK(cs_main);
+/**
+ * Wait until the tip is no longer the block named by a longpollid, like
+ * getblocktemplate long polls do, and return the new tip.
+ */
+static uint256 AuxMiningWaitForTip(const std::string& strLongPollId)
+{
+    uint256 hashWatchedChain;
+    hashWatchedChain.SetHex(strLongPollId);
 
-    if (request.params.size() == 0)
+    uint256 hashTip;
     {
-        // Update block
-        static unsigned int nTransactionsUpdatedLast;
-        static CBlockIndex* pindexPrev;
-        static uint64_t nStart;
-        static CBlock* pblock;
-        static std::unique_ptr<CBlockTemplate> pblocktemplate;
-
-        if (chainActive.Tip()->nHeight < consensusParams.nAuxPowStartHeight - 1)
-            throw JSONRPCError(-1, "Merged mining not enabled at current block height yet");
-        if (pindexPrev != chainActive.Tip() ||
-            (mempool.GetTransactionsUpdated() != nTransactionsUpdatedLast && GetTime() - nStart > 20))
-        {
-            if (pindexPrev != chainActive.Tip())
-            {
-                // Deallocate old blocks since they're obsolete now
-                mapNewBlock.clear();
-                for (auto&& pnblocktemplate : vNewBlockTemplate)
-                    pnblocktemplate = nullptr;
-                vNewBlockTemplate.clear();
-            }
-            nTransactionsUpdatedLast = mempool.GetTransactionsUpdated();
-            pindexPrev = chainActive.Tip();
-            nStart = static_cast<uint64_t>(GetTime());
-
-            static const CKeyID keyID = GetAuxpowMiningKey();
+        boost::system_time checktxtime = boost::get_system_time() + boost::posix_time::minutes(1);
 
-            // Create new block with nonce = 0 and extraNonce = 1
-            CScript scriptCoinbase = GetScriptForDestination(keyID);
-            pblocktemplate = BlockAssembler(Params()).CreateNewBlock(scriptCoinbase);
-            if (!pblocktemplate)
-                throw JSONRPCError(-7, "Out of memory");
+        boost::unique_lock<boost::mutex> lock(csBestBlock);
+        while ((hashTip = chainActive.Tip()->GetBlockHash()) == hashWatchedChain && IsRPCRunning())
+        {
+            // Wake up now and then to notice shutdown
+            if (!cvBlockChange.timed_wait(lock, checktxtime))
+                checktxtime += boost::posix_time::minutes(1);
+        }
+    }
 
-            pblock = &pblocktemplate->block;
-            // Update nTime
-            pblock->nTime = (uint32_t) std::max(pindexPrev->GetMedianTimePast() + 1, GetAdjustedTime());
-            pblock->nNonce = 0;
+    if (!IsRPCRunning())
+        throw JSONRPCError(RPC_CLIENT_NOT_CONNECTED, "Shutting down");
+    return hashTip;
+}
 
-            // Update nExtraNonce
-            static unsigned int nExtraNonce = 0;
-            IncrementExtraNonce(pblock, pindexPrev, nExtraNonce);
+static UniValue AuxMiningCreateBlock(const CScript& scriptPayout, const UniValue& lpval)
+{
+    AuxMiningCheck();
+
+    // The cache only learns about the new tip from UpdatedBlockTip, which may not
+    // have run yet when a long poll wakes up
+    uint256 hashPrevBlock;
+    if (lpval.isStr())
+        hashPrevBlock = AuxMiningWaitForTip(lpval.get_str());
+
+    int nHeight;
+    std::shared_ptr<const CBlock> pblock = auxBlockCache.Create(scriptPayout, nHeight, hashPrevBlock);
+    if (!pblock)
+        throw JSONRPCError(-7, "Out of memory");
+    if (nHeight < Params().GetConsensus().nAuxPowStartHeight)
+        throw JSONRPCError(-1, "Merged mining not enabled at current block height yet");
+
+    bool fNegative, fOverflow;
+    arith_uint256 hashTarget = arith_uint256().SetCompact(pblock->nBits, &fNegative, &fOverflow);
+    if (hashTarget == 0 || fNegative || fOverflow)
+        throw std::runtime_error("block has invalid difficulty bits");
 
-            // Sets the version
-            pblock->SetAuxPow(new CAuxPow());
+    UniValue result(UniValue::VOBJ);
+    result.push_back(Pair("target", HexStr(BEGIN(hashTarget), END(hashTarget))));
+    result.push_back(Pair("hash", pblock->GetHash().GetHex()));
+    result.push_back(Pair("chainid", pblock->GetChainID()));
+    result.push_back(Pair("previousblockhash", pblock->hashPrevBlock.GetHex()));
+    result.push_back(Pair("coinbasevalue", (int64_t)pblock->vtx[0]->GetValueOut()));
+    result.push_back(Pair("bits", strprintf("%08x", pblock->nBits)));
+    result.push_back(Pair("height", nHeight));
+    result.push_back(Pair("longpollid", pblock->hashPrevBlock.GetHex()));
+    return result;
+}
 
-            // Save
-            mapNewBlock[pblock->GetHash()] = pblock;
+static UniValue AuxMiningSubmitBlock(const std::string& strHash, const std::string& strAuxPow)
+{
+    AuxMiningCheck();
 
-            vNewBlockTemplate.push_back(std::move(pblocktemplate));
-        }
+    uint256 hash;
+    hash.SetHex(strHash);
+    std::vector<unsigned char> vchAuxPow = ParseHex(strAuxPow);
+    CDataStream ss(vchAuxPow, SER_GETHASH, PROTOCOL_VERSION);
+    std::unique_ptr<CAuxPow> pow(new CAuxPow());
+    ss >> *pow;
 
-        bool fNegative, fOverflow;
-        arith_uint256 hashTarget = arith_uint256().SetCompact(pblock->nBits, &fNegative, &fOverflow);
-        if (hashTarget == 0 || fNegative || fOverflow)
-            throw std::runtime_error("block has invalid difficulty bits");
+    std::shared_ptr<CBlock> pblock = auxBlockCache.Lookup(hash);
+    if (!pblock)
+        return "stale-work";
+    pblock->SetAuxPow(pow.release());
 
-        UniValue result(UniValue::VOBJ);
-        result.push_back(Pair("target", HexStr(BEGIN(hashTarget), END(hashTarget))));
-        result.push_back(Pair("hash", pblock->GetHash().GetHex()));
-        result.push_back(Pair("chainid", pblock->GetChainID()));
-        return result;
-    }
-    else
+    bool fBlockPresent = false;
     {
-        uint256 hash;
-        hash.SetHex(request.params[0].get_str());
-        std::vector<unsigned char> vchAuxPow = ParseHex(request.params[1].get_str());
-        CDataStream ss(vchAuxPow, SER_GETHASH, PROTOCOL_VERSION);
-        auto* pow = new CAuxPow();
-        ss >> *pow;
-        if (!mapNewBlock.count(hash))
-            return "stale-work";
-
-        CBlock* pblock = mapNewBlock[hash];
-        pblock->SetAuxPow(pow);
-
-        bool fBlockPresent = false;
+        LOCK(cs_main);
         BlockMap::iterator mi = mapBlockIndex.find(hash);
         if (mi != mapBlockIndex.end()) {
             CBlockIndex *pindex = mi->second;
@@ -891,23 +1046,118 @@ UniValue getauxblock(const JSONRPCRequest& request)
                 return "duplicate-invalid";
             fBlockPresent = true;
         }
+    }
 
-        submitblock_StateCatcher sc(pblock->GetHash());
-        RegisterValidationInterface(&sc);
-        auto spblock = std::make_shared<CBlock>(*pblock);
-        bool fAccepted = ProcessNewBlock(Params(), spblock, true, nullptr);
-        UnregisterValidationInterface(&sc);
-        if (fBlockPresent) {
-            if (fAccepted && !sc.found) {
-                return "duplicate-inconclusive";
-            }
-            return "duplicate";
-        }
-        if (!sc.found) {
-            return "inconclusive";
+    submitblock_StateCatcher sc(hash);
+    RegisterValidationInterface(&sc);
+    bool fAccepted = ProcessNewBlock(Params(), pblock, true, nullptr);
+    UnregisterValidationInterface(&sc);
+    if (fBlockPresent) {
+        if (fAccepted && !sc.found) {
+            return "duplicate-inconclusive";
         }
-        return BIP22ValidationResult(sc.state);
+        return "duplicate";
+    }
+    if (!sc.found) {
+        return "inconclusive";
+    }
+    return BIP22ValidationResult(sc.state);
+}
+
+UniValue createauxblock(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() < 1 || request.params.size() > 2)
+        throw std::runtime_error(
+            "createauxblock \"address\" ( \"longpollid\" )\n"
+            "\nCreate a new block to merge-mine, paying to the given address.\n"
+            "Callers asking for the same address share one template, refreshed when the\n"
+            "tip changes or the mempool has changed for 20 seconds.\n"
+            "\nArguments:\n"
+            "1. \"address\"      (string, required) The address to pay the block reward to\n"
+            "2. \"longpollid\"   (string, optional) Wait until the tip is no longer this block, then return new work\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"hash\"               (string) hash of the block to mine\n"
+            "  \"chainid\"            (numeric) chain ID for the auxpow\n"
+            "  \"previousblockhash\"  (string) hash of the previous block\n"
+            "  \"coinbasevalue\"      (numeric) value of the block's coinbase\n"
+            "  \"bits\"               (string) compressed target of the block\n"
+            "  \"height\"             (numeric) height of the block\n"
+            "  \"target\"             (string) target in reversed byte order\n"
+            "  \"longpollid\"         (string) id to wait for the next block with\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("createauxblock", "\"myaddress\"")
+            + HelpExampleRpc("createauxblock", "\"myaddress\"")
+        );
+
+    CBitcoinAddress address(request.params[0].get_str());
+    if (!address.IsValid())
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Error: Invalid address");
+
+    return AuxMiningCreateBlock(GetScriptForDestination(address.Get()), request.params[1]);
+}
+
+UniValue submitauxblock(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() != 2)
+        throw std::runtime_error(
+            "submitauxblock \"hash\" \"auxpow\"\n"
+            "\nSubmit a solved auxpow for a block made by createauxblock.\n"
+            "\nArguments:\n"
+            "1. \"hash\"         (string, required) hash of the block to submit\n"
+            "2. \"auxpow\"       (string, required) serialised auxpow found\n"
+            "\nResult:\n"
+            "null if the block was accepted, otherwise the reason it was not, as for submitblock\n"
+            "\nExamples:\n"
+            + HelpExampleCli("submitauxblock", "\"hash\" \"serialised auxpow\"")
+            + HelpExampleRpc("submitauxblock", "\"hash\" \"serialised auxpow\"")
+        );
+
+    return AuxMiningSubmitBlock(request.params[0].get_str(), request.params[1].get_str());
+}
+
+UniValue getauxblock(const JSONRPCRequest& request)
+{
+    if (request.fHelp || request.params.size() > 3)
+        throw std::runtime_error(
+            "getauxblock ( \"hash\" \"auxpow\" | \"longpollid\" )\n"
+            "\nCreate a new block to merge-mine, paying to -auxminingaddr or a wallet key, or submit a solved one.\n"
+            "Without arguments, or with only a longpollid, returns a new block like createauxblock.\n"
+            "With a hash and an auxpow, submits the auxpow like submitauxblock.\n"
+            "\nArguments:\n"
+            "1. \"hash\"         (string, optional) Hash of the block to submit, or a longpollid when given alone\n"
+            "2. \"auxpow\"       (string, optional) Serialized auxpow found for the block\n"
+            "3. \"longpollid\"   (string, optional) Wait until the tip is no longer this block, then return new work\n"
+            "\nResult (without hash and auxpow):\n"
+            "{\n"
+            "  \"hash\"               (string) hash of the block to mine\n"
+            "  \"chainid\"            (numeric) chain ID for the auxpow\n"
+            "  \"previousblockhash\"  (string) hash of the previous block\n"
+            "  \"coinbasevalue\"      (numeric) value of the block's coinbase\n"
+            "  \"bits\"               (string) compressed target of the block\n"
+            "  \"height\"             (numeric) height of the block\n"
+            "  \"target\"             (string) target in reversed byte order\n"
+            "  \"longpollid\"         (string) id to wait for the next block with\n"
+            "}\n"
+            "\nResult (with hash and auxpow):\n"
+            "null if the block was accepted, otherwise the reason it was not, as for submitblock\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getauxblock", "")
+            + HelpExampleCli("getauxblock", "\"longpollid\"")
+            + HelpExampleCli("getauxblock", "\"myhash\" \"auxpow\"")
+            + HelpExampleRpc("getauxblock", "\"myhash\", \"auxpow\"")
+        );
+
+    if (!request.params[1].isNull()) {
+        if (request.params[0].isNull() || !request.params[2].isNull())
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Expected hash and auxpow, without longpollid");
+        return AuxMiningSubmitBlock(request.params[0].get_str(), request.params[1].get_str());
     }
+    if (!request.params[0].isNull() && !request.params[2].isNull())
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Expected hash and auxpow, or a longpollid");
+    // A longpollid passed by position takes the place of the hash
+    return AuxMiningCreateBlock(GetAuxpowMiningScript(), request.params[2].isNull() ? request.params[0] : request.params[2]);
 }
 
 
@@ -1117,7 +1367,9 @@ static const CRPCCommand commands[] =
     { "mining",             "prioritisetransaction",  &prioritisetransaction,  true,  {"txid","dummy","fee_delta"} },
     { "mining",             "getblocktemplate",       &getblocktemplate,       true,  {"template_request"} },
     { "mining",             "submitblock",            &submitblock,            true,  {"hexdata","dummy"} },
-    { "mining",             "getauxblock",            &getauxblock,            true,  {"hash","auxpow"} },
+    { "mining",             "getauxblock",            &getauxblock,            true,  {"hash","auxpow","longpollid"} },
+    { "mining",             "createauxblock",         &createauxblock,         true,  {"address","longpollid"} },
+    { "mining",             "submitauxblock",         &submitauxblock,         true,  {"hash","auxpow"} },
 
     { "generating",         "generatetoaddress",      &generatetoaddress,      true,  {"nblocks","address","maxtries"} },
 
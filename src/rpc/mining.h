@@ -7,11 +7,26 @@
 
 #include "script/script.h"
 
+#include <stdint.h>
+
 #include <univalue.h>
 
+class CBlockHeader;
+
 /** Generate blocks (mine) */
 UniValue generateBlocks(std::shared_ptr<CReserveScript> coinbaseScript, int nGenerate, uint64_t nMaxTries, bool keepScript);
 
+/**
+ * Search the nonces of pblock from 0 with nThreads threads, each claiming a chunk of
+ * nonces at a time, deducting every nonce tried from nMaxTries. Gives up as soon as
+ * the tip is no longer pblock->hashPrevBlock, as the block could not be connected
+ * anymore, or when RPC or the node shuts down.
+ */
+bool ScanNoncesParallel(CBlockHeader* pblock, int nThreads, uint64_t& nMaxTries);
+
+/** Payout script of getauxblock and the pubauxblock notifications */
+CScript GetAuxpowMiningScript();
+
 /** Check bounds on a command line confirm target */
 unsigned int ParseConfirmTarget(const UniValue& value);
 
@@ -3,10 +3,12 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "auxpow/store.h"
 #include "base58.h"
 #include "chain.h"
 #include "clientversion.h"
 #include "core_io.h"
+#include "crypto/scrypt.h"
 #include "init.h"
 #include "validation.h"
 #include "httpserver.h"
@@ -502,6 +504,41 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCScryptMemoryInfo()
+{
+    ScryptScratchpadStats stats = scrypt_scratchpad_stats();
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("threads", stats.threads));
+    obj.push_back(Pair("bytes", stats.bytes));
+    obj.push_back(Pair("hugepage_bytes", stats.hugepage_bytes));
+    obj.push_back(Pair("allocations", stats.allocations));
+    return obj;
+}
+
+static UniValue RPCAuxPowMemoryInfo()
+{
+    CAuxPowStore::Stats stats = auxpowStore.GetStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("entries", (uint64_t)stats.entries));
+    obj.push_back(Pair("bytes", (uint64_t)stats.bytes));
+    obj.push_back(Pair("max_bytes", (uint64_t)stats.max_bytes));
+    obj.push_back(Pair("hits", stats.hits));
+    obj.push_back(Pair("misses", stats.misses));
+    return obj;
+}
+
+static UniValue RPCBlockIndexMemoryInfo()
+{
+    LOCK(cs_main);
+    BlockIndexMemoryStats stats = GetBlockIndexMemoryStats();
+    UniValue obj(UniValue::VOBJ);
+    obj.push_back(Pair("entries", (uint64_t)stats.entries));
+    obj.push_back(Pair("entry_bytes", (uint64_t)stats.entry_bytes));
+    obj.push_back(Pair("map_bytes", (uint64_t)stats.map_bytes));
+    obj.push_back(Pair("bytes_per_entry", stats.entries ? (double)(stats.entry_bytes + stats.map_bytes) / stats.entries : 0.0));
+    return obj;
+}
+
 #ifdef HAVE_MALLOC_INFO
 static std::string RPCMallocInfo()
 {
@@ -543,6 +580,25 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"scrypt\": {               (json object) Information about per-thread scrypt scratchpads\n"
+            "    \"threads\": xx,          (numeric) Number of threads holding a scratchpad\n"
+            "    \"bytes\": xxxxx,         (numeric) Number of bytes held by all scratchpads\n"
+            "    \"hugepage_bytes\": xxxxx, (numeric) Part of bytes backed by transparent huge pages\n"
+            "    \"allocations\": xxxxx,   (numeric) Number of scratchpads allocated or grown since startup\n"
+            "  },\n"
+            "  \"auxpow\": {               (json object) Information about the in-memory store of merge-mined header auxpows\n"
+            "    \"entries\": xxxxx,       (numeric) Number of auxpows held\n"
+            "    \"bytes\": xxxxx,         (numeric) Estimated number of bytes used\n"
+            "    \"max_bytes\": xxxxx,     (numeric) Limit set by -auxpowcache\n"
+            "    \"hits\": xxxxx,          (numeric) Number of lookups served from memory\n"
+            "    \"misses\": xxxxx,        (numeric) Number of lookups that went to the block index database\n"
+            "  },\n"
+            "  \"blockindex\": {           (json object) Information about the in-memory block index\n"
+            "    \"entries\": xxxxx,       (numeric) Number of block index entries\n"
+            "    \"entry_bytes\": xxxxx,   (numeric) Number of bytes of the arena holding the entries\n"
+            "    \"map_bytes\": xxxxx,     (numeric) Estimated number of bytes used by the hash map over the entries\n"
+            "    \"bytes_per_entry\": x.xx, (numeric) Both of the above, per entry\n"
             "  }\n"
             "}\n"
             "\nResult (mode \"mallocinfo\"):\n"
@@ -556,6 +612,9 @@ UniValue getmemoryinfo(const JSONRPCRequest& request)
     if (mode == "stats") {
         UniValue obj(UniValue::VOBJ);
         obj.push_back(Pair("locked", RPCLockedMemoryInfo()));
+        obj.push_back(Pair("scrypt", RPCScryptMemoryInfo()));
+        obj.push_back(Pair("auxpow", RPCAuxPowMemoryInfo()));
+        obj.push_back(Pair("blockindex", RPCBlockIndexMemoryInfo()));
         return obj;
     } else if (mode == "mallocinfo") {
 #ifdef HAVE_MALLOC_INFO
@@ -365,6 +365,15 @@ UniValue getnettotals(const JSONRPCRequest& request)
             "    \"serve_historical_blocks\": true|false,  (boolean) True if serving historical blocks\n"
             "    \"bytes_left_in_cycle\": t,               (numeric) Bytes left in current time cycle\n"
             "    \"time_left_in_cycle\": t                 (numeric) Seconds left in current time cycle\n"
+            "  },\n"
+            "  \"bufferpool\":\n"
+            "  {\n"
+            "    \"hits\": n,                              (numeric) Message buffers reused from the pool\n"
+            "    \"misses\": n,                            (numeric) Message buffers that had to be allocated\n"
+            "    \"recycled\": n,                          (numeric) Message buffers returned to the pool\n"
+            "    \"dropped\": n,                           (numeric) Message buffers freed instead of pooled\n"
+            "    \"free_buffers\": n,                      (numeric) Buffers currently held by the pool\n"
+            "    \"free_bytes\": n                         (numeric) Capacity of the buffers held by the pool\n"
             "  }\n"
             "}\n"
             "\nExamples:\n"
@@ -387,6 +396,16 @@ UniValue getnettotals(const JSONRPCRequest& request)
     outboundLimit.push_back(Pair("bytes_left_in_cycle", g_connman->GetOutboundTargetBytesLeft()));
     outboundLimit.push_back(Pair("time_left_in_cycle", g_connman->GetMaxOutboundTimeLeftInCycle()));
     obj.push_back(Pair("uploadtarget", outboundLimit));
+
+    CNetBufferPool::Stats poolStats = g_connman->GetBufferPoolStats();
+    UniValue bufferPool(UniValue::VOBJ);
+    bufferPool.push_back(Pair("hits", poolStats.nHits));
+    bufferPool.push_back(Pair("misses", poolStats.nMisses));
+    bufferPool.push_back(Pair("recycled", poolStats.nRecycled));
+    bufferPool.push_back(Pair("dropped", poolStats.nDropped));
+    bufferPool.push_back(Pair("free_buffers", (uint64_t)poolStats.nFreeBuffers));
+    bufferPool.push_back(Pair("free_bytes", (uint64_t)poolStats.nFreeBytes));
+    obj.push_back(Pair("bufferpool", bufferPool));
     return obj;
 }
 
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_SALTEDCACHE_H
+#define BITCOIN_SALTEDCACHE_H
+
+#include "cuckoocache.h"
+#include "hash.h"
+#include "random.h"
+#include "script/sigcache.h"
+#include "uint256.h"
+#include "util.h"
+
+#include <algorithm>
+#include <string>
+
+#include <boost/thread.hpp>
+
+/**
+ * Cache of checks that passed, shared between threads, such as the proof-of-work
+ * checks of headers and auxpows.
+ *
+ * Entries are SHA256d(nonce || args...) of whatever the check looked at. The
+ * nonce is drawn anew by Init(), so entries cannot be predicted from outside
+ * and the cuckoo cache needs no further blinding (see SignatureCacheHasher).
+ */
+template <typename... Args>
+class CSaltedCache
+{
+private:
+    uint256 nonce;
+    typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
+    map_type setValid;
+    boost::shared_mutex cs;
+
+public:
+    CSaltedCache()
+    {
+        GetRandBytes(nonce.begin(), 32);
+    }
+
+    uint256 Entry(const Args&... args) const
+    {
+        CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+        ss << nonce;
+        SerializeMany(ss, args...);
+        return ss.GetHash();
+    }
+
+    /** With erase, the entry's slot may be reused by later insertions; it keeps being found until then. */
+    bool Contains(const uint256& entry, bool erase)
+    {
+        boost::shared_lock<boost::shared_mutex> lock(cs);
+        return setValid.contains(entry, erase);
+    }
+
+    void Insert(const uint256& entry)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs);
+        setValid.insert(entry);
+    }
+
+    /**
+     * Draw a new nonce, so entries computed before no longer match, and size the
+     * cache from the strArg MiB argument, clamped to nMaxSize. To be called once in
+     * AppInitMain/BasicTestingSetup, before other threads use the cache.
+     */
+    void Init(const std::string& strArg, int64_t nDefaultSize, int64_t nMaxSize, const std::string& strName)
+    {
+        boost::unique_lock<boost::shared_mutex> lock(cs);
+        GetRandBytes(nonce.begin(), 32);
+        // nMaxCacheSize is unsigned. If the argument is set to zero,
+        // setup_bytes creates the minimum possible cache (2 elements).
+        size_t nMaxCacheSize = std::min(std::max((int64_t)0, gArgs.GetArg(strArg, nDefaultSize)), nMaxSize) * ((size_t) 1 << 20);
+        size_t nElems = setValid.setup_bytes(nMaxCacheSize);
+        LogPrintf("Using %zu MiB out of %zu requested for %s, able to store %zu elements\n",
+                (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, strName, nElems);
+    }
+};
+
+#endif // BITCOIN_SALTEDCACHE_H
@@ -366,6 +366,15 @@ BOOST_AUTO_TEST_CASE( divide )
     BOOST_CHECK(R2L / MaxL == ZeroL);
     BOOST_CHECK(MaxL / R2L == 1);
     BOOST_CHECK_THROW(R2L / ZeroL, uint_error);
+
+    const uint32_t divisors[] = {1, 2, 3, 7, 144, 10080, 0x7fffffff, 0xffffffff};
+    for (uint32_t d : divisors) {
+        BOOST_CHECK(arith_uint256(R1L).DivideBy(d) == R1L / d);
+        BOOST_CHECK(arith_uint256(R2L).DivideBy(d) == R2L / d);
+        BOOST_CHECK(arith_uint256(MaxL).DivideBy(d) == MaxL / d);
+        BOOST_CHECK(arith_uint256(OneL).DivideBy(d) == OneL / d);
+    }
+    BOOST_CHECK_THROW(arith_uint256(R1L).DivideBy(0), uint_error);
 }
 
 
@@ -0,0 +1,109 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/blockcache.h"
+#include "chain.h"
+#include "primitives/block.h"
+#include "test/test_bitcoin.h"
+#include "utiltime.h"
+#include "validation.h"
+#include "validationinterface.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(auxpow_blockcache_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(auxblock_cache)
+{
+    CAuxBlockCache cache(MAX_AUXBLOCK_CACHE_BYTES);
+    RegisterValidationInterface(&cache);
+    const CScript scriptA = CScript() << OP_TRUE;
+    const CScript scriptB = CScript() << OP_2;
+    int nHeight;
+
+    // One template per payout script, shared until something changes
+    std::shared_ptr<const CBlock> pblockA = cache.Create(scriptA, nHeight);
+    BOOST_CHECK_EQUAL(nHeight, chainActive.Height() + 1);
+    BOOST_CHECK(pblockA->IsAuxPow());
+    BOOST_CHECK(pblockA->vtx[0]->vout[0].scriptPubKey == scriptA);
+    BOOST_CHECK(cache.Create(scriptA, nHeight) == pblockA);
+    std::shared_ptr<const CBlock> pblockB = cache.Create(scriptB, nHeight);
+    BOOST_CHECK(pblockB->vtx[0]->vout[0].scriptPubKey == scriptB);
+    BOOST_CHECK(pblockB->GetHash() != pblockA->GetHash());
+
+    // A caller that already knows of another tip does not get the template
+    BOOST_CHECK(cache.Create(scriptB, nHeight, pblockB->hashPrevBlock) == pblockB);
+    std::shared_ptr<const CBlock> pblockB2 = cache.Create(scriptB, nHeight, InsecureRand256());
+    BOOST_CHECK(pblockB2 != pblockB);
+    BOOST_CHECK(cache.Create(scriptB, nHeight) == pblockB2);
+
+    std::shared_ptr<CBlock> pblock = cache.Lookup(pblockA->GetHash());
+    BOOST_CHECK(pblock && pblock->GetHash() == pblockA->GetHash());
+    BOOST_CHECK(!cache.Lookup(InsecureRand256()));
+
+    // A mempool change is picked up once the template is old enough, and the
+    // block handed out before stays submittable
+    const int64_t nTime = GetTime();
+    GetMainSignals().TransactionAddedToMempool(MakeTransactionRef(CMutableTransaction()));
+    GetMainSignals().FlushBackgroundCallbacks();
+    SetMockTime(nTime + AUXBLOCK_REFRESH_INTERVAL / 2);
+    BOOST_CHECK(cache.Create(scriptA, nHeight) == pblockA);
+    SetMockTime(nTime + AUXBLOCK_REFRESH_INTERVAL + 1);
+    std::shared_ptr<const CBlock> pblockA2 = cache.Create(scriptA, nHeight);
+    BOOST_CHECK(pblockA2 != pblockA);
+    BOOST_CHECK(cache.Create(scriptA, nHeight) == pblockA2);
+    BOOST_CHECK(cache.Lookup(pblockA->GetHash()));
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 4U);
+    SetMockTime(0);
+
+    // Notifications about the tip the blocks build on change nothing, a new
+    // tip makes everything stale
+    GetMainSignals().UpdatedBlockTip(chainActive.Tip(), chainActive.Tip(), false);
+    GetMainSignals().FlushBackgroundCallbacks();
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 4U);
+    const uint256 hashTip = InsecureRand256();
+    CBlockIndex indexTip;
+    indexTip.phashBlock = &hashTip;
+    GetMainSignals().UpdatedBlockTip(&indexTip, chainActive.Tip(), false);
+    GetMainSignals().FlushBackgroundCallbacks();
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 0U);
+    BOOST_CHECK(!cache.Lookup(pblockA2->GetHash()));
+    BOOST_CHECK(cache.Create(scriptA, nHeight) != pblockA2);
+
+    UnregisterValidationInterface(&cache);
+}
+
+BOOST_AUTO_TEST_CASE(auxblock_cache_budget)
+{
+    const CScript scriptA = CScript() << OP_1;
+    const CScript scriptB = CScript() << OP_2;
+    const CScript scriptC = CScript() << OP_3;
+    int nHeight;
+
+    // Nothing is kept in an empty budget, but blocks are still made
+    CAuxBlockCache cacheEmpty(0);
+    std::shared_ptr<const CBlock> pblockA = cacheEmpty.Create(scriptA, nHeight);
+    BOOST_CHECK(pblockA);
+    BOOST_CHECK_EQUAL(cacheEmpty.GetStats().entries, 0U);
+    BOOST_CHECK(!cacheEmpty.Lookup(pblockA->GetHash()));
+
+    // Room for two blocks: the oldest goes first, along with its template
+    CAuxBlockCache cacheProbe(MAX_AUXBLOCK_CACHE_BYTES);
+    cacheProbe.Create(scriptA, nHeight);
+    const size_t nEntryBytes = cacheProbe.GetStats().bytes;
+    BOOST_CHECK(nEntryBytes > 0);
+
+    CAuxBlockCache cache(2 * nEntryBytes + nEntryBytes / 2);
+    pblockA = cache.Create(scriptA, nHeight);
+    std::shared_ptr<const CBlock> pblockB = cache.Create(scriptB, nHeight);
+    std::shared_ptr<const CBlock> pblockC = cache.Create(scriptC, nHeight);
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 2U);
+    BOOST_CHECK(!cache.Lookup(pblockA->GetHash()));
+    BOOST_CHECK(cache.Lookup(pblockB->GetHash()));
+    BOOST_CHECK(cache.Create(scriptA, nHeight) != pblockA);
+    BOOST_CHECK(!cache.Lookup(pblockB->GetHash()));
+    BOOST_CHECK(cache.Create(scriptC, nHeight) == pblockC);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,81 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/auxpow.h"
+#include "auxpow/cache.h"
+#include "test/test_bitcoin.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(auxpow_cache_tests, BasicTestingSetup)
+
+static CAuxPow RandomAuxPow()
+{
+    CAuxPow auxpow;
+    auxpow.parentBlockHeader.hashMerkleRoot = InsecureRand256();
+    auxpow.parentBlockHeader.nNonce = InsecureRand32();
+    auxpow.nChainIndex = InsecureRand32();
+    return auxpow;
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_cache_insert_contains)
+{
+    const uint256 hashAuxBlock = InsecureRand256();
+    CAuxPow auxpow = RandomAuxPow();
+
+    const uint256 entry = AuxpowCacheEntry(hashAuxBlock, auxpow);
+    BOOST_CHECK(entry == AuxpowCacheEntry(hashAuxBlock, auxpow));
+    BOOST_CHECK(!AuxpowCacheContains(entry));
+    AuxpowCacheInsert(entry);
+    BOOST_CHECK(AuxpowCacheContains(entry));
+
+    // The entry covers the aux block hash and every part of the auxpow
+    BOOST_CHECK(!AuxpowCacheContains(AuxpowCacheEntry(InsecureRand256(), auxpow)));
+    auxpow.nChainIndex++;
+    BOOST_CHECK(!AuxpowCacheContains(AuxpowCacheEntry(hashAuxBlock, auxpow)));
+    auxpow.nChainIndex--;
+    auxpow.parentBlockHeader.nNonce++;
+    BOOST_CHECK(!AuxpowCacheContains(AuxpowCacheEntry(hashAuxBlock, auxpow)));
+    auxpow.parentBlockHeader.nNonce--;
+    BOOST_CHECK(AuxpowCacheContains(AuxpowCacheEntry(hashAuxBlock, auxpow)));
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_cache_salt)
+{
+    const uint256 hashAuxBlock = InsecureRand256();
+    const CAuxPow auxpow = RandomAuxPow();
+
+    const uint256 entry = AuxpowCacheEntry(hashAuxBlock, auxpow);
+    AuxpowCacheInsert(entry);
+    BOOST_CHECK(AuxpowCacheContains(entry));
+
+    // A new nonce gives the same auxpow another entry, which the cache has not seen
+    InitAuxpowCache();
+    const uint256 entrySalted = AuxpowCacheEntry(hashAuxBlock, auxpow);
+    BOOST_CHECK(entrySalted != entry);
+    BOOST_CHECK(!AuxpowCacheContains(entrySalted));
+    AuxpowCacheInsert(entrySalted);
+    BOOST_CHECK(AuxpowCacheContains(entrySalted));
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_cache_erase)
+{
+    std::vector<uint256> vEntry;
+    for (int i = 0; i < 100; i++) {
+        vEntry.push_back(AuxpowCacheEntry(InsecureRand256(), RandomAuxPow()));
+        AuxpowCacheInsert(vEntry.back());
+    }
+
+    // Erasing only frees the slot, the entry is found until something else takes it
+    for (int i = 0; i < 50; i++)
+        BOOST_CHECK(AuxpowCacheContains(vEntry[i], true));
+    for (const uint256& entry : vEntry)
+        BOOST_CHECK(AuxpowCacheContains(entry));
+
+    // Inserting an erased entry again keeps it
+    AuxpowCacheInsert(vEntry[0]);
+    BOOST_CHECK(AuxpowCacheContains(vEntry[0]));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
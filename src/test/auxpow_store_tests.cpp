@@ -0,0 +1,242 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "auxpow/auxpow.h"
+#include "auxpow/compress.h"
+#include "auxpow/store.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "streams.h"
+#include "test/test_bitcoin.h"
+#include "txdb.h"
+#include "utilstrencodings.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(auxpow_store_tests, BasicTestingSetup)
+
+static std::shared_ptr<CAuxPow> MakeAuxPow(int nBranch)
+{
+    std::shared_ptr<CAuxPow> auxpow = std::make_shared<CAuxPow>();
+    auxpow->SetTx(MakeTransactionRef(CMutableTransaction()));
+    for (int i = 0; i < nBranch; i++)
+        auxpow->vMerkleBranch.push_back(InsecureRand256());
+    return auxpow;
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_store_lru)
+{
+    CAuxPowStore store(0);
+    const std::shared_ptr<CAuxPow> auxpow = MakeAuxPow(8);
+    std::vector<uint256> vHash;
+    for (int i = 0; i < 4; i++)
+        vHash.push_back(InsecureRand256());
+
+    // Nothing fits in an empty budget
+    store.Put(vHash[0], auxpow);
+    BOOST_CHECK(!store.Contains(vHash[0]));
+
+    // Room for exactly three entries
+    store.SetMaxBytes(1 << 20);
+    store.Put(vHash[0], auxpow);
+    const size_t nEntryBytes = store.GetStats().bytes;
+    BOOST_CHECK(nEntryBytes > 0);
+    store.SetMaxBytes(3 * nEntryBytes);
+    store.Put(vHash[1], auxpow);
+    store.Put(vHash[2], auxpow);
+
+    // Touching the oldest entry makes vHash[1] the next to go
+    BOOST_CHECK(store.Get(vHash[0]) == auxpow);
+    store.Put(vHash[3], auxpow);
+    BOOST_CHECK(store.Contains(vHash[0]));
+    BOOST_CHECK(!store.Contains(vHash[1]));
+    BOOST_CHECK(store.Contains(vHash[2]));
+    BOOST_CHECK(store.Contains(vHash[3]));
+    BOOST_CHECK(store.Get(vHash[1]) == nullptr);
+
+    CAuxPowStore::Stats stats = store.GetStats();
+    BOOST_CHECK_EQUAL(stats.entries, 3U);
+    BOOST_CHECK_EQUAL(stats.bytes, 3 * nEntryBytes);
+    BOOST_CHECK_EQUAL(stats.hits, 1U);
+    BOOST_CHECK_EQUAL(stats.misses, 1U);
+
+    // Shrinking evicts from the cold end
+    store.SetMaxBytes(nEntryBytes);
+    BOOST_CHECK(store.Contains(vHash[3]));
+    BOOST_CHECK_EQUAL(store.GetStats().entries, 1U);
+
+    store.Clear();
+    BOOST_CHECK_EQUAL(store.GetStats().entries, 0U);
+    BOOST_CHECK_EQUAL(store.GetStats().bytes, 0U);
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_store_unload)
+{
+    // Unloading the block index, as a reload or -reindex does, drops the auxpows read from it
+    const uint256 hash = InsecureRand256();
+    auxpowStore.Put(hash, MakeAuxPow(1));
+    BOOST_CHECK(auxpowStore.Contains(hash));
+    UnloadBlockIndex();
+    BOOST_CHECK(!auxpowStore.Contains(hash));
+}
+
+/** An auxpow shaped like a pool's: coinbase with a payout and a segwit commitment, consistent parent merkle root */
+static std::shared_ptr<CAuxPow> MakePoolAuxPow(const CScript& scriptPayout)
+{
+    std::shared_ptr<CAuxPow> auxpow = std::make_shared<CAuxPow>();
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    coinbase.vin[0].scriptSig = CScript() << InsecureRand32() << ToByteVector(InsecureRand256());
+    coinbase.vout.resize(2);
+    coinbase.vout[0].nValue = 25 * COIN + InsecureRandRange(COIN);
+    coinbase.vout[0].scriptPubKey = scriptPayout;
+    const uint256 hashCommitment = InsecureRand256();
+    coinbase.vout[1].nValue = 0;
+    coinbase.vout[1].scriptPubKey = CScript() << OP_RETURN << ParseHex("aa21a9ed" + hashCommitment.GetHex());
+    auxpow->SetTx(MakeTransactionRef(std::move(coinbase)));
+    auxpow->nIndex = 0;
+    for (int i = 0; i < 10; i++)
+        auxpow->vMerkleBranch.push_back(InsecureRand256());
+    for (int i = 0; i < 2; i++)
+        auxpow->vChainMerkleBranch.push_back(InsecureRand256());
+    auxpow->nChainIndex = 3;
+    auxpow->parentBlockHeader.nVersion = 0x20000000;
+    auxpow->parentBlockHeader.hashPrevBlock = InsecureRand256();
+    auxpow->parentBlockHeader.hashMerkleRoot = auxpow->CheckMerkleBranch(auxpow->GetHash(), auxpow->vMerkleBranch, auxpow->nIndex);
+    auxpow->parentBlockHeader.nTime = 1500000000;
+    auxpow->parentBlockHeader.nBits = 0x1a01cd2d;
+    auxpow->parentBlockHeader.nNonce = InsecureRand32();
+    return auxpow;
+}
+
+static void CheckRoundTrip(std::shared_ptr<CAuxPow> auxpow, CAuxPowScriptDict& dict, std::vector<std::pair<uint32_t, CScript> >& vNewScripts, size_t& nCompactSize)
+{
+    CDataStream ssCompact(SER_DISK, CLIENT_VERSION);
+    ssCompact << CAuxPowCompressor(auxpow, dict, &vNewScripts);
+    nCompactSize = ssCompact.size();
+
+    std::shared_ptr<CAuxPow> auxpowRead;
+    CAuxPowCompressor compressor(auxpowRead, dict);
+    ssCompact >> compressor;
+    BOOST_CHECK(ssCompact.empty());
+
+    CDataStream ssExpected(SER_DISK, CLIENT_VERSION), ssRead(SER_DISK, CLIENT_VERSION);
+    ssExpected << *auxpow;
+    ssRead << *auxpowRead;
+    BOOST_CHECK(ssExpected.str() == ssRead.str());
+    BOOST_CHECK(auxpowRead->GetHash() == auxpow->GetHash());
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_compressor)
+{
+    CAuxPowScriptDict dict;
+    std::vector<std::pair<uint32_t, CScript> > vNewScripts;
+    const uint256 hashKey = InsecureRand256();
+    const CScript scriptPayout = CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(hashKey.begin(), hashKey.begin() + 20) << OP_EQUALVERIFY << OP_CHECKSIG;
+    size_t nCompactSize;
+
+    // The first auxpow paying to a script adds it to the dictionary...
+    std::shared_ptr<CAuxPow> auxpow = MakePoolAuxPow(scriptPayout);
+    CheckRoundTrip(auxpow, dict, vNewScripts, nCompactSize);
+    BOOST_CHECK_EQUAL(vNewScripts.size(), 1U);
+    BOOST_CHECK(vNewScripts[0].second == scriptPayout);
+    BOOST_CHECK_EQUAL(dict.size(), 1U);
+
+    // ...and later ones refer to it
+    vNewScripts.clear();
+    auxpow = MakePoolAuxPow(scriptPayout);
+    CheckRoundTrip(auxpow, dict, vNewScripts, nCompactSize);
+    BOOST_CHECK(vNewScripts.empty());
+    BOOST_CHECK(nCompactSize + 100 < ::GetSerializeSize(*auxpow, SER_DISK, CLIENT_VERSION));
+
+    // Unrelated merkle roots, non-final sequences and hashBlock are kept as they are
+    CMutableTransaction coinbase(*auxpow->tx);
+    coinbase.vin[0].nSequence = 7;
+    auxpow->SetTx(MakeTransactionRef(std::move(coinbase)));
+    auxpow->hashBlock = InsecureRand256();
+    CheckRoundTrip(auxpow, dict, vNewScripts, nCompactSize);
+
+    // Coinbases with amounts out of range or more inputs, and parents that are merge-mined themselves
+    coinbase = CMutableTransaction(*auxpow->tx);
+    coinbase.vout[1].nValue = -1;
+    auxpow->SetTx(MakeTransactionRef(coinbase));
+    CheckRoundTrip(auxpow, dict, vNewScripts, nCompactSize);
+    coinbase.vin.resize(2);
+    auxpow->SetTx(MakeTransactionRef(std::move(coinbase)));
+    CheckRoundTrip(auxpow, dict, vNewScripts, nCompactSize);
+    auxpow->parentBlockHeader.nVersion |= AuxPow::BLOCK_VERSION_AUXPOW;
+    auxpow->parentBlockHeader.auxpow = MakePoolAuxPow(scriptPayout);
+    CheckRoundTrip(auxpow, dict, vNewScripts, nCompactSize);
+
+    // A dictionary missing the payout script cannot decode the auxpow
+    CAuxPowScriptDict dictEmpty;
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << CAuxPowCompressor(REF(MakePoolAuxPow(scriptPayout)), dict);
+    std::shared_ptr<CAuxPow> auxpowRead;
+    CAuxPowCompressor compressor(auxpowRead, dictEmpty);
+    BOOST_CHECK_THROW(ss >> compressor, std::ios_base::failure);
+}
+
+BOOST_AUTO_TEST_CASE(auxpow_blocktree_upgrade)
+{
+    CBlockTreeDB blocktree(1 << 20, true);
+    const CScript scriptPayout = CScript() << OP_TRUE;
+
+    // Entries as older versions wrote them: the whole CDiskBlockIndex with the
+    // auxpow under 'a', the mutable fields under 'b'
+    std::vector<CBlockIndex> vIndex(3);
+    std::vector<uint256> vHash;
+    std::vector<std::shared_ptr<CAuxPow> > vAuxPow;
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        vHash.push_back(InsecureRand256());
+        vIndex[i].phashBlock = &vHash[i];
+        vIndex[i].nHeight = i;
+        vIndex[i].nStatus = BLOCK_VALID_TREE;
+        vAuxPow.push_back(i == 1 ? nullptr : MakePoolAuxPow(scriptPayout));
+        if (vAuxPow[i])
+            vIndex[i].nVersion |= AuxPow::BLOCK_VERSION_AUXPOW;
+        CDBBatch batch(blocktree);
+        batch.Write(std::make_pair(std::make_pair('b', vHash[i]), 'a'), CDiskBlockIndex(&vIndex[i], vAuxPow[i]));
+        vIndex[i].nStatus |= BLOCK_HAVE_DATA;
+        vIndex[i].nDataPos = 1000 * i;
+        batch.Write(std::make_pair(std::make_pair('b', vHash[i]), 'b'), vIndex[i]);
+        BOOST_CHECK(blocktree.WriteBatch(batch));
+    }
+
+    // Auxpows can be read before and after the upgrade
+    std::shared_ptr<CAuxPow> auxpow;
+    BOOST_CHECK(blocktree.ReadAuxPow(vHash[0], auxpow));
+    BOOST_CHECK(auxpow->GetHash() == vAuxPow[0]->GetHash());
+    BOOST_CHECK(blocktree.Upgrade());
+    BOOST_CHECK(blocktree.Exists(std::make_pair('A', vHash[0])));
+    BOOST_CHECK(!blocktree.Exists(std::make_pair(std::make_pair('b', vHash[0]), 'a')));
+    BOOST_CHECK(!blocktree.Exists(std::make_pair(std::make_pair('b', vHash[0]), 'b')));
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        BOOST_CHECK_EQUAL(blocktree.ReadAuxPow(vHash[i], auxpow), vAuxPow[i] != nullptr);
+        if (vAuxPow[i])
+            BOOST_CHECK(auxpow->GetHash() == vAuxPow[i]->GetHash());
+    }
+
+    // The index loads without its auxpows, keeping the mutable fields of 'b'
+    std::map<uint256, std::unique_ptr<CBlockIndex> > mapIndex;
+    BOOST_CHECK(blocktree.LoadBlockIndexGuts(Params().GetConsensus(), [&mapIndex](const uint256& hash) {
+        std::unique_ptr<CBlockIndex>& pindex = mapIndex[hash];
+        if (!pindex)
+            pindex.reset(new CBlockIndex());
+        return pindex.get();
+    }));
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        BOOST_CHECK(mapIndex.count(vHash[i]));
+        BOOST_CHECK_EQUAL(mapIndex[vHash[i]]->nHeight, (int)i);
+        BOOST_CHECK_EQUAL(mapIndex[vHash[i]]->nStatus, vIndex[i].nStatus);
+        BOOST_CHECK_EQUAL(mapIndex[vHash[i]]->nDataPos, vIndex[i].nDataPos);
+        BOOST_CHECK_EQUAL(mapIndex[vHash[i]]->nVersion, vIndex[i].nVersion);
+    }
+
+    // A second run finds nothing to do
+    BOOST_CHECK(blocktree.Upgrade());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
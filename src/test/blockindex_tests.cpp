@@ -0,0 +1,216 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "arith_uint256.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "pow.h"
+#include "test/test_bitcoin.h"
+#include "txdb.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(blockindex_tests, BasicTestingSetup)
+
+/** A chain of headers that meet the minimum mainnet target, with their PoW hashes */
+struct PoWChain
+{
+    std::vector<CBlockHeader> vHeader;
+    std::vector<uint256> vHash;
+    std::vector<uint256> vHashPoW;
+    std::vector<CBlockIndex> vIndex;
+
+    explicit PoWChain(size_t nLength) : vHash(nLength), vIndex(nLength)
+    {
+        const Consensus::Params& params = Params().GetConsensus();
+        for (size_t i = 0; i < nLength; i++) {
+            CBlockHeader header;
+            header.nVersion = 1;
+            header.hashPrevBlock = i ? vHash[i - 1] : uint256();
+            header.hashMerkleRoot = InsecureRand256();
+            header.nTime = 1000 + i;
+            header.nBits = UintToArith256(params.powLimit).GetCompact();
+            while (!CheckProofOfWork(header.GetPoWHash(), header.nBits, params))
+                header.nNonce++;
+            vHeader.push_back(header);
+            vHash[i] = header.GetHash();
+            vHashPoW.push_back(header.GetPoWHash());
+            vIndex[i] = CBlockIndex(header);
+            vIndex[i].phashBlock = &vHash[i];
+            vIndex[i].pprev = i ? &vIndex[i - 1] : nullptr;
+            vIndex[i].nHeight = i;
+            vIndex[i].nStatus = BLOCK_VALID_TREE;
+        }
+    }
+
+    /** Write the entries, with the PoW hashes of all but the first */
+    void Write(CBlockTreeDB& blocktree) const
+    {
+        std::vector<const CBlockIndex*> vpindex;
+        std::map<uint256, uint256> mapPoWHash;
+        for (size_t i = 0; i < vIndex.size(); i++) {
+            vpindex.push_back(&vIndex[i]);
+            if (i)
+                mapPoWHash[vHash[i]] = vHashPoW[i];
+        }
+        BOOST_CHECK(blocktree.WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0, vpindex, std::map<uint256, std::shared_ptr<CAuxPow> >(), mapPoWHash));
+        BOOST_CHECK(blocktree.WriteFlag("powhashes", true));
+    }
+};
+
+static bool LoadFrom(CBlockTreeDB& blocktree)
+{
+    CBlockTreeDB* pblocktreeOld = pblocktree;
+    pblocktree = &blocktree;
+    bool fRet = LoadBlockIndex(Params());
+    UnloadBlockIndex();
+    pblocktree = pblocktreeOld;
+    return fRet;
+}
+
+BOOST_AUTO_TEST_CASE(blockindex_powhashes)
+{
+    PoWChain chain(4);
+    const std::pair<char, uint256> key1('P', chain.vHash[1]);
+    const std::pair<char, uint256> key2('P', chain.vHash[2]);
+
+    // Stored hashes that belong to their entries load as they are
+    {
+        CBlockTreeDB blocktree(1 << 20, true);
+        chain.Write(blocktree);
+        BOOST_CHECK(LoadFrom(blocktree));
+    }
+
+    // A hash stored for another entry, and one in the old format without a
+    // checksum, are recomputed from their headers and written back
+    {
+        CBlockTreeDB blocktree(1 << 20, true);
+        chain.Write(blocktree);
+        BOOST_CHECK(blocktree.Write(key1, CDiskPoWHash(chain.vHash[3], chain.vHashPoW[3])));
+        BOOST_CHECK(blocktree.Write(key2, chain.vHashPoW[2]));
+        BOOST_CHECK(LoadFrom(blocktree));
+        CDiskPoWHash diskpowhash;
+        BOOST_CHECK(blocktree.Read(key1, diskpowhash));
+        BOOST_CHECK(diskpowhash.IsFor(chain.vHash[1]));
+        BOOST_CHECK(diskpowhash.hashPoW == chain.vHashPoW[1]);
+        BOOST_CHECK(blocktree.Read(key2, diskpowhash));
+        BOOST_CHECK(diskpowhash.IsFor(chain.vHash[2]));
+        BOOST_CHECK(diskpowhash.hashPoW == chain.vHashPoW[2]);
+    }
+
+    // Once all hashes are stored, a missing one is corruption
+    {
+        CBlockTreeDB blocktree(1 << 20, true);
+        chain.Write(blocktree);
+        BOOST_CHECK(blocktree.Erase(key2));
+        BOOST_CHECK(!LoadFrom(blocktree));
+        // Before that, it is left to the migration
+        BOOST_CHECK(blocktree.WriteFlag("powhashes", false));
+        BOOST_CHECK(LoadFrom(blocktree));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockindex_powhashes_invalid_header)
+{
+    // An entry whose header does not meet its target fails to load once its
+    // stored hash no longer vouches for it
+    PoWChain chain(3);
+    const Consensus::Params& params = Params().GetConsensus();
+    CBlockHeader header = chain.vHeader[2];
+    do {
+        header.nNonce++;
+    } while (CheckProofOfWork(header.GetPoWHash(), header.nBits, params));
+    chain.vHash[2] = header.GetHash();
+    chain.vIndex[2].nNonce = header.nNonce;
+
+    CBlockTreeDB blocktree(1 << 20, true);
+    chain.Write(blocktree);
+    BOOST_CHECK(blocktree.Write(std::make_pair('P', chain.vHash[2]), CDiskPoWHash(chain.vHash[1], chain.vHashPoW[2])));
+    BOOST_CHECK(!LoadFrom(blocktree));
+}
+
+BOOST_AUTO_TEST_CASE(blocktree_load_batches)
+{
+    // Enough entries for the loader to split them over several decoding batches
+    CBlockTreeDB blocktree(1 << 20, true);
+    const size_t nEntries = 40000;
+    std::vector<CBlockIndex> vIndex(nEntries);
+    std::vector<uint256> vHash(nEntries);
+    std::vector<const CBlockIndex*> vpindex;
+    for (size_t i = 0; i < nEntries; i++) {
+        vHash[i] = InsecureRand256();
+        vIndex[i].phashBlock = &vHash[i];
+        vIndex[i].pprev = i ? &vIndex[i - 1] : nullptr;
+        vIndex[i].nHeight = i;
+        vIndex[i].nTime = 1000 + i;
+        vIndex[i].nStatus = BLOCK_VALID_TREE;
+        vpindex.push_back(&vIndex[i]);
+    }
+    BOOST_CHECK(blocktree.WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0, vpindex, std::map<uint256, std::shared_ptr<CAuxPow> >(), std::map<uint256, uint256>()));
+
+    std::map<uint256, std::unique_ptr<CBlockIndex> > mapIndex;
+    BOOST_CHECK(blocktree.LoadBlockIndexGuts(Params().GetConsensus(), [&mapIndex](const uint256& hash) -> CBlockIndex* {
+        if (hash.IsNull())
+            return nullptr;
+        std::unique_ptr<CBlockIndex>& pindex = mapIndex[hash];
+        if (!pindex)
+            pindex.reset(new CBlockIndex());
+        return pindex.get();
+    }));
+    BOOST_CHECK_EQUAL(mapIndex.size(), nEntries);
+    for (size_t i = 0; i < nEntries; i++) {
+        const CBlockIndex* pindex = mapIndex[vHash[i]].get();
+        BOOST_CHECK_EQUAL(pindex->nHeight, (int)i);
+        BOOST_CHECK_EQUAL(pindex->nTime, vIndex[i].nTime);
+        BOOST_CHECK(pindex->pprev == (i ? mapIndex[vHash[i - 1]].get() : nullptr));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(blockindex_load_height_order)
+{
+    // A chain of 100 entries with a fork of 10 off height 50
+    CBlockTreeDB blocktree(1 << 20, true);
+    std::vector<CBlockIndex> vIndex(110);
+    std::vector<uint256> vHash(vIndex.size());
+    std::vector<const CBlockIndex*> vpindex;
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        vHash[i] = InsecureRand256();
+        vIndex[i].phashBlock = &vHash[i];
+        vIndex[i].pprev = i == 0 ? nullptr : &vIndex[i == 100 ? 50 : i - 1];
+        vIndex[i].nHeight = vIndex[i].pprev ? vIndex[i].pprev->nHeight + 1 : 0;
+        vIndex[i].nBits = 0x207fffff;
+        vIndex[i].nStatus = BLOCK_VALID_TREE;
+        vpindex.push_back(&vIndex[i]);
+    }
+    BOOST_CHECK(blocktree.WriteBatchSync(std::vector<std::pair<int, const CBlockFileInfo*> >(), 0, vpindex, std::map<uint256, std::shared_ptr<CAuxPow> >(), std::map<uint256, uint256>()));
+
+    CBlockTreeDB* pblocktreeOld = pblocktree;
+    pblocktree = &blocktree;
+    BOOST_CHECK(LoadBlockIndex(Params()));
+    BOOST_CHECK_EQUAL(mapBlockIndex.size(), vIndex.size());
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        const CBlockIndex* pindex = mapBlockIndex[vHash[i]];
+        BOOST_CHECK(pindex->GetBlockHash() == vHash[i]);
+        BOOST_CHECK_EQUAL(pindex->nHeight, vIndex[i].nHeight);
+        if (i) {
+            // Entries are laid out by height, parents first
+            BOOST_CHECK(pindex->pprev == mapBlockIndex[vIndex[i].pprev->GetBlockHash()]);
+            BOOST_CHECK(pindex > pindex->pprev);
+        }
+    }
+    BOOST_CHECK(mapBlockIndex[vHash[109]]->GetAncestor(0) == mapBlockIndex[vHash[0]]);
+    BOOST_CHECK(mapBlockIndex[vHash[109]]->GetAncestor(50) == mapBlockIndex[vHash[50]]);
+    {
+        LOCK(cs_main);
+        BlockIndexMemoryStats stats = GetBlockIndexMemoryStats();
+        BOOST_CHECK_EQUAL(stats.entries, vIndex.size());
+        BOOST_CHECK(stats.entry_bytes >= vIndex.size() * sizeof(CBlockIndex));
+        BOOST_CHECK(stats.map_bytes > 0);
+    }
+    UnloadBlockIndex();
+    pblocktree = pblocktreeOld;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -10,6 +10,7 @@
 #include "crypto/sha512.h"
 #include "crypto/hmac_sha256.h"
 #include "crypto/hmac_sha512.h"
+#include "hash.h"
 #include "random.h"
 #include "utilstrencodings.h"
 #include "test/test_bitcoin.h"
@@ -268,6 +269,46 @@ BOOST_AUTO_TEST_CASE(sha256_testvectors) {
     TestSHA256(test1, "a316d55510b49662420f49d145d42fb83f31ef8dc016aa4e32df049991a91e26");
 }
 
+BOOST_AUTO_TEST_CASE(sha256d_batch) {
+    // Inputs of every length up to three blocks, so each lane meets every
+    // padding case and lanes finish out of step with each other.
+    std::vector<unsigned char> data(200);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = InsecureRandBits(8);
+    std::vector<const unsigned char*> in;
+    std::vector<size_t> len;
+    for (size_t l = 0; l <= 192; l++) {
+        in.push_back(data.data() + (l % 8));
+        len.push_back(l);
+    }
+    std::vector<uint256> expected(in.size());
+    for (size_t i = 0; i < in.size(); i++)
+        expected[i] = Hash(in[i], in[i] + len[i]);
+
+    for (size_t nMaxLanes : {1, 4, 8}) {
+        for (size_t n : {(size_t)1, (size_t)3, in.size()}) {
+            std::vector<uint256> hashes(n);
+            std::vector<unsigned char*> out(n);
+            for (size_t i = 0; i < n; i++)
+                out[i] = hashes[i].begin();
+            SHA256DBatch(out.data(), in.data(), len.data(), n, nMaxLanes);
+            for (size_t i = 0; i < n; i++)
+                BOOST_CHECK(hashes[i] == expected[i]);
+        }
+
+        // In place, as merkle tree levels are computed
+        std::vector<uint256> level(19);
+        for (uint256& h : level)
+            h = InsecureRand256();
+        std::vector<uint256> pairs(level.size() / 2);
+        for (size_t i = 0; i < pairs.size(); i++)
+            pairs[i] = Hash(level[2 * i].begin(), level[2 * i].end(), level[2 * i + 1].begin(), level[2 * i + 1].end());
+        SHA256D64(level[0].begin(), level[0].begin(), pairs.size(), nMaxLanes);
+        for (size_t i = 0; i < pairs.size(); i++)
+            BOOST_CHECK(level[i] == pairs[i]);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(sha512_testvectors) {
     TestSHA512("",
                "cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce"
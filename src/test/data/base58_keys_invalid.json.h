@@ -0,0 +1,507 @@
+namespace json_tests{
+static unsigned const char base58_keys_invalid[] = {
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x22, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x78, 0x22, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x22, 0x67, 0x5a, 0x58, 0x64,
+0x48, 0x6a, 0x6a, 0x39, 0x51, 0x43, 0x6e, 0x4e,
+0x7a, 0x35, 0x4b, 0x6e, 0x53, 0x71, 0x72, 0x58,
+0x6f, 0x32, 0x77, 0x38, 0x58, 0x67, 0x68, 0x71,
+0x55, 0x61, 0x59, 0x51, 0x6d, 0x6f, 0x46, 0x78,
+0x4d, 0x46, 0x61, 0x6b, 0x73, 0x38, 0x5a, 0x54,
+0x4c, 0x43, 0x63, 0x75, 0x32, 0x4c, 0x74, 0x57,
+0x6d, 0x57, 0x46, 0x54, 0x4e, 0x48, 0x33, 0x48,
+0x64, 0x58, 0x51, 0x34, 0x36, 0x79, 0x4a, 0x4e,
+0x68, 0x61, 0x32, 0x34, 0x70, 0x33, 0x54, 0x22,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
+0x36, 0x76, 0x46, 0x69, 0x65, 0x4b, 0x79, 0x46,
+0x33, 0x36, 0x52, 0x6d, 0x46, 0x6d, 0x76, 0x4d,
+0x61, 0x42, 0x56, 0x43, 0x39, 0x55, 0x4a, 0x79,
+0x51, 0x55, 0x6d, 0x32, 0x62, 0x31, 0x78, 0x6d,
+0x59, 0x52, 0x68, 0x77, 0x4a, 0x59, 0x39, 0x37,
+0x74, 0x76, 0x34, 0x70, 0x35, 0x4c, 0x46, 0x36,
+0x38, 0x46, 0x46, 0x22, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x22, 0x63, 0x51, 0x57, 0x47,
+0x6a, 0x38, 0x4d, 0x68, 0x43, 0x74, 0x4b, 0x62,
+0x4e, 0x32, 0x36, 0x6a, 0x32, 0x33, 0x45, 0x50,
+0x62, 0x75, 0x54, 0x50, 0x58, 0x5a, 0x35, 0x70,
+0x79, 0x50, 0x4b, 0x75, 0x59, 0x46, 0x46, 0x54,
+0x42, 0x4a, 0x4c, 0x78, 0x51, 0x76, 0x43, 0x57,
+0x51, 0x76, 0x4a, 0x45, 0x4d, 0x42, 0x45, 0x58,
+0x57, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x4a, 0x42, 0x6f, 0x65, 0x66, 0x41,
+0x4d, 0x66, 0x50, 0x4b, 0x57, 0x57, 0x61, 0x55,
+0x59, 0x50, 0x6f, 0x35, 0x65, 0x64, 0x57, 0x5a,
+0x76, 0x76, 0x74, 0x31, 0x43, 0x43, 0x6a, 0x61,
+0x54, 0x43, 0x50, 0x63, 0x70, 0x4c, 0x62, 0x74,
+0x56, 0x50, 0x76, 0x6d, 0x61, 0x6a, 0x6d, 0x31,
+0x52, 0x54, 0x5a, 0x6e, 0x4c, 0x54, 0x78, 0x67,
+0x74, 0x43, 0x78, 0x4d, 0x39, 0x51, 0x56, 0x45,
+0x66, 0x38, 0x69, 0x66, 0x39, 0x75, 0x37, 0x45,
+0x67, 0x38, 0x38, 0x66, 0x56, 0x31, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x54,
+0x62, 0x78, 0x50, 0x76, 0x76, 0x58, 0x77, 0x45,
+0x74, 0x76, 0x4c, 0x77, 0x56, 0x4a, 0x47, 0x73,
+0x41, 0x7a, 0x46, 0x48, 0x71, 0x73, 0x6b, 0x7a,
+0x56, 0x63, 0x48, 0x56, 0x6b, 0x53, 0x59, 0x70,
+0x6f, 0x72, 0x62, 0x63, 0x56, 0x58, 0x66, 0x6b,
+0x55, 0x53, 0x73, 0x67, 0x46, 0x65, 0x77, 0x67,
+0x45, 0x73, 0x66, 0x22, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x22, 0x32, 0x4e, 0x55, 0x44,
+0x59, 0x6b, 0x68, 0x43, 0x37, 0x64, 0x75, 0x48,
+0x7a, 0x31, 0x33, 0x67, 0x4e, 0x46, 0x78, 0x6b,
+0x77, 0x50, 0x64, 0x4c, 0x31, 0x69, 0x32, 0x55,
+0x41, 0x54, 0x44, 0x44, 0x55, 0x41, 0x67, 0x59,
+0x7a, 0x45, 0x37, 0x4c, 0x68, 0x67, 0x33, 0x56,
+0x6b, 0x4c, 0x78, 0x70, 0x43, 0x4e, 0x6b, 0x71,
+0x54, 0x68, 0x73, 0x36, 0x53, 0x52, 0x36, 0x7a,
+0x4d, 0x69, 0x69, 0x4e, 0x7a, 0x51, 0x65, 0x72,
+0x36, 0x52, 0x5a, 0x50, 0x55, 0x52, 0x71, 0x66,
+0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c,
+0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x22, 0x4c, 0x67, 0x63, 0x6f, 0x74, 0x56, 0x76,
+0x46, 0x51, 0x67, 0x47, 0x48, 0x79, 0x67, 0x44,
+0x57, 0x43, 0x6b, 0x6b, 0x79, 0x71, 0x56, 0x67,
+0x79, 0x63, 0x74, 0x47, 0x54, 0x65, 0x33, 0x70,
+0x48, 0x34, 0x47, 0x22, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x22, 0x35, 0x6d, 0x66, 0x71,
+0x6d, 0x34, 0x70, 0x67, 0x67, 0x53, 0x6b, 0x7a,
+0x32, 0x33, 0x38, 0x54, 0x6a, 0x75, 0x37, 0x6b,
+0x39, 0x55, 0x68, 0x6e, 0x48, 0x70, 0x76, 0x75,
+0x53, 0x4e, 0x62, 0x59, 0x4b, 0x63, 0x6b, 0x6d,
+0x58, 0x4b, 0x56, 0x32, 0x39, 0x4b, 0x42, 0x77,
+0x59, 0x46, 0x4e, 0x64, 0x43, 0x5a, 0x42, 0x4d,
+0x52, 0x66, 0x62, 0x61, 0x69, 0x6b, 0x56, 0x4e,
+0x79, 0x6a, 0x76, 0x7a, 0x33, 0x4d, 0x6a, 0x32,
+0x72, 0x48, 0x70, 0x59, 0x74, 0x46, 0x37, 0x77,
+0x67, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x32, 0x55, 0x34, 0x61, 0x6a, 0x6e,
+0x38, 0x41, 0x53, 0x6d, 0x59, 0x63, 0x4d, 0x34,
+0x32, 0x68, 0x44, 0x43, 0x47, 0x71, 0x69, 0x37,
+0x72, 0x46, 0x43, 0x4b, 0x75, 0x7a, 0x5a, 0x4a,
+0x37, 0x6e, 0x4e, 0x57, 0x55, 0x67, 0x6a, 0x65,
+0x52, 0x74, 0x51, 0x64, 0x72, 0x7a, 0x34, 0x6b,
+0x4b, 0x56, 0x53, 0x37, 0x74, 0x36, 0x69, 0x47,
+0x32, 0x51, 0x45, 0x45, 0x34, 0x78, 0x41, 0x42,
+0x62, 0x75, 0x6f, 0x65, 0x64, 0x7a, 0x4b, 0x34,
+0x79, 0x61, 0x37, 0x75, 0x38, 0x42, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x32,
+0x50, 0x47, 0x43, 0x45, 0x6e, 0x39, 0x6d, 0x37,
+0x56, 0x78, 0x31, 0x68, 0x63, 0x77, 0x6a, 0x5a,
+0x7a, 0x76, 0x6d, 0x36, 0x31, 0x55, 0x42, 0x66,
+0x64, 0x6d, 0x38, 0x72, 0x79, 0x6e, 0x5a, 0x63,
+0x4e, 0x62, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x32, 0x69, 0x4b, 0x63, 0x76,
+0x38, 0x48, 0x4d, 0x76, 0x56, 0x74, 0x62, 0x48,
+0x56, 0x45, 0x6d, 0x66, 0x50, 0x50, 0x70, 0x35,
+0x32, 0x41, 0x4d, 0x62, 0x6a, 0x4c, 0x51, 0x71,
+0x67, 0x76, 0x62, 0x46, 0x59, 0x74, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x75,
+0x44, 0x70, 0x67, 0x6a, 0x6d, 0x36, 0x48, 0x43,
+0x51, 0x79, 0x70, 0x4a, 0x46, 0x51, 0x63, 0x56,
+0x54, 0x6d, 0x71, 0x76, 0x35, 0x71, 0x48, 0x69,
+0x6f, 0x45, 0x68, 0x70, 0x73, 0x76, 0x5a, 0x62,
+0x31, 0x72, 0x73, 0x51, 0x58, 0x34, 0x69, 0x76,
+0x54, 0x53, 0x77, 0x45, 0x50, 0x61, 0x5a, 0x42,
+0x70, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x34, 0x4d, 0x78, 0x46, 0x31, 0x47,
+0x76, 0x51, 0x44, 0x6f, 0x6b, 0x66, 0x54, 0x63,
+0x55, 0x6d, 0x39, 0x42, 0x56, 0x66, 0x6b, 0x41,
+0x67, 0x6e, 0x55, 0x64, 0x64, 0x31, 0x51, 0x61,
+0x4d, 0x6f, 0x37, 0x6a, 0x78, 0x37, 0x7a, 0x72,
+0x62, 0x76, 0x74, 0x67, 0x34, 0x31, 0x59, 0x57,
+0x4a, 0x50, 0x65, 0x63, 0x4c, 0x22, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x63, 0x51,
+0x63, 0x79, 0x50, 0x5a, 0x36, 0x53, 0x59, 0x68,
+0x6b, 0x61, 0x75, 0x44, 0x38, 0x72, 0x79, 0x77,
+0x72, 0x71, 0x56, 0x59, 0x68, 0x6f, 0x69, 0x62,
+0x31, 0x71, 0x66, 0x4c, 0x4e, 0x37, 0x6f, 0x38,
+0x42, 0x4d, 0x6a, 0x73, 0x54, 0x46, 0x7a, 0x69,
+0x43, 0x72, 0x6d, 0x74, 0x70, 0x70, 0x47, 0x75,
+0x41, 0x77, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x35, 0x6e, 0x67, 0x42, 0x6e,
+0x71, 0x4d, 0x46, 0x35, 0x73, 0x44, 0x6d, 0x47,
+0x71, 0x61, 0x41, 0x34, 0x32, 0x46, 0x58, 0x57,
+0x75, 0x4b, 0x31, 0x54, 0x6f, 0x72, 0x6e, 0x47,
+0x54, 0x38, 0x69, 0x72, 0x54, 0x55, 0x32, 0x6a,
+0x67, 0x67, 0x63, 0x36, 0x36, 0x4e, 0x4e, 0x36,
+0x42, 0x39, 0x50, 0x77, 0x37, 0x4c, 0x48, 0x32,
+0x71, 0x67, 0x59, 0x55, 0x37, 0x4d, 0x73, 0x72,
+0x36, 0x4d, 0x4c, 0x77, 0x4e, 0x4c, 0x78, 0x70,
+0x6e, 0x4b, 0x78, 0x61, 0x69, 0x32, 0x55, 0x56,
+0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c,
+0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x22, 0x63, 0x52, 0x53, 0x55, 0x4a, 0x69, 0x42,
+0x77, 0x78, 0x53, 0x55, 0x75, 0x73, 0x77, 0x77,
+0x46, 0x57, 0x52, 0x70, 0x6b, 0x32, 0x66, 0x64,
+0x42, 0x4c, 0x4b, 0x36, 0x4b, 0x57, 0x48, 0x62,
+0x79, 0x33, 0x6d, 0x67, 0x4e, 0x79, 0x54, 0x52,
+0x54, 0x70, 0x45, 0x4d, 0x73, 0x37, 0x58, 0x4a,
+0x51, 0x33, 0x78, 0x6b, 0x62, 0x54, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x32,
+0x4b, 0x74, 0x56, 0x32, 0x33, 0x46, 0x50, 0x68,
+0x42, 0x43, 0x6d, 0x6b, 0x50, 0x59, 0x45, 0x34,
+0x33, 0x6b, 0x58, 0x66, 0x4a, 0x46, 0x6d, 0x35,
+0x62, 0x76, 0x7a, 0x47, 0x61, 0x47, 0x78, 0x45,
+0x6a, 0x35, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x32, 0x35, 0x78, 0x6d, 0x59,
+0x72, 0x77, 0x68, 0x7a, 0x63, 0x63, 0x70, 0x34,
+0x6d, 0x4b, 0x34, 0x78, 0x37, 0x44, 0x57, 0x4a,
+0x51, 0x31, 0x4b, 0x59, 0x71, 0x4b, 0x63, 0x77,
+0x36, 0x63, 0x6b, 0x73, 0x6f, 0x34, 0x54, 0x72,
+0x61, 0x4d, 0x58, 0x6e, 0x52, 0x68, 0x6e, 0x31,
+0x61, 0x69, 0x6d, 0x59, 0x46, 0x50, 0x57, 0x45,
+0x56, 0x46, 0x43, 0x67, 0x63, 0x66, 0x6a, 0x78,
+0x67, 0x57, 0x48, 0x39, 0x74, 0x42, 0x48, 0x7a,
+0x69, 0x69, 0x70, 0x76, 0x34, 0x69, 0x73, 0x45,
+0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c,
+0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x22, 0x35, 0x6d, 0x71, 0x69, 0x4a, 0x4a, 0x65,
+0x37, 0x65, 0x6a, 0x37, 0x32, 0x34, 0x35, 0x54,
+0x48, 0x68, 0x56, 0x6d, 0x79, 0x68, 0x46, 0x75,
+0x4e, 0x65, 0x6b, 0x68, 0x43, 0x4a, 0x6b, 0x6f,
+0x74, 0x56, 0x70, 0x65, 0x75, 0x51, 0x76, 0x73,
+0x74, 0x52, 0x4b, 0x44, 0x64, 0x57, 0x38, 0x77,
+0x59, 0x55, 0x64, 0x71, 0x5a, 0x46, 0x79, 0x50,
+0x52, 0x71, 0x46, 0x50, 0x75, 0x65, 0x6e, 0x37,
+0x41, 0x45, 0x61, 0x53, 0x75, 0x36, 0x39, 0x41,
+0x69, 0x45, 0x7a, 0x59, 0x4a, 0x70, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x63,
+0x4e, 0x36, 0x45, 0x45, 0x75, 0x56, 0x76, 0x4b,
+0x61, 0x75, 0x62, 0x65, 0x71, 0x69, 0x71, 0x56,
+0x66, 0x44, 0x53, 0x79, 0x47, 0x41, 0x37, 0x32,
+0x55, 0x6f, 0x5a, 0x38, 0x6a, 0x38, 0x4b, 0x50,
+0x50, 0x52, 0x61, 0x68, 0x51, 0x35, 0x37, 0x6a,
+0x78, 0x75, 0x79, 0x42, 0x4d, 0x64, 0x61, 0x54,
+0x31, 0x39, 0x76, 0x52, 0x22, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x22, 0x77, 0x56, 0x77,
+0x66, 0x47, 0x4e, 0x61, 0x39, 0x42, 0x6b, 0x59,
+0x4b, 0x73, 0x65, 0x42, 0x7a, 0x72, 0x37, 0x56,
+0x62, 0x34, 0x35, 0x38, 0x62, 0x5a, 0x71, 0x54,
+0x58, 0x4d, 0x51, 0x4c, 0x39, 0x34, 0x56, 0x22,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
+0x48, 0x66, 0x4c, 0x50, 0x4a, 0x31, 0x65, 0x4c,
+0x38, 0x4b, 0x47, 0x4d, 0x68, 0x6d, 0x48, 0x58,
+0x53, 0x70, 0x74, 0x4a, 0x6e, 0x53, 0x65, 0x34,
+0x6f, 0x42, 0x6d, 0x58, 0x7a, 0x4d, 0x5a, 0x31,
+0x50, 0x66, 0x76, 0x6e, 0x4b, 0x57, 0x65, 0x77,
+0x42, 0x64, 0x76, 0x39, 0x76, 0x68, 0x45, 0x69,
+0x53, 0x56, 0x6d, 0x65, 0x76, 0x4b, 0x6a, 0x67,
+0x77, 0x48, 0x66, 0x66, 0x4c, 0x39, 0x6f, 0x4d,
+0x32, 0x34, 0x59, 0x4e, 0x41, 0x6a, 0x35, 0x7a,
+0x41, 0x61, 0x75, 0x22, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x22, 0x59, 0x6b, 0x35, 0x42,
+0x36, 0x4d, 0x52, 0x72, 0x6f, 0x31, 0x59, 0x45,
+0x61, 0x79, 0x36, 0x43, 0x69, 0x58, 0x31, 0x51,
+0x6a, 0x38, 0x71, 0x48, 0x59, 0x31, 0x52, 0x35,
+0x6f, 0x33, 0x63, 0x34, 0x45, 0x73, 0x58, 0x4e,
+0x36, 0x34, 0x34, 0x45, 0x41, 0x6d, 0x6a, 0x42,
+0x32, 0x4a, 0x4d, 0x72, 0x67, 0x65, 0x78, 0x35,
+0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c,
+0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x22, 0x4c, 0x62, 0x57, 0x35, 0x4a, 0x45, 0x61,
+0x56, 0x57, 0x4d, 0x4c, 0x75, 0x4d, 0x65, 0x69,
+0x52, 0x68, 0x55, 0x51, 0x33, 0x76, 0x6d, 0x50,
+0x7a, 0x7a, 0x7a, 0x51, 0x38, 0x73, 0x67, 0x58,
+0x54, 0x46, 0x6d, 0x65, 0x22, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x22, 0x46, 0x77, 0x56,
+0x53, 0x34, 0x58, 0x79, 0x32, 0x4b, 0x55, 0x45,
+0x79, 0x70, 0x46, 0x37, 0x36, 0x69, 0x39, 0x6e,
+0x35, 0x64, 0x6b, 0x4b, 0x76, 0x55, 0x4d, 0x31,
+0x59, 0x6a, 0x62, 0x79, 0x52, 0x59, 0x4a, 0x22,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
+0x54, 0x33, 0x58, 0x65, 0x37, 0x68, 0x55, 0x36,
+0x63, 0x67, 0x42, 0x76, 0x65, 0x46, 0x69, 0x6e,
+0x4c, 0x56, 0x34, 0x35, 0x53, 0x45, 0x38, 0x57,
+0x48, 0x54, 0x31, 0x61, 0x4a, 0x36, 0x78, 0x45,
+0x42, 0x58, 0x6b, 0x79, 0x41, 0x71, 0x41, 0x74,
+0x6a, 0x34, 0x43, 0x71, 0x66, 0x4b, 0x50, 0x62,
+0x33, 0x5a, 0x45, 0x47, 0x22, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x22, 0x4d, 0x38, 0x4c,
+0x48, 0x39, 0x69, 0x43, 0x4a, 0x42, 0x54, 0x7a,
+0x67, 0x53, 0x6a, 0x54, 0x45, 0x35, 0x79, 0x38,
+0x52, 0x74, 0x53, 0x4c, 0x6f, 0x33, 0x76, 0x61,
+0x62, 0x53, 0x76, 0x36, 0x52, 0x57, 0x6a, 0x4c,
+0x72, 0x35, 0x34, 0x70, 0x5a, 0x48, 0x71, 0x58,
+0x5a, 0x43, 0x42, 0x4a, 0x74, 0x6b, 0x45, 0x62,
+0x56, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x4a, 0x4b, 0x41, 0x73, 0x67, 0x6f,
+0x65, 0x35, 0x52, 0x52, 0x57, 0x44, 0x46, 0x72,
+0x75, 0x65, 0x72, 0x77, 0x7a, 0x32, 0x54, 0x56,
+0x45, 0x69, 0x66, 0x6e, 0x47, 0x4c, 0x6b, 0x48,
+0x6b, 0x4d, 0x69, 0x57, 0x6b, 0x4a, 0x7a, 0x6d,
+0x39, 0x59, 0x31, 0x4b, 0x6b, 0x44, 0x70, 0x4d,
+0x58, 0x57, 0x32, 0x6e, 0x73, 0x73, 0x64, 0x79,
+0x58, 0x61, 0x48, 0x66, 0x51, 0x7a, 0x50, 0x6f,
+0x78, 0x71, 0x76, 0x61, 0x7a, 0x70, 0x54, 0x45,
+0x6d, 0x52, 0x50, 0x65, 0x36, 0x22, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x37, 0x73,
+0x54, 0x70, 0x34, 0x78, 0x55, 0x75, 0x4e, 0x52,
+0x74, 0x61, 0x34, 0x62, 0x61, 0x56, 0x44, 0x48,
+0x66, 0x39, 0x36, 0x6e, 0x37, 0x66, 0x71, 0x62,
+0x61, 0x32, 0x4e, 0x4a, 0x31, 0x44, 0x6a, 0x41,
+0x6e, 0x59, 0x58, 0x59, 0x73, 0x77, 0x45, 0x68,
+0x31, 0x78, 0x6d, 0x38, 0x68, 0x62, 0x5a, 0x4a,
+0x46, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x63, 0x55, 0x53, 0x78, 0x64, 0x52,
+0x4a, 0x77, 0x70, 0x45, 0x50, 0x38, 0x63, 0x7a,
+0x58, 0x54, 0x4c, 0x50, 0x53, 0x58, 0x50, 0x4e,
+0x59, 0x41, 0x42, 0x37, 0x35, 0x78, 0x79, 0x46,
+0x69, 0x37, 0x41, 0x59, 0x77, 0x63, 0x37, 0x61,
+0x7a, 0x50, 0x76, 0x47, 0x71, 0x51, 0x4c, 0x63,
+0x79, 0x45, 0x62, 0x37, 0x6a, 0x71, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x4a,
+0x4b, 0x53, 0x6e, 0x78, 0x42, 0x34, 0x33, 0x6f,
+0x67, 0x4e, 0x4e, 0x50, 0x57, 0x39, 0x46, 0x32,
+0x37, 0x64, 0x38, 0x61, 0x6d, 0x77, 0x50, 0x57,
+0x69, 0x6d, 0x64, 0x52, 0x4c, 0x47, 0x39, 0x35,
+0x45, 0x55, 0x43, 0x69, 0x53, 0x72, 0x46, 0x4a,
+0x79, 0x62, 0x66, 0x78, 0x56, 0x46, 0x50, 0x55,
+0x6a, 0x42, 0x46, 0x5a, 0x46, 0x64, 0x65, 0x47,
+0x64, 0x6a, 0x7a, 0x42, 0x79, 0x67, 0x58, 0x43,
+0x69, 0x37, 0x72, 0x69, 0x6e, 0x76, 0x53, 0x36,
+0x52, 0x7a, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x74, 0x4a, 0x67, 0x57, 0x63,
+0x4a, 0x38, 0x46, 0x71, 0x47, 0x57, 0x57, 0x75,
+0x58, 0x36, 0x44, 0x47, 0x65, 0x4d, 0x78, 0x6e,
+0x43, 0x4b, 0x6a, 0x66, 0x68, 0x6d, 0x32, 0x6f,
+0x73, 0x54, 0x75, 0x36, 0x51, 0x22, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x32, 0x55,
+0x44, 0x6e, 0x68, 0x5a, 0x47, 0x66, 0x75, 0x48,
+0x7a, 0x41, 0x4b, 0x64, 0x34, 0x48, 0x53, 0x6f,
+0x39, 0x39, 0x41, 0x4c, 0x72, 0x56, 0x61, 0x78,
+0x35, 0x54, 0x67, 0x4b, 0x78, 0x7a, 0x41, 0x4c,
+0x4a, 0x52, 0x31, 0x43, 0x74, 0x33, 0x36, 0x69,
+0x62, 0x72, 0x5a, 0x71, 0x58, 0x73, 0x6e, 0x77,
+0x52, 0x42, 0x73, 0x56, 0x76, 0x4b, 0x6e, 0x65,
+0x44, 0x59, 0x57, 0x78, 0x69, 0x51, 0x6a, 0x63,
+0x70, 0x6e, 0x51, 0x33, 0x4e, 0x57, 0x4b, 0x32,
+0x61, 0x73, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x4a, 0x43, 0x4b, 0x34, 0x4b,
+0x78, 0x33, 0x4c, 0x36, 0x5a, 0x62, 0x48, 0x6b,
+0x53, 0x4a, 0x77, 0x50, 0x59, 0x4a, 0x50, 0x69,
+0x6a, 0x4b, 0x36, 0x53, 0x4e, 0x67, 0x51, 0x44,
+0x75, 0x74, 0x62, 0x74, 0x45, 0x34, 0x58, 0x41,
+0x78, 0x67, 0x54, 0x46, 0x67, 0x46, 0x57, 0x6d,
+0x46, 0x78, 0x31, 0x77, 0x39, 0x37, 0x58, 0x63,
+0x7a, 0x66, 0x4b, 0x70, 0x74, 0x6a, 0x5a, 0x4b,
+0x6e, 0x33, 0x54, 0x48, 0x6f, 0x73, 0x6f, 0x5a,
+0x32, 0x6b, 0x38, 0x31, 0x6d, 0x62, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x41,
+0x62, 0x6e, 0x58, 0x75, 0x31, 0x52, 0x67, 0x61,
+0x65, 0x6d, 0x7a, 0x76, 0x62, 0x67, 0x31, 0x74,
+0x56, 0x67, 0x54, 0x42, 0x6a, 0x61, 0x68, 0x31,
+0x6f, 0x77, 0x75, 0x62, 0x57, 0x50, 0x6b, 0x46,
+0x5a, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x39, 0x32, 0x38, 0x77, 0x63, 0x7a,
+0x38, 0x55, 0x61, 0x58, 0x59, 0x33, 0x74, 0x48,
+0x6d, 0x65, 0x73, 0x65, 0x75, 0x46, 0x41, 0x66,
+0x59, 0x4c, 0x4e, 0x53, 0x42, 0x6a, 0x72, 0x73,
+0x38, 0x6a, 0x64, 0x78, 0x4b, 0x52, 0x47, 0x6b,
+0x4a, 0x47, 0x6b, 0x35, 0x57, 0x79, 0x78, 0x32,
+0x43, 0x76, 0x68, 0x6d, 0x6b, 0x50, 0x7a, 0x54,
+0x72, 0x50, 0x4b, 0x70, 0x6f, 0x72, 0x78, 0x41,
+0x4b, 0x71, 0x4c, 0x73, 0x39, 0x62, 0x41, 0x68,
+0x32, 0x39, 0x42, 0x74, 0x62, 0x22, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x51, 0x70,
+0x37, 0x45, 0x79, 0x75, 0x57, 0x75, 0x65, 0x67,
+0x34, 0x63, 0x61, 0x7a, 0x42, 0x74, 0x4a, 0x57,
+0x33, 0x75, 0x59, 0x4b, 0x77, 0x4c, 0x6d, 0x4c,
+0x31, 0x75, 0x52, 0x33, 0x50, 0x6b, 0x67, 0x44,
+0x56, 0x6f, 0x42, 0x73, 0x47, 0x53, 0x4d, 0x5a,
+0x57, 0x75, 0x31, 0x6e, 0x6a, 0x63, 0x52, 0x52,
+0x4a, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x36, 0x52, 0x39, 0x72, 0x35, 0x52,
+0x48, 0x51, 0x64, 0x4e, 0x36, 0x46, 0x67, 0x6b,
+0x39, 0x4b, 0x32, 0x50, 0x48, 0x53, 0x78, 0x31,
+0x73, 0x58, 0x4b, 0x70, 0x6b, 0x38, 0x51, 0x73,
+0x6b, 0x64, 0x79, 0x7a, 0x58, 0x74, 0x43, 0x53,
+0x4e, 0x41, 0x66, 0x4a, 0x6d, 0x65, 0x68, 0x59,
+0x39, 0x44, 0x44, 0x31, 0x44, 0x64, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x32,
+0x37, 0x31, 0x54, 0x39, 0x68, 0x47, 0x50, 0x53,
+0x65, 0x50, 0x39, 0x51, 0x52, 0x54, 0x62, 0x37,
+0x67, 0x35, 0x74, 0x52, 0x5a, 0x59, 0x54, 0x37,
+0x41, 0x44, 0x62, 0x4a, 0x68, 0x69, 0x76, 0x46,
+0x62, 0x36, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x32, 0x78, 0x37, 0x57, 0x6a,
+0x41, 0x54, 0x53, 0x63, 0x67, 0x63, 0x53, 0x48,
+0x4e, 0x70, 0x47, 0x4d, 0x47, 0x7a, 0x38, 0x54,
+0x4b, 0x4b, 0x53, 0x32, 0x67, 0x32, 0x45, 0x37,
+0x51, 0x6b, 0x67, 0x39, 0x78, 0x33, 0x43, 0x4d,
+0x75, 0x47, 0x78, 0x78, 0x43, 0x44, 0x43, 0x48,
+0x79, 0x31, 0x72, 0x51, 0x72, 0x31, 0x52, 0x46,
+0x45, 0x6a, 0x64, 0x6a, 0x50, 0x36, 0x4c, 0x77,
+0x36, 0x71, 0x6b, 0x73, 0x47, 0x4a, 0x4c, 0x63,
+0x70, 0x37, 0x69, 0x36, 0x55, 0x36, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x32,
+0x6a, 0x77, 0x55, 0x61, 0x50, 0x64, 0x42, 0x39,
+0x33, 0x70, 0x78, 0x57, 0x35, 0x64, 0x4a, 0x70,
+0x6f, 0x47, 0x6a, 0x71, 0x33, 0x52, 0x43, 0x4b,
+0x79, 0x42, 0x45, 0x71, 0x54, 0x71, 0x66, 0x63,
+0x71, 0x33, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20,
+0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x22, 0x37, 0x56, 0x6b, 0x4a, 0x46,
+0x4a, 0x77, 0x67, 0x74, 0x54, 0x61, 0x71, 0x43,
+0x58, 0x6b, 0x73, 0x38, 0x4a, 0x72, 0x78, 0x75,
+0x4a, 0x45, 0x6b, 0x45, 0x6f, 0x44, 0x47, 0x47,
+0x55, 0x72, 0x47, 0x51, 0x42, 0x42, 0x55, 0x70,
+0x32, 0x53, 0x56, 0x77, 0x62, 0x39, 0x33, 0x55,
+0x57, 0x41, 0x51, 0x36, 0x64, 0x33, 0x6b, 0x59,
+0x4b, 0x38, 0x79, 0x33, 0x75, 0x31, 0x43, 0x51,
+0x4b, 0x5a, 0x69, 0x36, 0x66, 0x38, 0x66, 0x5a,
+0x57, 0x43, 0x6f, 0x44, 0x70, 0x72, 0x33, 0x70,
+0x50, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x54, 0x34, 0x55, 0x56, 0x51, 0x51,
+0x53, 0x42, 0x4a, 0x64, 0x52, 0x56, 0x6b, 0x4e,
+0x76, 0x67, 0x4e, 0x78, 0x6b, 0x6d, 0x63, 0x50,
+0x39, 0x6d, 0x56, 0x74, 0x57, 0x6f, 0x42, 0x4c,
+0x57, 0x71, 0x6d, 0x7a, 0x5a, 0x6f, 0x31, 0x54,
+0x38, 0x5a, 0x39, 0x47, 0x44, 0x4e, 0x50, 0x59,
+0x6a, 0x36, 0x72, 0x56, 0x31, 0x73, 0x22, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a,
+0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x32,
+0x55, 0x41, 0x33, 0x77, 0x4c, 0x31, 0x4b, 0x47,
+0x68, 0x4e, 0x68, 0x32, 0x55, 0x52, 0x32, 0x48,
+0x59, 0x52, 0x50, 0x56, 0x67, 0x4a, 0x39, 0x44,
+0x78, 0x33, 0x32, 0x71, 0x45, 0x47, 0x61, 0x70,
+0x65, 0x50, 0x69, 0x38, 0x77, 0x70, 0x31, 0x53,
+0x5a, 0x39, 0x55, 0x6d, 0x54, 0x43, 0x48, 0x56,
+0x35, 0x66, 0x6b, 0x75, 0x64, 0x4d, 0x41, 0x32,
+0x43, 0x5a, 0x37, 0x38, 0x74, 0x37, 0x4b, 0x4b,
+0x44, 0x41, 0x51, 0x57, 0x74, 0x4e, 0x42, 0x33,
+0x50, 0x46, 0x63, 0x22, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x22, 0x67, 0x63, 0x42, 0x73,
+0x74, 0x4d, 0x5a, 0x53, 0x39, 0x6d, 0x4b, 0x52,
+0x58, 0x65, 0x47, 0x69, 0x59, 0x51, 0x4a, 0x35,
+0x76, 0x47, 0x32, 0x75, 0x6b, 0x69, 0x45, 0x4b,
+0x52, 0x69, 0x72, 0x78, 0x73, 0x6b, 0x43, 0x45,
+0x71, 0x5a, 0x36, 0x72, 0x6d, 0x46, 0x77, 0x57,
+0x75, 0x68, 0x32, 0x6b, 0x79, 0x4e, 0x78, 0x77,
+0x71, 0x73, 0x64, 0x36, 0x70, 0x6e, 0x64, 0x75,
+0x45, 0x64, 0x56, 0x37, 0x5a, 0x76, 0x76, 0x6b,
+0x67, 0x63, 0x75, 0x39, 0x56, 0x4b, 0x74, 0x22,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x22,
+0x35, 0x6d, 0x71, 0x4b, 0x74, 0x53, 0x5a, 0x47,
+0x6a, 0x33, 0x62, 0x48, 0x74, 0x4d, 0x67, 0x6d,
+0x53, 0x44, 0x62, 0x74, 0x39, 0x51, 0x6d, 0x70,
+0x39, 0x4e, 0x6e, 0x51, 0x38, 0x45, 0x43, 0x6e,
+0x59, 0x51, 0x38, 0x62, 0x35, 0x34, 0x65, 0x4a,
+0x4b, 0x45, 0x52, 0x77, 0x35, 0x73, 0x74, 0x47,
+0x43, 0x54, 0x5a, 0x34, 0x32, 0x45, 0x43, 0x56,
+0x78, 0x65, 0x54, 0x57, 0x55, 0x31, 0x4a, 0x54,
+0x43, 0x39, 0x6f, 0x38, 0x54, 0x65, 0x77, 0x65,
+0x34, 0x57, 0x78, 0x45, 0x57, 0x22, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5d, 0x2c, 0x20, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5b, 0x0a, 0x20, 0x20, 0x20,
+0x20, 0x20, 0x20, 0x20, 0x20, 0x22, 0x33, 0x31,
+0x71, 0x39, 0x41, 0x4b, 0x76, 0x73, 0x64, 0x77,
+0x75, 0x53, 0x50, 0x32, 0x7a, 0x6e, 0x42, 0x52,
+0x4d, 0x4c, 0x75, 0x67, 0x71, 0x41, 0x4c, 0x78,
+0x51, 0x31, 0x61, 0x53, 0x66, 0x41, 0x71, 0x57,
+0x62, 0x54, 0x31, 0x67, 0x79, 0x53, 0x31, 0x74,
+0x73, 0x6a, 0x46, 0x46, 0x6a, 0x32, 0x5a, 0x5a,
+0x4d, 0x53, 0x47, 0x41, 0x45, 0x45, 0x31, 0x6b,
+0x79, 0x46, 0x73, 0x43, 0x36, 0x48, 0x36, 0x66,
+0x79, 0x37, 0x76, 0x36, 0x79, 0x54, 0x54, 0x74,
+0x62, 0x22, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5d,
+0x2c, 0x20, 0x0a, 0x20, 0x20, 0x20, 0x20, 0x5b,
+0x0a, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
+0x20, 0x22, 0x33, 0x35, 0x59, 0x68, 0x53, 0x77,
+0x7a, 0x62, 0x4a, 0x4d, 0x45, 0x43, 0x61, 0x6b,
+0x71, 0x39, 0x48, 0x31, 0x53, 0x69, 0x47, 0x63,
+0x51, 0x6d, 0x4d, 0x79, 0x63, 0x6b, 0x44, 0x35,
+0x41, 0x36, 0x6e, 0x44, 0x6b, 0x6b, 0x32, 0x74,
+0x4d, 0x4d, 0x46, 0x43, 0x62, 0x79, 0x56, 0x6a,
+0x70, 0x4c, 0x37, 0x61, 0x56, 0x22, 0x0a, 0x20,
+0x20, 0x20, 0x20, 0x5d, 0x0a, 0x5d, 0x0a,
+};};
@@ -0,0 +1,96 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "arith_uint256.h"
+#include "base58.h"
+#include "chainparams.h"
+#include "miner.h"
+#include "pow.h"
+#include "rpc/mining.h"
+#include "rpc/server.h"
+#include "test/test_bitcoin.h"
+#include "util.h"
+#include "utilstrencodings.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+extern UniValue CallRPC(std::string args);
+
+BOOST_FIXTURE_TEST_SUITE(generate_tests, TestingSetup)
+
+static CBlockHeader MakeHeader(const arith_uint256& bnTarget)
+{
+    CBlockHeader header;
+    {
+        LOCK(cs_main);
+        header.hashPrevBlock = chainActive.Tip()->GetBlockHash();
+    }
+    header.hashMerkleRoot = InsecureRand256();
+    header.nTime = GetTime();
+    header.nBits = bnTarget.GetCompact();
+    return header;
+}
+
+BOOST_AUTO_TEST_CASE(scan_nonces_parallel)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+    StartRPC();
+
+    // Found by one of the threads, with the tries spent deducted
+    CBlockHeader header = MakeHeader(UintToArith256(params.powLimit) >> 4);
+    uint64_t nMaxTries = 1 << 20;
+    BOOST_CHECK(ScanNoncesParallel(&header, 4, nMaxTries));
+    BOOST_CHECK(CheckProofOfWork(header.GetPoWHash(), header.nBits, params));
+    BOOST_CHECK(nMaxTries < (1 << 20));
+
+    // The threads together stop at nMaxTries
+    header = MakeHeader(UintToArith256(params.powLimit) >> 64);
+    nMaxTries = 100;
+    BOOST_CHECK(!ScanNoncesParallel(&header, 4, nMaxTries));
+    BOOST_CHECK_EQUAL(nMaxTries, 0U);
+
+    // A block that does not build on the tip is not searched
+    header.hashPrevBlock = InsecureRand256();
+    nMaxTries = 1 << 20;
+    BOOST_CHECK(!ScanNoncesParallel(&header, 4, nMaxTries));
+
+    // Nor is anything once RPC is shutting down
+    InterruptRPC();
+    header = MakeHeader(UintToArith256(params.powLimit) >> 64);
+    nMaxTries = 1 << 30;
+    BOOST_CHECK(!ScanNoncesParallel(&header, 4, nMaxTries));
+    BOOST_CHECK(nMaxTries > 0);
+    StopRPC();
+}
+
+BOOST_AUTO_TEST_CASE(generate_genproclimit)
+{
+    const std::string strAddress = CBitcoinAddress(CKeyID(uint160(ParseHex("0102030405060708090a0b0c0d0e0f1011121314")))).ToString();
+    gArgs.ForceSetArg("-genproclimit", "4");
+    StartRPC();
+
+    int nHeight;
+    {
+        LOCK(cs_main);
+        nHeight = chainActive.Height();
+    }
+    UniValue r = CallRPC("generatetoaddress 3 " + strAddress);
+    BOOST_CHECK_EQUAL(r.size(), 3U);
+    {
+        LOCK(cs_main);
+        BOOST_CHECK_EQUAL(chainActive.Height(), nHeight + 3);
+        BOOST_CHECK_EQUAL(chainActive.Tip()->GetBlockHash().GetHex(), r[2].get_str());
+    }
+
+    // Once RPC is shutting down, generating gives up instead of looping
+    InterruptRPC();
+    BOOST_CHECK_THROW(CallRPC("generatetoaddress 1 " + strAddress), std::runtime_error);
+    StopRPC();
+    gArgs.ForceSetArg("-genproclimit", std::to_string(DEFAULT_GENERATE_THREADS));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
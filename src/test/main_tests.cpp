@@ -2,12 +2,17 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "arith_uint256.h"
+#include "auxpow/auxpow.h"
 #include "chainparams.h"
+#include "pow.h"
 #include "validation.h"
 #include "net.h"
 
 #include "test/test_bitcoin.h"
 
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
 #include <boost/signals2/signal.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -80,6 +85,50 @@ BOOST_AUTO_TEST_CASE(subsidy_limit_test)
     BOOST_CHECK_EQUAL(nSum, 988300000000000ULL);
 }
 
+/** GetBlockSubsidy as it was before superblocks were memoized: mt19937 seeded per height. */
+static CAmount BlockSubsidyReference(int nHeight, const Consensus::Params& consensusParams)
+{
+    CAmount nSubsidy = 100 * COIN;
+    int halvings = nHeight / consensusParams.nSubsidyHalvingInterval;
+    if (halvings >= 64)
+        return 0;
+    if (nHeight < 3) {
+        nSubsidy = 1000000 * COIN;
+    } else if (nHeight < 5001) {
+        nSubsidy = 200 * COIN;
+    }
+    boost::mt19937 gen(nHeight);
+    boost::uniform_int<> dist(1, 100000);
+    int rand = dist(gen);
+    if (rand > 99990) {
+        nSubsidy *= 50;
+    } else if (rand < 2001) {
+        nSubsidy *= 5;
+    }
+    nSubsidy >>= halvings;
+    return nSubsidy;
+}
+
+BOOST_AUTO_TEST_CASE(superblock_subsidy_test)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& consensusParams = chainParams->GetConsensus();
+    const int nEnd = 64 * consensusParams.nSubsidyHalvingInterval;
+
+    for (int nHeight = 0; nHeight < 100000; nHeight++) {
+        BOOST_REQUIRE_EQUAL(GetBlockSubsidy(nHeight, consensusParams), BlockSubsidyReference(nHeight, consensusParams));
+    }
+    // Spread over every halving
+    for (int nHeight = 100000; nHeight <= nEnd; nHeight += 99991) {
+        BOOST_REQUIRE_EQUAL(GetBlockSubsidy(nHeight, consensusParams), BlockSubsidyReference(nHeight, consensusParams));
+    }
+    // Heights whose first mt19937 output is rejected by uniform_int and drawn again
+    for (int nHeight : {120249, 131651, 176754}) {
+        BOOST_CHECK_EQUAL(GetBlockSubsidy(nHeight, consensusParams), BlockSubsidyReference(nHeight, consensusParams));
+    }
+    BOOST_CHECK_EQUAL(GetBlockSubsidy(nEnd, consensusParams), 0);
+}
+
 bool ReturnFalse() { return false; }
 bool ReturnTrue() { return true; }
 
@@ -96,4 +145,105 @@ BOOST_AUTO_TEST_CASE(test_combiner_all)
     Test.disconnect(&ReturnTrue);
     BOOST_CHECK(Test());
 }
+
+BOOST_AUTO_TEST_CASE(read_raw_block)
+{
+    const CChainParams& chainparams = Params();
+    CDiskBlockPos pos;
+    uint256 hash;
+    {
+        LOCK(cs_main);
+        pos = chainActive.Genesis()->GetBlockPos();
+        hash = chainActive.Genesis()->GetBlockHash();
+    }
+
+    // The stored bytes are the block's witness serialization
+    CBlock block;
+    BOOST_CHECK(ReadBlockFromDisk(block, pos, hash, chainparams.GetConsensus()));
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << block;
+    std::vector<unsigned char> vRaw;
+    BOOST_CHECK(ReadRawBlockFromDisk(vRaw, pos, hash, chainparams.MessageStart(), chainparams.GetConsensus()));
+    BOOST_CHECK(vRaw == std::vector<unsigned char>(ss.begin(), ss.end()));
+
+    // Wrong hash, wrong network magic and a position without an index header fail
+    BOOST_CHECK(!ReadRawBlockFromDisk(vRaw, pos, uint256S("0x01"), chainparams.MessageStart(), chainparams.GetConsensus()));
+    CMessageHeader::MessageStartChars otherStart = {0x01, 0x02, 0x03, 0x04};
+    BOOST_CHECK(!ReadRawBlockFromDisk(vRaw, pos, hash, otherStart, chainparams.GetConsensus()));
+    CDiskBlockPos posBad = pos;
+    posBad.nPos = 4;
+    BOOST_CHECK(!ReadRawBlockFromDisk(vRaw, posBad, hash, chainparams.MessageStart(), chainparams.GetConsensus()));
+}
+
+BOOST_AUTO_TEST_CASE(read_auxpow_block)
+{
+    const Consensus::Params& params = Params().GetConsensus();
+
+    // A merge-mined block whose parent coinbase commits to it directly
+    CBlock block;
+    block.nVersion = AuxPow::BLOCK_VERSION_AUXPOW | (1 * AuxPow::BLOCK_VERSION_CHAIN_START);
+    block.hashPrevBlock = InsecureRand256();
+    block.nBits = UintToArith256(params.powLimit).GetCompact();
+    const uint256 hash = block.GetHash();
+    std::vector<unsigned char> vchRootHash(hash.begin(), hash.end());
+    std::reverse(vchRootHash.begin(), vchRootHash.end());
+    CMutableTransaction coinbase;
+    coinbase.vin.resize(1);
+    // Merged mining header, chain merkle root, tree size 1 and nonce 0
+    const unsigned char vchHeader[] = {0xfa, 0xbe, 'm', 'm'};
+    const unsigned char vchSizeNonce[] = {1, 0, 0, 0, 0, 0, 0, 0};
+    CScript& scriptSig = coinbase.vin[0].scriptSig;
+    scriptSig = CScript() << OP_0;
+    scriptSig.insert(scriptSig.end(), vchHeader, vchHeader + sizeof(vchHeader));
+    scriptSig.insert(scriptSig.end(), vchRootHash.begin(), vchRootHash.end());
+    scriptSig.insert(scriptSig.end(), vchSizeNonce, vchSizeNonce + sizeof(vchSizeNonce));
+    coinbase.vout.resize(1);
+    CAuxPow* auxpow = new CAuxPow();
+    auxpow->SetTx(MakeTransactionRef(std::move(coinbase)));
+    auxpow->nIndex = 0;
+    auxpow->nChainIndex = 0;
+    auxpow->parentBlockHeader.nVersion = 1;
+    auxpow->parentBlockHeader.hashMerkleRoot = auxpow->GetHash();
+    auxpow->parentBlockHeader.nBits = block.nBits;
+    while (!CheckProofOfWork(auxpow->parentBlockHeader.GetPoWHash(), block.nBits, params))
+        auxpow->parentBlockHeader.nNonce++;
+    block.SetAuxPow(auxpow);
+    BOOST_CHECK(block.GetHash() == hash);
+    BOOST_CHECK(CheckBlockProofOfWork(&block, params));
+
+    // Written to a block file of its own behind an index header, as
+    // WriteBlockToDisk would
+    const CMessageHeader::MessageStartChars& messageStart = Params().MessageStart();
+    const uint256 hashBlock = hash;
+    CBlockIndex index;
+    index.phashBlock = &hashBlock;
+    index.nStatus = BLOCK_HAVE_DATA;
+    index.nFile = 99;
+    index.nDataPos = CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int);
+    auto WriteBlock = [&] {
+        CDiskBlockPos pos = index.GetBlockPos();
+        pos.nPos = 0;
+        CAutoFile fileout(OpenBlockFile(pos), SER_DISK, CLIENT_VERSION);
+        BOOST_REQUIRE(!fileout.IsNull());
+        fileout << FLATDATA(messageStart) << (unsigned int)GetSerializeSize(fileout, block) << block;
+    };
+    WriteBlock();
+    CBlock blockRead;
+    BOOST_CHECK(ReadBlockFromDisk(blockRead, &index, params));
+    BOOST_CHECK(blockRead.auxpow && blockRead.auxpow->parentBlockHeader.nNonce == auxpow->parentBlockHeader.nNonce);
+    BOOST_CHECK(ReadBlockFromDisk(blockRead, index.GetBlockPos(), hash, params));
+    std::vector<unsigned char> vRaw;
+    BOOST_CHECK(ReadRawBlockFromDisk(vRaw, index.GetBlockPos(), hash, messageStart, params));
+
+    // The block hash does not cover the auxpow, so an auxpow corrupted on disk
+    // still matches the index but is caught
+    auxpow->parentBlockHeader.hashMerkleRoot = InsecureRand256();
+    BOOST_CHECK(block.GetHash() == hash);
+    WriteBlock();
+    BOOST_CHECK(!ReadBlockFromDisk(blockRead, &index, params));
+    // The reads that serve blocks to peers check it too
+    BOOST_CHECK(!ReadBlockFromDisk(blockRead, index.GetBlockPos(), hash, params));
+    BOOST_CHECK(!ReadRawBlockFromDisk(vRaw, index.GetBlockPos(), hash, messageStart, params));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
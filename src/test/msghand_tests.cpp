@@ -0,0 +1,294 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "hash.h"
+#include "net.h"
+#include "net_processing.h"
+#include "netmessagemaker.h"
+#include "protocol.h"
+#include "streams.h"
+#include "test/test_bitcoin.h"
+#include "utiltime.h"
+#include "validation.h"
+
+#include <future>
+#include <map>
+#include <set>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(msghand_tests, TestingSetup)
+
+/** Records which thread processed each node's messages. */
+class ThreadRecorder : public NetEventsInterface
+{
+public:
+    std::mutex mutex;
+    std::map<NodeId, std::multiset<std::thread::id> > mapThreads;
+
+    bool ProcessMessages(CNode* pnode, std::atomic<bool>& interrupt) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        mapThreads[pnode->GetId()].insert(std::this_thread::get_id());
+        return false;
+    }
+    bool SendMessages(CNode* pnode, std::atomic<bool>& interrupt) override { return false; }
+    void InitializeNode(CNode* pnode) override {}
+    void FinalizeNode(NodeId id, bool& update_connection_time) override {}
+};
+
+static CAddress TestAddress()
+{
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    return CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+}
+
+BOOST_AUTO_TEST_CASE(msghand_node_pinned)
+{
+    const int nThreads = 3;
+    const int nNodes = 8;
+    ThreadRecorder recorder;
+    CConnman connman(0x1337, 0x1337);
+    CConnman::Options options;
+    options.m_msgproc = &recorder;
+    options.nMessageHandlerThreads = nThreads;
+    connman.Init(options);
+    // The connman deletes its nodes when it stops
+    for (int i = 0; i < nNodes; i++)
+        CConnmanTest::AddNode(connman, *new CNode(i, NODE_NETWORK, 0, INVALID_SOCKET, TestAddress(), 0, 0, CAddress(), "", true));
+    CConnmanTest::StartMessageHandlers(connman, nThreads);
+
+    // Handlers also go round every 100ms without being woken
+    for (int n = 0; n < 1000; n++) {
+        connman.WakeMessageHandler();
+        {
+            std::lock_guard<std::mutex> lock(recorder.mutex);
+            bool fDone = (int)recorder.mapThreads.size() == nNodes;
+            for (const auto& entry : recorder.mapThreads)
+                fDone &= entry.second.size() >= 5;
+            if (fDone)
+                break;
+        }
+        MilliSleep(10);
+    }
+    connman.Interrupt();
+    connman.Stop();
+
+    // Every node is served by a single thread, the one for GetId() % n
+    BOOST_REQUIRE_EQUAL(recorder.mapThreads.size(), (size_t)nNodes);
+    std::map<int, std::thread::id> mapWorkerThread;
+    for (const auto& entry : recorder.mapThreads) {
+        const std::thread::id id = *entry.second.begin();
+        BOOST_CHECK_EQUAL(entry.second.count(id), entry.second.size());
+        auto it = mapWorkerThread.emplace(entry.first % nThreads, id).first;
+        BOOST_CHECK(it->second == id);
+    }
+    BOOST_CHECK_EQUAL(mapWorkerThread.size(), (size_t)nThreads);
+    std::set<std::thread::id> setThreads;
+    for (const auto& entry : mapWorkerThread)
+        setThreads.insert(entry.second);
+    BOOST_CHECK_EQUAL(setThreads.size(), (size_t)nThreads);
+}
+
+static void QueueMessage(CNode& node, CSerializedNetMsg&& msg, bool fBadChecksum = false)
+{
+    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), msg.data.size());
+    uint256 hash = Hash(msg.data.begin(), msg.data.end());
+    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    if (fBadChecksum)
+        hdr.pchChecksum[0] ^= 1;
+    CDataStream wire(SER_NETWORK, INIT_PROTO_VERSION);
+    wire << hdr;
+    wire.write((const char*)msg.data.data(), msg.data.size());
+
+    CNetMessage netmsg(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
+    int nHeader = netmsg.readHeader(wire.data(), wire.size());
+    BOOST_REQUIRE_EQUAL(nHeader, CMessageHeader::HEADER_SIZE);
+    netmsg.readData(wire.data() + nHeader, wire.size() - nHeader);
+    BOOST_REQUIRE(netmsg.complete());
+    LOCK(node.cs_vProcessMsg);
+    node.nProcessQueueSize += netmsg.GetMemoryUsage();
+    node.vProcessMsg.push_back(std::move(netmsg));
+}
+
+/** The messages queued to be sent to node, as command and payload */
+static std::vector<std::pair<std::string, CDataStream> > SentMessages(CNode& node)
+{
+    CDataStream ss(SER_NETWORK, INIT_PROTO_VERSION);
+    {
+        LOCK(node.cs_vSend);
+        for (const std::vector<unsigned char>& data : node.vSendMsg)
+            ss.write((const char*)data.data(), data.size());
+    }
+    std::vector<std::pair<std::string, CDataStream> > vMessages;
+    while (!ss.empty()) {
+        CMessageHeader hdr(Params().MessageStart());
+        ss >> hdr;
+        std::vector<char> vPayload(hdr.nMessageSize);
+        ss.read(vPayload.data(), vPayload.size());
+        vMessages.emplace_back(hdr.GetCommand(), CDataStream(vPayload, SER_NETWORK, INIT_PROTO_VERSION));
+    }
+    return vMessages;
+}
+
+static std::vector<std::string> SentCommands(CNode& node)
+{
+    std::vector<std::string> vCommands;
+    for (const auto& msg : SentMessages(node))
+        vCommands.push_back(msg.first);
+    return vCommands;
+}
+
+BOOST_AUTO_TEST_CASE(blockio_response_order)
+{
+    std::atomic<bool> interruptDummy(false);
+    CConnman::Options options;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    connman->Init(options);
+    CConnmanTest::StartBlockIO(*connman, 1);
+
+    CNode node(0, ServiceFlags(NODE_NETWORK | NODE_WITNESS), 0, INVALID_SOCKET, TestAddress(), 0, 0, CAddress(), "", true);
+    node.SetSendVersion(PROTOCOL_VERSION);
+    peerLogic->InitializeNode(&node);
+    node.nVersion = PROTOCOL_VERSION;
+    node.fSuccessfullyConnected = true;
+
+    // Hold up the only block I/O thread, so a block read waits behind it
+    CNode nodeBusy(1, NODE_NETWORK, 0, INVALID_SOCKET, TestAddress(), 0, 0, CAddress(), "", true);
+    std::promise<void> promiseBusy;
+    auto HoldBlockIO = [&] {
+        promiseBusy = std::promise<void>();
+        std::shared_future<void> futureBusy(promiseBusy.get_future());
+        BOOST_REQUIRE(connman->ScheduleBlockIO(&nodeBusy, [futureBusy] { futureBusy.wait(); }));
+    };
+    auto ReleaseBlockIO = [&] {
+        promiseBusy.set_value();
+        for (int n = 0; n < 1000 && node.fPendingBlockIO; n++)
+            MilliSleep(10);
+        BOOST_REQUIRE(!node.fPendingBlockIO);
+    };
+    HoldBlockIO();
+
+    // A block, a transaction we do not have and another block, then a ping
+    uint256 hashGenesis;
+    {
+        LOCK(cs_main);
+        hashGenesis = chainActive.Genesis()->GetBlockHash();
+    }
+    std::vector<CInv> vInv;
+    vInv.push_back(CInv(MSG_BLOCK, hashGenesis));
+    vInv.push_back(CInv(MSG_TX, InsecureRand256()));
+    vInv.push_back(CInv(MSG_BLOCK, hashGenesis));
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    QueueMessage(node, msgMaker.Make(NetMsgType::GETDATA, vInv));
+    QueueMessage(node, msgMaker.Make(NetMsgType::PING, (uint64_t)42));
+
+    // Nothing else is answered while the first block is being read
+    peerLogic->ProcessMessages(&node, interruptDummy);
+    BOOST_CHECK(node.fPendingBlockIO);
+    for (int i = 0; i < 3; i++)
+        BOOST_CHECK(!peerLogic->ProcessMessages(&node, interruptDummy));
+    BOOST_CHECK(SentCommands(node).empty());
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_CHECK_EQUAL(node.vProcessMsg.size(), 1U);
+    }
+    ReleaseBlockIO();
+
+    // The second block is the last item of the getdata; the ping still
+    // waits for it to be read
+    HoldBlockIO();
+    BOOST_CHECK(!peerLogic->ProcessMessages(&node, interruptDummy));
+    BOOST_CHECK(node.fPendingBlockIO);
+    BOOST_CHECK(node.vRecvGetData.empty());
+    for (int i = 0; i < 3; i++)
+        BOOST_CHECK(!peerLogic->ProcessMessages(&node, interruptDummy));
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_CHECK_EQUAL(node.vProcessMsg.size(), 1U);
+    }
+    ReleaseBlockIO();
+    for (int i = 0; i < 10; i++)
+        peerLogic->ProcessMessages(&node, interruptDummy);
+
+    // The responses went out in the order of the requests
+    std::vector<std::string> vCommands = SentCommands(node);
+    BOOST_REQUIRE_EQUAL(vCommands.size(), 4U);
+    BOOST_CHECK_EQUAL(vCommands[0], NetMsgType::BLOCK);
+    BOOST_CHECK_EQUAL(vCommands[1], NetMsgType::NOTFOUND);
+    BOOST_CHECK_EQUAL(vCommands[2], NetMsgType::BLOCK);
+    BOOST_CHECK_EQUAL(vCommands[3], NetMsgType::PONG);
+    BOOST_CHECK_EQUAL(node.GetRefCount(), 0);
+    BOOST_CHECK_EQUAL(nodeBusy.GetRefCount(), 0);
+
+    bool dummy;
+    peerLogic->FinalizeNode(node.GetId(), dummy);
+}
+
+BOOST_AUTO_TEST_CASE(processmessages_checksum_batch)
+{
+    std::atomic<bool> interruptDummy(false);
+    CConnman::Options options;
+    options.nSendBufferMaxSize = 1000 * DEFAULT_MAXSENDBUFFER;
+    connman->Init(options);
+
+    CNode node(0, ServiceFlags(NODE_NETWORK | NODE_WITNESS), 0, INVALID_SOCKET, TestAddress(), 0, 0, CAddress(), "", true);
+    node.SetSendVersion(PROTOCOL_VERSION);
+    peerLogic->InitializeNode(&node);
+    node.nVersion = PROTOCOL_VERSION;
+    node.fSuccessfullyConnected = true;
+
+    // More pings than fit in a batch, one of them with a bad checksum
+    const size_t nPings = MAX_CHECKSUM_BATCH + 2;
+    const CNetMsgMaker msgMaker(PROTOCOL_VERSION);
+    for (size_t i = 0; i < nPings; i++)
+        QueueMessage(node, msgMaker.Make(NetMsgType::PING, (uint64_t)i), i == 3);
+
+    // Processing the first message checksums the ones queued behind it too
+    peerLogic->ProcessMessages(&node, interruptDummy);
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_REQUIRE_EQUAL(node.vProcessMsg.size(), nPings - 1);
+        size_t i = 1;
+        for (const CNetMessage& msg : node.vProcessMsg) {
+            BOOST_CHECK_EQUAL(msg.HasMessageHash(), i < MAX_CHECKSUM_BATCH);
+            if (msg.HasMessageHash())
+                BOOST_CHECK(msg.GetMessageHash() == Hash(msg.vRecv.begin(), msg.vRecv.end()));
+            i++;
+        }
+        // Messages hashed ahead are not hashed again: the second ping's
+        // nonce is now checked against the hash taken before it changed
+        node.vProcessMsg.front().vRecv[0] ^= 0x40;
+    }
+
+    for (size_t i = 0; i < nPings && peerLogic->ProcessMessages(&node, interruptDummy); i++) {}
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_CHECK(node.vProcessMsg.empty());
+        BOOST_CHECK_EQUAL(node.nProcessQueueSize, 0U);
+    }
+
+    // Every ping but the one with a bad checksum was answered, in order
+    std::vector<uint64_t> vNonces;
+    for (auto& msg : SentMessages(node)) {
+        BOOST_CHECK_EQUAL(msg.first, NetMsgType::PONG);
+        uint64_t nonce;
+        msg.second >> nonce;
+        vNonces.push_back(nonce);
+    }
+    BOOST_REQUIRE_EQUAL(vNonces.size(), nPings - 1);
+    BOOST_CHECK_EQUAL(vNonces[0], 0U);
+    BOOST_CHECK_EQUAL(vNonces[1], 0x41U);
+    BOOST_CHECK_EQUAL(vNonces[2], 2U);
+    for (size_t i = 3; i < vNonces.size(); i++)
+        BOOST_CHECK_EQUAL(vNonces[i], i + 1);
+
+    bool dummy;
+    peerLogic->FinalizeNode(node.GetId(), dummy);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -9,6 +9,8 @@
 #include "serialize.h"
 #include "streams.h"
 #include "net.h"
+#include "netbufferpool.h"
+#include "netmessagemaker.h"
 #include "netbase.h"
 #include "chainparams.h"
 #include "util.h"
@@ -71,6 +73,18 @@ CDataStream AddrmanToStream(CAddrManSerializationMock& _addrman)
     return CDataStream(vchData, SER_DISK, CLIENT_VERSION);
 }
 
+/** A message as it is sent over the wire, header and checksum included */
+static CDataStream WireMessage(const CSerializedNetMsg& msg)
+{
+    CMessageHeader hdr(Params().MessageStart(), msg.command.c_str(), msg.data.size());
+    uint256 hash = Hash(msg.data.begin(), msg.data.end());
+    memcpy(hdr.pchChecksum, hash.begin(), CMessageHeader::CHECKSUM_SIZE);
+    CDataStream wire(SER_NETWORK, INIT_PROTO_VERSION);
+    wire << hdr;
+    wire.write((const char*)msg.data.data(), msg.data.size());
+    return wire;
+}
+
 BOOST_FIXTURE_TEST_SUITE(net_tests, BasicTestingSetup)
 
 BOOST_AUTO_TEST_CASE(cnode_listen_port)
@@ -185,4 +199,213 @@ BOOST_AUTO_TEST_CASE(cnode_simple_test)
     BOOST_CHECK(pnode2->fFeeler == false);
 }
 
+BOOST_AUTO_TEST_CASE(socketevents_mode)
+{
+    SocketEventsMode mode = SOCKETEVENTS_EPOLL;
+    BOOST_CHECK(ParseSocketEventsMode("select", mode));
+    BOOST_CHECK(mode == SOCKETEVENTS_SELECT);
+    BOOST_CHECK(!ParseSocketEventsMode("kqueue", mode));
+    BOOST_CHECK(mode == SOCKETEVENTS_SELECT);
+#ifdef USE_EPOLL
+    BOOST_CHECK(ParseSocketEventsMode("epoll", mode));
+    BOOST_CHECK(mode == SOCKETEVENTS_EPOLL);
+#else
+    BOOST_CHECK(!ParseSocketEventsMode("epoll", mode));
+#endif
+    BOOST_CHECK(ParseSocketEventsMode(GetSocketEventsModeName(DEFAULT_SOCKETEVENTS), mode));
+    BOOST_CHECK(mode == DEFAULT_SOCKETEVENTS);
+}
+
+BOOST_AUTO_TEST_CASE(blockio_without_threads)
+{
+    // Without block I/O threads getdata responses are read inline, so
+    // nothing is queued and the node is left as it was.
+    CConnman connman(0x1337, 0x1337);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", true);
+    bool fRan = false;
+    BOOST_CHECK(!connman.ScheduleBlockIO(&node, [&fRan] { fRan = true; }));
+    BOOST_CHECK(!fRan);
+    BOOST_CHECK(!node.fPendingBlockIO);
+    BOOST_CHECK_EQUAL(node.GetRefCount(), 0);
+}
+
+#ifdef USE_EPOLL
+BOOST_AUTO_TEST_CASE(socketevents_epoll_hangup)
+{
+    // A peer that sends a message and closes right away raises a single
+    // edge-triggered event. The node has to read both the message and the
+    // end of the stream from it.
+    CConnman connman(0x1337, 0x1337);
+    CConnman::Options options;
+    options.nReceiveFloodSize = 1000 * DEFAULT_MAXRECEIVEBUFFER;
+    options.socketEventsMode = SOCKETEVENTS_EPOLL;
+    connman.Init(options);
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, fds[0], addr, 0, 0, CAddress(), "", true);
+    CConnmanTest::RegisterNodeSocket(connman, node);
+
+    CDataStream wire = WireMessage(CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, (uint64_t)42));
+    BOOST_REQUIRE_EQUAL(send(fds[1], wire.data(), wire.size(), 0), (ssize_t)wire.size());
+    close(fds[1]);
+
+    for (int i = 0; i < 4 && !node.fDisconnect; i++)
+        BOOST_CHECK(CConnmanTest::ServiceSockets(connman));
+    BOOST_CHECK(node.fDisconnect);
+    BOOST_CHECK_EQUAL(node.nRecvBytes, wire.size());
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_CHECK_EQUAL(node.vProcessMsg.size(), 1U);
+    }
+    BOOST_CHECK_EQUAL(node.GetRefCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(netbufferpool_node_receive_bound)
+{
+    // A peer whose receive queue is full reads into exactly sized buffers
+    CConnman connman(0x1337, 0x1337);
+    CConnman::Options options;
+    options.nReceiveFloodSize = 1000 * DEFAULT_MAXRECEIVEBUFFER;
+    options.socketEventsMode = SOCKETEVENTS_EPOLL;
+    connman.Init(options);
+    int fds[2];
+    BOOST_REQUIRE_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, fds[0], addr, 0, 0, CAddress(), "", true);
+    CConnmanTest::RegisterNodeSocket(connman, node);
+
+    CDataStream wire = WireMessage(CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, (uint64_t)42));
+    BOOST_REQUIRE_EQUAL(send(fds[1], wire.data(), wire.size(), 0), (ssize_t)wire.size());
+    BOOST_CHECK(CConnmanTest::ServiceSockets(connman));
+    CNetBufferPool::Stats stats = connman.GetBufferPoolStats();
+    const uint64_t nPoolGets = stats.nHits + stats.nMisses;
+    BOOST_CHECK(nPoolGets > 0);
+    {
+        // The queue is charged the buffers, not only the payload
+        LOCK(node.cs_vProcessMsg);
+        BOOST_REQUIRE_EQUAL(node.vProcessMsg.size(), 1U);
+        BOOST_CHECK_EQUAL(node.nProcessQueueSize, node.vProcessMsg.front().GetMemoryUsage());
+        BOOST_CHECK(node.nProcessQueueSize >= CNetBufferPool::CLASS_SIZES[0]);
+        node.nProcessQueueSize = MAX_NETBUFFERPOOL_NODE_BYTES;
+    }
+
+    BOOST_REQUIRE_EQUAL(send(fds[1], wire.data(), wire.size(), 0), (ssize_t)wire.size());
+    BOOST_CHECK(CConnmanTest::ServiceSockets(connman));
+    stats = connman.GetBufferPoolStats();
+    BOOST_CHECK_EQUAL(stats.nHits + stats.nMisses, nPoolGets);
+    {
+        LOCK(node.cs_vProcessMsg);
+        BOOST_REQUIRE_EQUAL(node.vProcessMsg.size(), 2U);
+        BOOST_CHECK_EQUAL(node.vProcessMsg.back().GetMemoryUsage(), wire.size());
+    }
+    close(fds[1]);
+}
+#endif
+
+BOOST_AUTO_TEST_CASE(netbufferpool_node_send_bound)
+{
+    // Messages queued beyond the bound are sent from exactly sized buffers
+    CConnman connman(0x1337, 0x1337);
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CAddress addr = CAddress(CService(ipv4Addr, 7777), NODE_NETWORK);
+    CNode node(0, NODE_NETWORK, 0, INVALID_SOCKET, addr, 0, 0, CAddress(), "", true);
+    const CNetMsgMaker msgMaker(INIT_PROTO_VERSION);
+    const size_t nMessageSize = CMessageHeader::HEADER_SIZE + sizeof(uint64_t);
+    const size_t nPooled = (MAX_NETBUFFERPOOL_NODE_BYTES + nMessageSize - 1) / nMessageSize;
+    for (size_t i = 0; i < nPooled + 100; i++)
+        connman.PushMessage(&node, msgMaker.Make(NetMsgType::PING, (uint64_t)i));
+    CNetBufferPool::Stats stats = connman.GetBufferPoolStats();
+    BOOST_CHECK_EQUAL(stats.nHits + stats.nMisses, nPooled);
+    LOCK(node.cs_vSend);
+    BOOST_CHECK_EQUAL(node.vSendMsg.size(), nPooled + 100);
+    BOOST_CHECK_EQUAL(node.nSendSize, (nPooled + 100) * nMessageSize);
+}
+
+BOOST_AUTO_TEST_CASE(netbufferpool_reuse)
+{
+    CNetBufferPool pool(4096);
+    std::vector<unsigned char> buf;
+
+    // A miss rounds the allocation up to the size class
+    pool.Get(buf, 100);
+    BOOST_CHECK_EQUAL(buf.capacity(), 256);
+    const unsigned char* pchFirst = buf.data();
+    buf.resize(100);
+    pool.Put(buf);
+    BOOST_CHECK_EQUAL(buf.capacity(), 0);
+
+    // The same storage comes back for a request of the same class
+    pool.Get(buf, 200);
+    BOOST_CHECK(buf.data() == pchFirst);
+    BOOST_CHECK(buf.empty());
+    pool.Put(buf);
+
+    // Receive buffers are kept apart from send buffers
+    CSerializeData data;
+    pool.Get(data, 200);
+    BOOST_CHECK_EQUAL(data.capacity(), 256);
+
+    CNetBufferPool::Stats stats = pool.GetStats();
+    BOOST_CHECK_EQUAL(stats.nHits, 1);
+    BOOST_CHECK_EQUAL(stats.nMisses, 2);
+    BOOST_CHECK_EQUAL(stats.nRecycled, 2);
+    BOOST_CHECK_EQUAL(stats.nFreeBuffers, 1);
+    BOOST_CHECK_EQUAL(stats.nFreeBytes, 256);
+
+    // Oversized buffers and buffers past the class budget are freed
+    std::vector<unsigned char> big;
+    big.reserve(2 * CNetBufferPool::CLASS_SIZES.back() + 1);
+    pool.Put(big);
+    for (int i = 0; i < 5; i++) {
+        std::vector<unsigned char> medium;
+        medium.reserve(1024);
+        pool.Put(medium);
+    }
+    stats = pool.GetStats();
+    BOOST_CHECK_EQUAL(stats.nRecycled, 6);
+    BOOST_CHECK_EQUAL(stats.nDropped, 2);
+    BOOST_CHECK_EQUAL(stats.nFreeBytes, 256 + 4 * 1024);
+}
+
+BOOST_AUTO_TEST_CASE(netbufferpool_receive)
+{
+    // Messages received through a pool give their buffers back once gone
+    CNetBufferPool pool;
+    CDataStream wire = WireMessage(CNetMsgMaker(INIT_PROTO_VERSION).Make(NetMsgType::PING, (uint64_t)42));
+
+    for (int i = 0; i < 2; i++) {
+        CNetMessage netmsg(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION, &pool);
+        int nHeader = netmsg.readHeader(wire.data(), wire.size());
+        BOOST_CHECK_EQUAL(nHeader, CMessageHeader::HEADER_SIZE);
+        BOOST_CHECK_EQUAL(netmsg.readData(wire.data() + nHeader, wire.size() - nHeader), 8);
+        BOOST_CHECK(netmsg.complete());
+        // The payload went into the pooled header buffer
+        BOOST_CHECK_EQUAL(netmsg.GetMemoryUsage(), CNetBufferPool::CLASS_SIZES[0]);
+        uint64_t nonce = 0;
+        netmsg.vRecv >> nonce;
+        BOOST_CHECK_EQUAL(nonce, 42);
+    }
+
+    // The second message reused the buffer the first one returned
+    CNetBufferPool::Stats stats = pool.GetStats();
+    BOOST_CHECK_EQUAL(stats.nMisses, 1);
+    BOOST_CHECK_EQUAL(stats.nHits, 1);
+    BOOST_CHECK_EQUAL(stats.nFreeBuffers, 1);
+
+    // Without a pool the buffers are sized to the message
+    CNetMessage netmsg(Params().MessageStart(), SER_NETWORK, INIT_PROTO_VERSION);
+    int nHeader = netmsg.readHeader(wire.data(), wire.size());
+    netmsg.readData(wire.data() + nHeader, wire.size() - nHeader);
+    BOOST_CHECK_EQUAL(netmsg.GetMemoryUsage(), wire.size());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,13 +2,18 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "arith_uint256.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "pow.h"
+#include "powcache.h"
+#include "primitives/block.h"
 #include "random.h"
 #include "util.h"
 #include "test/test_bitcoin.h"
 
+#include <cmath>
+
 #include <boost/test/unit_test.hpp>
 
 BOOST_FIXTURE_TEST_SUITE(pow_tests, BasicTestingSetup)
@@ -83,4 +88,166 @@ BOOST_AUTO_TEST_CASE(GetBlockProofEquivalentTime_test)
     }
 }
 
+/* The Kimoto Gravity Well as originally written, to check the optimized one against. */
+static unsigned int KimotoGravityWellReference(const CBlockIndex* pindexLast, const Consensus::Params& params)
+{
+    const int64_t TargetBlockSpacing = 60;
+    const uint64_t PastBlocksMin = 60 * 60 * 24 * 0.25 / TargetBlockSpacing;
+    const uint64_t PastBlocksMax = 60 * 60 * 24 * 7 / TargetBlockSpacing;
+    const arith_uint256 nProofOfWorkLimit = UintToArith256(params.powLimit);
+    if (pindexLast == nullptr || pindexLast->nHeight == 0 || (uint64_t)pindexLast->nHeight < PastBlocksMin)
+        return nProofOfWorkLimit.GetCompact();
+
+    const CBlockIndex* BlockReading = pindexLast;
+    uint64_t PastBlocksMass = 0;
+    int64_t PastRateActualSeconds = 0;
+    int64_t PastRateTargetSeconds = 0;
+    arith_uint256 PastDifficultyAverage, PastDifficultyAveragePrev, BlockReadingDifficulty;
+    int64_t LatestBlockTime = pindexLast->GetBlockTime();
+    for (unsigned int i = 1; BlockReading && BlockReading->nHeight > 0; i++) {
+        if (i > PastBlocksMax) break;
+        PastBlocksMass++;
+        if (i == 1) {
+            PastDifficultyAverage.SetCompact(BlockReading->nBits);
+        } else {
+            BlockReadingDifficulty.SetCompact(BlockReading->nBits);
+            if (BlockReadingDifficulty > PastDifficultyAveragePrev) {
+                PastDifficultyAverage = PastDifficultyAveragePrev + ((BlockReadingDifficulty - PastDifficultyAveragePrev) / i);
+            } else {
+                PastDifficultyAverage = PastDifficultyAveragePrev - ((PastDifficultyAveragePrev - BlockReadingDifficulty) / i);
+            }
+        }
+        PastDifficultyAveragePrev = PastDifficultyAverage;
+        if (LatestBlockTime < BlockReading->GetBlockTime() && BlockReading->nHeight > params.Fork3Height)
+            LatestBlockTime = BlockReading->GetBlockTime();
+        PastRateActualSeconds = LatestBlockTime - BlockReading->GetBlockTime();
+        PastRateTargetSeconds = TargetBlockSpacing * PastBlocksMass;
+        double PastRateAdjustmentRatio = double(1);
+        if (BlockReading->nHeight > params.Fork3Height) {
+            if (PastRateActualSeconds < 1) PastRateActualSeconds = 1;
+        } else {
+            if (PastRateActualSeconds < 0) PastRateActualSeconds = 0;
+        }
+        if (PastRateActualSeconds != 0 && PastRateTargetSeconds != 0)
+            PastRateAdjustmentRatio = double(PastRateTargetSeconds) / double(PastRateActualSeconds);
+        double EventHorizonDeviation = 1 + (0.7084 * pow((double(PastBlocksMass)/double(144)), -1.228));
+        if (PastBlocksMass >= PastBlocksMin &&
+            (PastRateAdjustmentRatio <= 1 / EventHorizonDeviation || PastRateAdjustmentRatio >= EventHorizonDeviation))
+            break;
+        if (BlockReading->pprev == nullptr) break;
+        BlockReading = BlockReading->pprev;
+    }
+
+    arith_uint256 bnNew(PastDifficultyAverage);
+    if (PastRateActualSeconds != 0 && PastRateTargetSeconds != 0) {
+        bnNew *= PastRateActualSeconds;
+        bnNew /= PastRateTargetSeconds;
+    }
+    if (bnNew > nProofOfWorkLimit) bnNew = nProofOfWorkLimit;
+    return bnNew.GetCompact();
+}
+
+/* The Kimoto Gravity Well must give the same result as the original loop, across the time warp fix */
+BOOST_AUTO_TEST_CASE(kimoto_gravity_well_reference)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    const arith_uint256 bnPowLimit = UintToArith256(params.powLimit);
+    const int nBlocks = 24000;
+    const int nFirstHeight = params.Fork3Height - nBlocks / 2;
+
+    std::vector<CBlockIndex> blocks(nBlocks);
+    for (int i = 0; i < nBlocks; i++) {
+        blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+        blocks[i].nHeight = nFirstHeight + i;
+        // Mostly on schedule, with bursts, stalls and timestamps going backwards
+        int64_t nSpacing = InsecureRandBool() ? 60 : (int64_t)InsecureRandRange(600) - 120;
+        blocks[i].nTime = i ? blocks[i - 1].nTime + nSpacing : 1400000000;
+        blocks[i].nBits = arith_uint256(bnPowLimit >> (8 + InsecureRandRange(8))).GetCompact();
+    }
+
+    CBlockHeader header;
+    for (int i = 0; i < nBlocks; i += 1 + InsecureRandRange(200)) {
+        BOOST_CHECK_EQUAL(GetNextWorkRequired(&blocks[i], &header, params), KimotoGravityWellReference(&blocks[i], params));
+    }
+}
+
+/* Retarget results are remembered per block, and per block time where the testnet minimum difficulty rule needs it */
+BOOST_AUTO_TEST_CASE(next_work_cache)
+{
+    const auto chainParams = CreateChainParams(CBaseChainParams::TESTNET);
+    const Consensus::Params& params = chainParams->GetConsensus();
+    const arith_uint256 bnPowLimit = UintToArith256(params.powLimit);
+    const unsigned int nProofOfWorkLimit = bnPowLimit.GetCompact();
+    const int nBlocks = 100;
+
+    std::vector<uint256> hashes(nBlocks);
+    std::vector<CBlockIndex> blocks(nBlocks);
+    for (int i = 0; i < nBlocks; i++) {
+        hashes[i] = InsecureRand256();
+        blocks[i].phashBlock = &hashes[i];
+        blocks[i].pprev = i ? &blocks[i - 1] : nullptr;
+        blocks[i].nHeight = i;
+        blocks[i].nTime = 1400000000 + i * params.nPowTargetSpacing;
+        blocks[i].nBits = arith_uint256(bnPowLimit >> 8).GetCompact();
+    }
+    CBlockIndex* pindexLast = &blocks.back();
+
+    const NextWorkCacheStats before = GetNextWorkCacheStats();
+    CBlockHeader header;
+    header.nTime = pindexLast->nTime + params.nPowTargetSpacing;
+    BOOST_CHECK_EQUAL(GetNextWorkRequired(pindexLast, &header, params), pindexLast->nBits);
+    BOOST_CHECK_EQUAL(GetNextWorkRequired(pindexLast, &header, params), pindexLast->nBits);
+    // A late block may have minimum difficulty, whatever was cached for a timely one
+    header.nTime = pindexLast->nTime + params.nPowTargetSpacing * 2 + 1;
+    BOOST_CHECK_EQUAL(GetNextWorkRequired(pindexLast, &header, params), nProofOfWorkLimit);
+    BOOST_CHECK_EQUAL(GetNextWorkRequired(pindexLast, &header, params), nProofOfWorkLimit);
+    const NextWorkCacheStats after = GetNextWorkCacheStats();
+    BOOST_CHECK_EQUAL(after.hits - before.hits, 2U);
+    BOOST_CHECK_EQUAL(after.misses - before.misses, 2U);
+
+    // Entries that are not in mapBlockIndex have no hash and bypass the cache
+    pindexLast->phashBlock = nullptr;
+    BOOST_CHECK_EQUAL(GetNextWorkRequired(pindexLast, &header, params), nProofOfWorkLimit);
+    BOOST_CHECK_EQUAL(GetNextWorkCacheStats().hits, after.hits);
+    BOOST_CHECK_EQUAL(GetNextWorkCacheStats().misses, after.misses);
+}
+
+/* Plain headers that passed CheckBlockProofOfWork are remembered, for the proof-of-work limit they were checked against */
+BOOST_AUTO_TEST_CASE(header_pow_cache)
+{
+    Consensus::Params params = CreateChainParams(CBaseChainParams::MAIN)->GetConsensus();
+    params.powLimit = ArithToUint256(~arith_uint256() >> 1);
+    CBlockHeader header;
+    header.nVersion = 4;
+    header.hashPrevBlock = InsecureRand256();
+    header.hashMerkleRoot = InsecureRand256();
+    header.nBits = UintToArith256(params.powLimit).GetCompact();
+
+    // A header that fails is not remembered
+    while (CheckProofOfWork(header.GetPoWHash(), header.nBits, params))
+        header.nNonce++;
+    BOOST_CHECK(!CheckBlockProofOfWork(&header, params));
+    BOOST_CHECK(!PoWCacheContains(PoWCacheEntry(header.GetHash(), params.powLimit)));
+
+    while (!CheckProofOfWork(header.GetPoWHash(), header.nBits, params))
+        header.nNonce++;
+    const uint256 entry = PoWCacheEntry(header.GetHash(), params.powLimit);
+    BOOST_CHECK(!PoWCacheContains(entry));
+    uint256 hashPoW;
+    BOOST_CHECK(CheckBlockProofOfWork(&header, params, &hashPoW));
+    BOOST_CHECK(hashPoW == header.GetPoWHash());
+    BOOST_CHECK(PoWCacheContains(entry));
+    BOOST_CHECK(CheckBlockProofOfWork(&header, params));
+
+    // Callers asking for the hash still get it with the header cached
+    hashPoW.SetNull();
+    BOOST_CHECK(CheckBlockProofOfWork(&header, params, &hashPoW));
+    BOOST_CHECK(hashPoW == header.GetPoWHash());
+
+    // Under a harder limit the entry is a different one
+    params.powLimit = ArithToUint256(~arith_uint256() >> 2);
+    BOOST_CHECK(!PoWCacheContains(PoWCacheEntry(header.GetHash(), params.powLimit)));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,9 @@
 #include "util.h"
 #include "utilstrencodings.h"
 #include "crypto/scrypt.h"
+#include "test/test_bitcoin.h"
+
+#include <thread>
 
 BOOST_AUTO_TEST_SUITE(scrypt_tests)
 
@@ -32,4 +35,124 @@ BOOST_AUTO_TEST_CASE(scrypt_hashtest)
     }
 }
 
+BOOST_AUTO_TEST_CASE(scrypt_multi)
+{
+    // Every kernel width must agree with the generic code, including on the
+    // inputs left over after the last full pass.
+    const size_t count = 2 * SCRYPT_MULTI_MAX_LANES + 3;
+    std::vector<std::vector<char>> inputs(count, std::vector<char>(80));
+    std::vector<uint256> expected(count);
+    std::vector<const char*> pin;
+    char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        for (size_t b = 0; b < 80; b++)
+            inputs[i][b] = (char)InsecureRandBits(8);
+        pin.push_back(inputs[i].data());
+        scrypt_1024_1_1_256_sp_generic(inputs[i].data(), BEGIN(expected[i]), scratchpad);
+    }
+    const size_t widths[] = {1, 8, 16};
+    const size_t sizes[] = {0, 1, 7, 8, 9, 15, 16, 17, count};
+    for (size_t width : widths) {
+        BOOST_CHECK(scrypt_multi_lanes(width) <= width);
+        for (size_t n : sizes) {
+            std::vector<uint256> hashes(n);
+            std::vector<char*> pout;
+            for (size_t i = 0; i < n; i++)
+                pout.push_back(BEGIN(hashes[i]));
+            scrypt_1024_1_1_256_multi(pin.data(), pout.data(), n, nullptr, width);
+            for (size_t i = 0; i < n; i++)
+                BOOST_CHECK(hashes[i] == expected[i]);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scrypt_midstate)
+{
+    // Headers that only differ past the first 64 bytes, like while grinding nonces
+    const size_t count = SCRYPT_MULTI_MAX_LANES + 1;
+    std::vector<std::vector<char>> inputs(count, std::vector<char>(80));
+    std::vector<uint256> expected(count);
+    std::vector<const char*> pin;
+    std::vector<char*> pout;
+    std::vector<uint256> hashes(count);
+    char scratchpad[SCRYPT_SCRATCHPAD_SIZE];
+    for (size_t b = 0; b < 80; b++)
+        inputs[0][b] = (char)InsecureRandBits(8);
+    for (size_t i = 0; i < count; i++) {
+        inputs[i] = inputs[0];
+        for (size_t b = 64; b < 80; b++)
+            inputs[i][b] = (char)InsecureRandBits(8);
+        pin.push_back(inputs[i].data());
+        pout.push_back(BEGIN(hashes[i]));
+        scrypt_1024_1_1_256_sp_generic(inputs[i].data(), BEGIN(expected[i]), scratchpad);
+    }
+    ScryptMidstate midstate;
+    scrypt_header_midstate(inputs[0].data(), &midstate);
+
+    // The keyed PBKDF2 steps match the plain ones, with or without the midstate
+    for (const ScryptMidstate* pmidstate : {(const ScryptMidstate*)nullptr, (const ScryptMidstate*)&midstate}) {
+        const uint8_t* input = (const uint8_t*)inputs[1].data();
+        ScryptHeaderKey key;
+        uint8_t B[128], BExpected[128];
+        uint256 out, outExpected;
+        scrypt_pbkdf2_begin(inputs[1].data(), pmidstate, &key, B);
+        PBKDF2_SHA256(input, 80, input, 80, 1, BExpected, 128);
+        BOOST_CHECK(memcmp(B, BExpected, 128) == 0);
+        scrypt_pbkdf2_end(&key, B, BEGIN(out));
+        PBKDF2_SHA256(input, 80, B, 128, 1, outExpected.begin(), 32);
+        BOOST_CHECK(out == outExpected);
+    }
+
+    const size_t widths[] = {1, 8, 16};
+    for (size_t width : widths) {
+        std::fill(hashes.begin(), hashes.end(), uint256());
+        scrypt_1024_1_1_256_multi(pin.data(), pout.data(), count, &midstate, width);
+        for (size_t i = 0; i < count; i++)
+            BOOST_CHECK(hashes[i] == expected[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scrypt_scratchpad_reuse)
+{
+    // Run on a fresh thread, which starts without a scratchpad
+    const ScryptScratchpadStats before = scrypt_scratchpad_stats();
+    ScryptScratchpadStats first, wide;
+    char *scratchpad = nullptr, *scratchpadWide = nullptr;
+    bool fReused = false, fWideReused = false;
+    std::thread t([&] {
+        char input[80] = {};
+        uint256 hash;
+        scrypt_1024_1_1_256(input, BEGIN(hash));
+        first = scrypt_scratchpad_stats();
+        scratchpad = scrypt_scratchpad(1);
+        for (int i = 0; i < 4; i++) {
+            input[0] = i;
+            scrypt_1024_1_1_256(input, BEGIN(hash));
+        }
+        fReused = scrypt_scratchpad(1) == scratchpad && scrypt_scratchpad_stats().allocations == first.allocations;
+
+        scratchpadWide = scrypt_scratchpad(SCRYPT_MULTI_MAX_LANES);
+        wide = scrypt_scratchpad_stats();
+        fWideReused = scrypt_scratchpad(1) == scratchpadWide;
+    });
+    t.join();
+
+    // Hashes on one thread share a single scratchpad
+    BOOST_CHECK_EQUAL(first.allocations, before.allocations + 1);
+    BOOST_CHECK_EQUAL(first.threads, before.threads + 1);
+    BOOST_CHECK(scratchpad != nullptr);
+    BOOST_CHECK_EQUAL((uintptr_t)scratchpad % 64, 0U);
+    BOOST_CHECK(fReused);
+
+    // Growing for the widest kernel allocates once, after which narrower users get the same memory
+    BOOST_CHECK(scratchpadWide != nullptr);
+    BOOST_CHECK_EQUAL(wide.allocations, before.allocations + 2);
+    BOOST_CHECK_EQUAL(wide.bytes, before.bytes + SCRYPT_MULTI_MAX_LANES * (SCRYPT_SCRATCHPAD_SIZE - 63));
+    BOOST_CHECK(fWideReused);
+
+    // The scratchpad is released when its thread exits
+    BOOST_CHECK_EQUAL(scrypt_scratchpad_stats().threads, before.threads);
+    BOOST_CHECK_EQUAL(scrypt_scratchpad_stats().bytes, before.bytes);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
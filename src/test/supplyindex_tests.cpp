@@ -0,0 +1,86 @@
+// Copyright (c) 2017 The Sexcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "chainparams.h"
+#include "rpc/server.h"
+#include "streams.h"
+#include "test/test_bitcoin.h"
+#include "txdb.h"
+#include "validation.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <univalue.h>
+
+extern UniValue CallRPC(std::string args);
+
+BOOST_FIXTURE_TEST_SUITE(supplyindex_tests, TestingSetup)
+
+BOOST_AUTO_TEST_CASE(supplyinfo_serialization)
+{
+    CSupplyInfo info;
+    info.nHeight = 1000;
+    info.nSubsidy = 500000 * COIN;
+    info.nFees = 3 * COIN;
+    info.nUnclaimed = -1;
+    info.nBurned = MAX_MONEY;
+
+    // Amounts are written fixed-width, so any value survives a round trip
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << info;
+    BOOST_CHECK_EQUAL(ss.size(), 2U + 4 * sizeof(CAmount));
+    CSupplyInfo infoRead;
+    ss >> infoRead;
+    BOOST_CHECK_EQUAL(infoRead.nHeight, info.nHeight);
+    BOOST_CHECK_EQUAL(infoRead.nSubsidy, info.nSubsidy);
+    BOOST_CHECK_EQUAL(infoRead.nFees, info.nFees);
+    BOOST_CHECK_EQUAL(infoRead.nUnclaimed, info.nUnclaimed);
+    BOOST_CHECK_EQUAL(infoRead.nBurned, info.nBurned);
+    BOOST_CHECK_EQUAL(infoRead.GetSupply(), info.nSubsidy + 1 - MAX_MONEY);
+}
+
+BOOST_AUTO_TEST_CASE(supplyindex_rpc)
+{
+    BOOST_CHECK_THROW(CallRPC("getsupplyinfo"), std::runtime_error);
+
+    psupplyindex = new CSupplyIndexDB(1 << 20, true);
+    uint256 hashGenesis;
+    {
+        LOCK(cs_main);
+        hashGenesis = chainActive.Genesis()->GetBlockHash();
+    }
+
+    // Nothing is indexed until the index catches up with the chain
+    BOOST_CHECK_THROW(CallRPC("getsupplyinfo"), std::runtime_error);
+    BOOST_CHECK(SyncSupplyIndex(Params()));
+    UniValue r = CallRPC("getsupplyinfo");
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "height").get_int(), 0);
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "blockhash").get_str(), hashGenesis.GetHex());
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "supply").get_real(), 0);
+    BOOST_CHECK_EQUAL(CallRPC("getsupplyinfo 0").write(), r.write());
+    BOOST_CHECK_THROW(CallRPC("getsupplyinfo 1"), std::runtime_error);
+    BOOST_CHECK_THROW(CallRPC("getsupplyinfo -1"), std::runtime_error);
+
+    // The result reports the stored totals
+    CSupplyInfo info;
+    info.nSubsidy = 100 * COIN;
+    info.nFees = 2 * COIN;
+    info.nUnclaimed = 3 * COIN;
+    info.nBurned = 5 * COIN;
+    BOOST_CHECK(psupplyindex->WriteSupplyInfo({std::make_pair(hashGenesis, info)}));
+    r = CallRPC("getsupplyinfo 0");
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "subsidy").get_real(), 100);
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "fees").get_real(), 2);
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "unclaimed").get_real(), 3);
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "burned").get_real(), 5);
+    BOOST_CHECK_EQUAL(find_value(r.get_obj(), "supply").get_real(), 92);
+
+    {
+        LOCK(cs_main);
+        delete psupplyindex;
+        psupplyindex = nullptr;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
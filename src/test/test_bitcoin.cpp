@@ -4,15 +4,18 @@
 
 #include "test_bitcoin.h"
 
+#include "auxpow/cache.h"
 #include "chainparams.h"
 #include "consensus/consensus.h"
 #include "consensus/validation.h"
+#include "crypto/scrypt.h"
 #include "crypto/sha256.h"
 #include "fs.h"
 #include "key.h"
 #include "validation.h"
 #include "miner.h"
 #include "net_processing.h"
+#include "powcache.h"
 #include "pubkey.h"
 #include "random.h"
 #include "txdb.h"
@@ -24,10 +27,13 @@
 
 #include <memory>
 
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
 void CConnmanTest::AddNode(CNode& node)
 {
-    LOCK(g_connman->cs_vNodes);
-    g_connman->vNodes.push_back(&node);
+    AddNode(*g_connman, node);
 }
 
 void CConnmanTest::ClearNodes()
@@ -36,6 +42,50 @@ void CConnmanTest::ClearNodes()
     g_connman->vNodes.clear();
 }
 
+void CConnmanTest::AddNode(CConnman& connman, CNode& node)
+{
+    LOCK(connman.cs_vNodes);
+    connman.vNodes.push_back(&node);
+}
+
+void CConnmanTest::StartMessageHandlers(CConnman& connman, int nThreads)
+{
+    connman.flagInterruptMsgProc = false;
+    connman.nMessageHandlerThreads = nThreads;
+    {
+        std::unique_lock<std::mutex> lock(connman.mutexMsgProc);
+        connman.vMsgProcWake.assign(nThreads, false);
+    }
+    for (int i = 0; i < nThreads; i++)
+        connman.threadMessageHandlers.emplace_back(&CConnman::ThreadMessageHandler, &connman, i);
+}
+
+void CConnmanTest::StartBlockIO(CConnman& connman, int nThreads)
+{
+    connman.flagInterruptMsgProc = false;
+    connman.nBlockIOThreads = nThreads;
+    std::lock_guard<std::mutex> lock(connman.mutexBlockIO);
+    for (int i = 0; i < nThreads; i++)
+        connman.threadBlockIO.emplace_back(&CConnman::ThreadBlockIO, &connman);
+}
+
+void CConnmanTest::RegisterNodeSocket(CConnman& connman, CNode& node)
+{
+    // What Start() would have set up for the socket handler
+    connman.interruptNet.reset();
+#ifdef USE_EPOLL
+    if (connman.socketEventsMode == SOCKETEVENTS_EPOLL && connman.epollfd == -1)
+        connman.epollfd = epoll_create1(EPOLL_CLOEXEC);
+#endif
+    LOCK(connman.cs_vNodes);
+    connman.RegisterNodeSocket(&node);
+}
+
+bool CConnmanTest::ServiceSockets(CConnman& connman)
+{
+    return connman.ServiceSockets();
+}
+
 uint256 insecure_rand_seed = GetRandHash();
 FastRandomContext insecure_rand_ctx(insecure_rand_seed);
 
@@ -45,11 +95,14 @@ extern void noui_connect();
 BasicTestingSetup::BasicTestingSetup(const std::string& chainName)
 {
         SHA256AutoDetect();
+        scrypt_detect_multi();
         RandomInit();
         ECC_Start();
         SetupEnvironment();
         SetupNetworking();
         InitSignatureCache();
+        InitAuxpowCache();
+        InitPoWCache();
         InitScriptExecutionCache();
         fPrintToDebugLog = false; // don't want to write to debug.log file
         fCheckBlockIndex = true;
@@ -53,6 +53,14 @@ class CNode;
 struct CConnmanTest {
     static void AddNode(CNode& node);
     static void ClearNodes();
+    static void AddNode(CConnman& connman, CNode& node);
+    /** Start connman's message handler or block I/O threads alone, as Start() would. Interrupt() and Stop() end them. */
+    static void StartMessageHandlers(CConnman& connman, int nThreads);
+    static void StartBlockIO(CConnman& connman, int nThreads);
+    /** Watch node's socket in connman's event backend, as if it had just connected. */
+    static void RegisterNodeSocket(CConnman& connman, CNode& node);
+    /** Run one round of connman's socket handler thread. */
+    static bool ServiceSockets(CConnman& connman);
 };
 
 class PeerLogicValidation;
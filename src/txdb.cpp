@@ -14,7 +14,10 @@
 #include "ui_interface.h"
 #include "init.h"
 
+#include <deque>
+#include <future>
 #include <stdint.h>
+#include <system_error>
 
 #include <boost/thread.hpp>
 
@@ -24,6 +27,12 @@ static const char DB_BLOCK_FILES = 'f';
 static const char DB_TXINDEX = 't';
 static const char DB_BLOCK_INDEX = 'b';
 static const char DB_BLOCK_INDEX_AUXPOW = 'a';
+static const char DB_BLOCK_INDEX_HEADER = 'h';
+static const char DB_AUXPOW = 'A';
+static const char DB_AUXPOW_SCRIPT = 'x';
+static const char DB_BLOCK_POWHASH = 'P';
+// Supply index entries with VARINT amounts were keyed 's'; SyncSupplyIndex rebuilds them under 'S'
+static const char DB_SUPPLY = 'S';
 
 static const char DB_BEST_BLOCK = 'B';
 static const char DB_HEAD_BLOCKS = 'H';
@@ -149,6 +158,15 @@ size_t CCoinsViewDB::EstimateSize() const
 }
 
 CBlockTreeDB::CBlockTreeDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "blocks" / "index", nCacheSize, fMemory, fWipe) {
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(DB_AUXPOW_SCRIPT, (uint32_t)0));
+    std::pair<char, uint32_t> key;
+    while (pcursor->Valid() && pcursor->GetKey(key) && key.first == DB_AUXPOW_SCRIPT) {
+        CScript script;
+        if (pcursor->GetValue(*(CScriptBase*)(&script)))
+            auxpowScripts.Load(key.second, script);
+        pcursor->Next();
+    }
 }
 
 bool CBlockTreeDB::ReadBlockFileInfo(int nFile, CBlockFileInfo &info) {
@@ -225,25 +243,63 @@ void CCoinsViewDBCursor::Next()
     }
 }
 
-bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo, const std::map<uint256, std::shared_ptr<CAuxPow> >& auxpows) {
+bool CBlockTreeDB::WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo, const std::map<uint256, std::shared_ptr<CAuxPow> >& auxpows, const std::map<uint256, uint256>& powhashes) {
     CDBBatch batch(*this);
     for (std::vector<std::pair<int, const CBlockFileInfo*> >::const_iterator it=fileInfo.begin(); it != fileInfo.end(); it++) {
         batch.Write(std::make_pair(DB_BLOCK_FILES, it->first), *it->second);
     }
     batch.Write(DB_LAST_BLOCK, nLastFile);
+    std::vector<std::pair<uint32_t, CScript> > vNewScripts;
     for (std::vector<const CBlockIndex*>::const_iterator it=blockinfo.begin(); it != blockinfo.end(); it++) {
         const std::map<uint256, std::shared_ptr<CAuxPow> >::const_iterator auxIt = auxpows.find((*it)->GetBlockHash());
-        if (auxIt != auxpows.end()) {
-            batch.Write(std::make_pair(std::make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), DB_BLOCK_INDEX_AUXPOW), CDiskBlockIndex(*it, auxIt->second));
+        if (auxIt != auxpows.end() && auxIt->second) {
+            batch.Write(std::make_pair(DB_AUXPOW, auxIt->first), CAuxPowCompressor(REF(auxIt->second), auxpowScripts, &vNewScripts));
+        }
+        CDiskBlockIndex diskindex(*it, nullptr);
+        batch.Write(std::make_pair(std::make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), DB_BLOCK_INDEX_HEADER), CDiskBlockIndexNoAuxPow(diskindex));
+        const std::map<uint256, uint256>::const_iterator powIt = powhashes.find((*it)->GetBlockHash());
+        if (powIt != powhashes.end()) {
+            batch.Write(std::make_pair(DB_BLOCK_POWHASH, powIt->first), CDiskPoWHash(powIt->first, powIt->second));
         }
-        batch.Write(std::make_pair(std::make_pair(DB_BLOCK_INDEX, (*it)->GetBlockHash()), DB_BLOCK_INDEX), **it);
     }
+    for (const std::pair<uint32_t, CScript>& script : vNewScripts)
+        batch.Write(std::make_pair(DB_AUXPOW_SCRIPT, script.first), *(const CScriptBase*)(&script.second));
     return WriteBatch(batch, true);
 }
 
-bool CBlockTreeDB::ReadDiskBlockIndex(const uint256 &blkid, CDiskBlockIndex &diskblockindex)
+CDiskPoWHash::CDiskPoWHash(const uint256& hashBlock, const uint256& hashPoWIn) : hashPoW(hashPoWIn)
 {
-    return Read(std::make_pair(std::make_pair(DB_BLOCK_INDEX, blkid), DB_BLOCK_INDEX_AUXPOW), diskblockindex);
+    nChecksum = ReadLE32(Hash(hashBlock.begin(), hashBlock.end(), hashPoW.begin(), hashPoW.end()).begin());
+}
+
+bool CDiskPoWHash::IsFor(const uint256& hashBlock) const
+{
+    return CDiskPoWHash(hashBlock, hashPoW).nChecksum == nChecksum;
+}
+
+bool CBlockTreeDB::WritePoWHashes(const std::vector<std::pair<uint256, uint256> >& powhashes) {
+    CDBBatch batch(*this);
+    for (const std::pair<uint256, uint256>& powhash : powhashes)
+        batch.Write(std::make_pair(DB_BLOCK_POWHASH, powhash.first), CDiskPoWHash(powhash.first, powhash.second));
+    return WriteBatch(batch);
+}
+
+bool CBlockTreeDB::HavePoWHash(const uint256 &blkid) {
+    return Exists(std::make_pair(DB_BLOCK_POWHASH, blkid));
+}
+
+bool CBlockTreeDB::ReadAuxPow(const uint256 &blkid, std::shared_ptr<CAuxPow>& auxpow)
+{
+    CAuxPowCompressor compressor(auxpow, auxpowScripts);
+    if (Read(std::make_pair(DB_AUXPOW, blkid), compressor))
+        return true;
+
+    // Entries written before Upgrade() carry the auxpow inline
+    CDiskBlockIndex diskblockindex;
+    if (!Read(std::make_pair(std::make_pair(DB_BLOCK_INDEX, blkid), DB_BLOCK_INDEX_AUXPOW), diskblockindex) || !diskblockindex.auxpow)
+        return false;
+    auxpow = diskblockindex.auxpow;
+    return true;
 }
 
 bool CBlockTreeDB::ReadTxIndex(const uint256 &txid, CDiskTxPos &pos) {
@@ -269,6 +325,110 @@ bool CBlockTreeDB::ReadFlag(const std::string &name, bool &fValue) {
     return true;
 }
 
+namespace {
+
+/** Number of block index records read from the database per decoding job. */
+static const size_t BLOCK_INDEX_LOAD_BATCH = 16384;
+
+/** A run of block index records, in key order, and the entries decoded from them. */
+struct BlockIndexLoadBatch
+{
+    std::vector<std::pair<uint256, char> > vKey;
+    std::vector<CDataStream> vValue;
+    std::vector<CDiskBlockIndex> vIndex;
+    bool fDecoded = false;
+    int nPercentDone = 0;
+    std::future<void> decoded;
+};
+
+/** Deserialize the DB_BLOCK_INDEX_HEADER and DB_BLOCK_INDEX_AUXPOW records of a batch. */
+void DecodeBlockIndexBatch(BlockIndexLoadBatch& batch)
+{
+    batch.vIndex.resize(batch.vKey.size());
+    try {
+        for (size_t i = 0; i < batch.vKey.size(); i++) {
+            if (batch.vKey[i].second == DB_BLOCK_INDEX_HEADER) {
+                CDiskBlockIndexNoAuxPow wrapper(batch.vIndex[i]);
+                batch.vValue[i] >> wrapper;
+            } else if (batch.vKey[i].second != DB_BLOCK_INDEX) {
+                assert(batch.vKey[i].second == DB_BLOCK_INDEX_AUXPOW);
+                batch.vValue[i] >> batch.vIndex[i];
+            }
+        }
+    } catch (const std::exception&) {
+        return;
+    }
+    batch.fDecoded = true;
+}
+
+/** Batches handed from the thread reading the database to the thread linking the index. */
+struct BlockIndexLoadQueue
+{
+    boost::mutex cs;
+    boost::condition_variable cond;
+    std::deque<std::unique_ptr<BlockIndexLoadBatch> > queue;
+    size_t nMaxSize = 1;
+    bool fReadAll = false;
+    bool fReadFailed = false;
+    bool fAbort = false;
+    std::future<void> reader;
+
+    /** Stop the reader if the linking thread returns early, and wait for it. */
+    ~BlockIndexLoadQueue() {
+        {
+            boost::unique_lock<boost::mutex> lock(cs);
+            fAbort = true;
+            cond.notify_all();
+        }
+        if (reader.valid())
+            reader.wait();
+    }
+};
+
+/** Read the block index records from pcursor in batches and start decoding each of them. */
+void ReadBlockIndexBatches(CDBIterator* pcursor, BlockIndexLoadQueue* pqueue)
+{
+    bool fLast = false;
+    while (!fLast) {
+        std::unique_ptr<BlockIndexLoadBatch> batch(new BlockIndexLoadBatch());
+        try {
+            std::pair<std::pair<char, uint256>, char> key;
+            while (batch->vKey.size() < BLOCK_INDEX_LOAD_BATCH && pcursor->Valid() && pcursor->GetKey(key) && key.first.first == DB_BLOCK_INDEX) {
+                batch->vKey.push_back(std::make_pair(key.first.second, key.second));
+                batch->vValue.push_back(CDataStream(SER_DISK, CLIENT_VERSION));
+                pcursor->GetValueStream(batch->vValue.back());
+                pcursor->Next();
+            }
+            fLast = batch->vKey.size() < BLOCK_INDEX_LOAD_BATCH;
+            if (!batch->vKey.empty()) {
+                // Keys are ordered by hash, so its leading bytes tell how far along we are
+                const uint256& hashLast = batch->vKey.back().first;
+                uint32_t high = 0x100 * *hashLast.begin() + *(hashLast.begin() + 1);
+                batch->nPercentDone = (int)(high * 100.0 / 65536.0 + 0.5);
+                // Throws std::system_error if no thread can be started
+                batch->decoded = std::async(std::launch::async, DecodeBlockIndexBatch, std::ref(*batch));
+            }
+        } catch (const std::exception& e) {
+            LogPrintf("%s: %s\n", __func__, e.what());
+            boost::unique_lock<boost::mutex> lock(pqueue->cs);
+            pqueue->fReadAll = pqueue->fReadFailed = true;
+            pqueue->cond.notify_all();
+            return;
+        }
+        boost::unique_lock<boost::mutex> lock(pqueue->cs);
+        while (!pqueue->fAbort && pqueue->queue.size() >= pqueue->nMaxSize)
+            pqueue->cond.wait(lock);
+        if (pqueue->fAbort)
+            return;
+        if (!batch->vKey.empty())
+            pqueue->queue.push_back(std::move(batch));
+        pqueue->fReadAll = fLast;
+        pqueue->cond.notify_all();
+    }
+}
+
+}
+
 bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex)
 {
     std::unique_ptr<CDBIterator> pcursor(NewIterator());
@@ -276,52 +436,191 @@ bool CBlockTreeDB::LoadBlockIndexGuts(const Consensus::Params& consensusParams,
     auto ssKeySet(std::make_pair(std::make_pair(DB_BLOCK_INDEX, uint256()), DB_BLOCK_INDEX_AUXPOW));
     pcursor->Seek(ssKeySet);
 
-    // Load mapBlockIndex
+    // Load mapBlockIndex. Each entry is a DB_BLOCK_INDEX_HEADER record, or, if
+    // written before Upgrade(), a DB_BLOCK_INDEX_AUXPOW record followed by the
+    // DB_BLOCK_INDEX record holding its mutable fields.
+    //
+    // A reader thread streams the records in batches, which are deserialized
+    // in parallel, up to one per core. This thread links the batches into the
+    // index in the order they were read, so the DB_BLOCK_INDEX record of a
+    // legacy entry is still applied after its DB_BLOCK_INDEX_AUXPOW record.
+    BlockIndexLoadQueue queue;
+    queue.nMaxSize = std::max(GetNumCores(), 1);
+    try {
+        queue.reader = std::async(std::launch::async, ReadBlockIndexBatches, pcursor.get(), &queue);
+    } catch (const std::system_error& e) {
+        return error("%s: cannot start reader thread: %s", __func__, e.what());
+    }
+
+    int nPercentShown = -1;
+    while (true) {
+        boost::this_thread::interruption_point();
+        std::unique_ptr<BlockIndexLoadBatch> batch;
+        {
+            boost::unique_lock<boost::mutex> lock(queue.cs);
+            while (queue.queue.empty() && !queue.fReadAll)
+                queue.cond.wait(lock);
+            if (queue.queue.empty()) {
+                if (queue.fReadFailed)
+                    return error("%s: failed to read block index", __func__);
+                break;
+            }
+            batch = std::move(queue.queue.front());
+            queue.queue.pop_front();
+            queue.cond.notify_all();
+        }
+
+        if (batch->nPercentDone != nPercentShown) {
+            uiInterface.InitMessage(strprintf("%s %d%%", _("Loading block index..."), batch->nPercentDone));
+            nPercentShown = batch->nPercentDone;
+        }
+        batch->decoded.get();
+        if (!batch->fDecoded)
+            return error("%s: failed to read value", __func__);
+        for (size_t i = 0; i < batch->vKey.size(); i++) {
+            // Construct block index object
+            CBlockIndex* pindexNew = insertBlockIndex(batch->vKey[i].first);
+
+            if (batch->vKey[i].second == DB_BLOCK_INDEX) {
+                try {
+                    batch->vValue[i] >> *pindexNew;
+                } catch (const std::exception&) {
+                    return error("%s: failed to read value", __func__);
+                }
+                continue;
+            }
+
+            const CDiskBlockIndex& diskindex = batch->vIndex[i];
+            pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
+            pindexNew->nHeight        = diskindex.nHeight;
+            pindexNew->nFile          = diskindex.nFile;
+            pindexNew->nDataPos       = diskindex.nDataPos;
+            pindexNew->nUndoPos       = diskindex.nUndoPos;
+            pindexNew->nVersion       = diskindex.nVersion;
+            pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
+            pindexNew->nTime          = diskindex.nTime;
+            pindexNew->nBits          = diskindex.nBits;
+            pindexNew->nNonce         = diskindex.nNonce;
+            pindexNew->nStatus        = diskindex.nStatus;
+            pindexNew->nTx            = diskindex.nTx;
+
+            // Sexcoin: the block index is keyed by the sha256 hash, while CheckProofOfWork() needs
+            // the scrypt (or auxpow parent) hash. Recomputing those here would take minutes on every
+            // startup, so the hashes are stored under DB_BLOCK_POWHASH instead and checked against
+            // the loaded entries by LoadPoWHashes().
+        }
+    }
+
+    return true;
+}
+
+bool CBlockTreeDB::Upgrade()
+{
+    bool fUpgraded = false;
+    if (ReadFlag("compactauxpow", fUpgraded) && fUpgraded)
+        return true;
+
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(std::make_pair(std::make_pair(DB_BLOCK_INDEX, uint256()), DB_BLOCK_INDEX_AUXPOW));
+
+    int64_t count = 0;
+    LogPrintf("Upgrading block index database...\n");
+    LogPrintf("Warning: earlier versions cannot read the upgraded block index, and need -reindex to use this data directory again\n");
+    LogPrintf("[0%%]...");
+    size_t batch_size = 1 << 24;
+    CDBBatch batch(*this);
+    std::vector<std::pair<uint32_t, CScript> > vNewScripts;
+    uiInterface.SetProgressBreakAction(StartShutdown);
+    int reportDone = 0;
+
+    // The legacy records of an entry are adjacent: DB_BLOCK_INDEX_AUXPOW, then
+    // DB_BLOCK_INDEX. diskindex collects both before they are rewritten.
+    CDiskBlockIndex diskindex;
+    uint256 hashPending;
+    bool fPending = false;
+    bool fHaveHeader = false;
+    auto flushPending = [&]() {
+        if (!fPending)
+            return;
+        if (!fHaveHeader)
+            batch.Write(std::make_pair(std::make_pair(DB_BLOCK_INDEX, hashPending), DB_BLOCK_INDEX_HEADER), CDiskBlockIndexNoAuxPow(diskindex));
+        if (diskindex.auxpow)
+            batch.Write(std::make_pair(DB_AUXPOW, hashPending), CAuxPowCompressor(diskindex.auxpow, auxpowScripts, &vNewScripts));
+        batch.Erase(std::make_pair(std::make_pair(DB_BLOCK_INDEX, hashPending), DB_BLOCK_INDEX_AUXPOW));
+        batch.Erase(std::make_pair(std::make_pair(DB_BLOCK_INDEX, hashPending), DB_BLOCK_INDEX));
+        for (const std::pair<uint32_t, CScript>& script : vNewScripts)
+            batch.Write(std::make_pair(DB_AUXPOW_SCRIPT, script.first), *(const CScriptBase*)(&script.second));
+        vNewScripts.clear();
+        fPending = false;
+    };
+
+    std::pair<std::pair<char, uint256>, char> key;
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
-        std::pair<std::pair<char, uint256>, char> key;
-        if (pcursor->GetKey(key) && key.first.first == DB_BLOCK_INDEX) {
-
-            assert(key.second == DB_BLOCK_INDEX_AUXPOW);
-
-            CDiskBlockIndex diskindex;
-            if (pcursor->GetValue(diskindex)) {
-                // Construct block index object
-                uint256 hash = key.first.second;
-                CBlockIndex* pindexNew = insertBlockIndex(hash);
-
-                pindexNew->pprev          = insertBlockIndex(diskindex.hashPrev);
-                pindexNew->nHeight        = diskindex.nHeight;
-                pindexNew->nFile          = diskindex.nFile;
-                pindexNew->nDataPos       = diskindex.nDataPos;
-                pindexNew->nUndoPos       = diskindex.nUndoPos;
-                pindexNew->nVersion       = diskindex.nVersion;
-                pindexNew->hashMerkleRoot = diskindex.hashMerkleRoot;
-                pindexNew->nTime          = diskindex.nTime;
-                pindexNew->nBits          = diskindex.nBits;
-                pindexNew->nNonce         = diskindex.nNonce;
-                pindexNew->nStatus        = diskindex.nStatus;
-                pindexNew->nTx            = diskindex.nTx;
-
-                pcursor->Next(); // now we should be on the 'b' subkey
-                pcursor->GetKey(key);
-//                pcursor->GetValue(*pindexNew);
-
-                // Sexcoin: Disable PoW Sanity check while loading block index from disk.
-                // We use the sha256 hash for the block index for performance reasons, which is recorded for later use.
-
-                // CheckProofOfWork() uses the scrypt hash which is discarded after a block is accepted.
-                //While it is technically feasible to verify the PoW, doing so takes several minutes as it
-                // requires recomputing every PoW hash during every Sexcoin startup.
-                // We opt instead to simply trust the data that is on your local disk.
-                //if (!CheckProofOfWork(pindexNew->GetBlockHash(), pindexNew->nBits, consensusParams))
-                //    return error("%s: CheckProofOfWork failed: %s", __func__, pindexNew->ToString());
-
-                pcursor->GetValue(*pindexNew);
-                pcursor->Next();
-            } else {
-                return error("%s: failed to read value", __func__);
+        if (ShutdownRequested()) {
+            break;
+        }
+        if (!pcursor->GetKey(key) || key.first.first != DB_BLOCK_INDEX)
+            break;
+        if (count++ % 256 == 0) {
+            uint32_t high = 0x100 * *key.first.second.begin() + *(key.first.second.begin() + 1);
+            int percentageDone = (int)(high * 100.0 / 65536.0 + 0.5);
+            uiInterface.ShowProgress(_("Upgrading block index database") + "\n"+ _("(press q to shutdown and continue later)") + "\n", percentageDone);
+            if (reportDone < percentageDone/10) {
+                // report max. every 10% step
+                LogPrintf("[%d%%]...", percentageDone);
+                reportDone = percentageDone/10;
             }
+        }
+        if (fPending && key.first.second != hashPending)
+            flushPending();
+        if (key.second == DB_BLOCK_INDEX_AUXPOW) {
+            diskindex = CDiskBlockIndex();
+            if (!pcursor->GetValue(diskindex))
+                return error("%s: cannot parse block index record", __func__);
+            hashPending = key.first.second;
+            fPending = true;
+            fHaveHeader = false;
+        } else if (key.second == DB_BLOCK_INDEX && fPending) {
+            if (!pcursor->GetValue(*(CBlockIndex*)&diskindex))
+                return error("%s: cannot parse block index record", __func__);
+        } else if (key.second == DB_BLOCK_INDEX_HEADER && fPending) {
+            // Rewritten by this version before an interrupted upgrade finished
+            fHaveHeader = true;
+        }
+        if (batch.SizeEstimate() > batch_size) {
+            WriteBatch(batch);
+            batch.Clear();
+        }
+        pcursor->Next();
+    }
+    if (!ShutdownRequested()) {
+        flushPending();
+        batch.Write(std::make_pair(DB_FLAG, std::string("compactauxpow")), '1');
+    }
+    WriteBatch(batch);
+    CompactRange(DB_BLOCK_INDEX, (char)(DB_BLOCK_INDEX+1));
+    uiInterface.SetProgressBreakAction(std::function<void(void)>());
+    LogPrintf("[%s].\n", ShutdownRequested() ? "CANCELLED" : "DONE");
+    return !ShutdownRequested();
+}
+
+bool CBlockTreeDB::LoadPoWHashes(std::function<bool(const uint256&, const uint256&, bool)> checkPoWHash)
+{
+    std::unique_ptr<CDBIterator> pcursor(NewIterator());
+
+    pcursor->Seek(std::make_pair(DB_BLOCK_POWHASH, uint256()));
+
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, uint256> key;
+        if (pcursor->GetKey(key) && key.first == DB_BLOCK_POWHASH) {
+            // A record that cannot be read is left to the caller to recompute
+            CDiskPoWHash diskpowhash;
+            bool fConsistent = pcursor->GetValue(diskpowhash) && diskpowhash.IsFor(key.second);
+            if (!checkPoWHash(key.second, diskpowhash.hashPoW, fConsistent))
+                return false;
+            pcursor->Next();
         } else {
             break;
         }
@@ -452,3 +751,17 @@ bool CCoinsViewDB::Upgrade() {
     LogPrintf("[%s].\n", ShutdownRequested() ? "CANCELLED" : "DONE");
     return !ShutdownRequested();
 }
+
+CSupplyIndexDB::CSupplyIndexDB(size_t nCacheSize, bool fMemory, bool fWipe) : CDBWrapper(GetDataDir() / "supply", nCacheSize, fMemory, fWipe) {
+}
+
+bool CSupplyIndexDB::ReadSupplyInfo(const uint256 &hashBlock, CSupplyInfo &info) {
+    return Read(std::make_pair(DB_SUPPLY, hashBlock), info);
+}
+
+bool CSupplyIndexDB::WriteSupplyInfo(const std::vector<std::pair<uint256, CSupplyInfo> > &vect) {
+    CDBBatch batch(*this);
+    for (const std::pair<uint256, CSupplyInfo>& item : vect)
+        batch.Write(std::make_pair(DB_SUPPLY, item.first), item.second);
+    return WriteBatch(batch);
+}
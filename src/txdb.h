@@ -6,6 +6,7 @@
 #ifndef BITCOIN_TXDB_H
 #define BITCOIN_TXDB_H
 
+#include "auxpow/compress.h"
 #include "coins.h"
 #include "dbwrapper.h"
 #include "chain.h"
@@ -37,6 +38,8 @@ static const int64_t nMaxBlockDBCache = 2;
 static const int64_t nMaxBlockDBAndTxIndexCache = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static const int64_t nMaxCoinsDBCache = 8;
+//! Memory allocated to the supply index DB cache, if -supplyindex (MiB)
+static const int64_t nSupplyIndexDBCache = 2;
 
 struct CDiskTxPos : public CDiskBlockPos
 {
@@ -105,6 +108,28 @@ private:
     friend class CCoinsViewDB;
 };
 
+/** The proof-of-work hash of a block index entry as stored in the block tree,
+ *  with a checksum that ties it to the entry's block hash. */
+struct CDiskPoWHash
+{
+    uint256 hashPoW;
+    uint32_t nChecksum;
+
+    CDiskPoWHash() : nChecksum(0) {}
+    CDiskPoWHash(const uint256& hashBlock, const uint256& hashPoWIn);
+
+    /** Whether this was stored for the entry with the given block hash. */
+    bool IsFor(const uint256& hashBlock) const;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(hashPoW);
+        READWRITE(nChecksum);
+    }
+};
+
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper
 {
@@ -113,9 +138,13 @@ public:
 private:
     CBlockTreeDB(const CBlockTreeDB&);
     void operator=(const CBlockTreeDB&);
+
+    //! Parent coinbase scripts referenced by the stored auxpows
+    CAuxPowScriptDict auxpowScripts;
 public:
-    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo, const std::map<uint256, std::shared_ptr<CAuxPow> >& auxpows);
-    bool ReadDiskBlockIndex(const uint256 &blkid, CDiskBlockIndex& diskblockindex);
+    bool WriteBatchSync(const std::vector<std::pair<int, const CBlockFileInfo*> >& fileInfo, int nLastFile, const std::vector<const CBlockIndex*>& blockinfo, const std::map<uint256, std::shared_ptr<CAuxPow> >& auxpows, const std::map<uint256, uint256>& powhashes);
+    /** Auxpow of a merge-mined block index entry. These are stored apart from the entries and only read on demand. */
+    bool ReadAuxPow(const uint256 &blkid, std::shared_ptr<CAuxPow>& auxpow);
     bool ReadBlockFileInfo(int nFile, CBlockFileInfo &fileinfo);
     bool ReadLastBlockFile(int &nFile);
     bool WriteReindexing(bool fReindex);
@@ -125,6 +154,70 @@ public:
     bool WriteFlag(const std::string &name, bool fValue);
     bool ReadFlag(const std::string &name, bool &fValue);
     bool LoadBlockIndexGuts(const Consensus::Params& consensusParams, std::function<CBlockIndex*(const uint256&)> insertBlockIndex);
+    /** Move auxpows out of block index entries written by older versions, into their own compact records. */
+    bool Upgrade();
+    /** Proof-of-work hashes (scrypt, or auxpow parent) of block index entries, keyed by block hash. */
+    bool WritePoWHashes(const std::vector<std::pair<uint256, uint256> >& powhashes);
+    bool HavePoWHash(const uint256 &blkid);
+    /** Pass every stored hash to checkPoWHash, with whether it could be read and belongs to its key. */
+    bool LoadPoWHashes(std::function<bool(const uint256& hashBlock, const uint256& hashPoW, bool fConsistent)> checkPoWHash);
+};
+
+/** Coins issued up to and including a block, as recorded by -supplyindex. */
+struct CSupplyInfo
+{
+    int nHeight;
+    //! Block rewards allowed by GetBlockSubsidy
+    CAmount nSubsidy;
+    //! Transaction fees paid
+    CAmount nFees;
+    //! Subsidy and fees the coinbase transactions did not claim
+    CAmount nUnclaimed;
+    //! Value sent to provably unspendable outputs
+    CAmount nBurned;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(VARINT(nHeight));
+        // Amounts are signed, which VARINT does not encode
+        READWRITE(nSubsidy);
+        READWRITE(nFees);
+        READWRITE(nUnclaimed);
+        READWRITE(nBurned);
+    }
+
+    CSupplyInfo() {
+        SetNull();
+    }
+
+    void SetNull() {
+        nHeight = 0;
+        nSubsidy = 0;
+        nFees = 0;
+        nUnclaimed = 0;
+        nBurned = 0;
+    }
+
+    //! Coins in existence that can still be spent
+    CAmount GetSupply() const {
+        return nSubsidy - nUnclaimed - nBurned;
+    }
+};
+
+/** Access to the supply index database (supply/) */
+class CSupplyIndexDB : public CDBWrapper
+{
+public:
+    CSupplyIndexDB(size_t nCacheSize, bool fMemory = false, bool fWipe = false);
+private:
+    CSupplyIndexDB(const CSupplyIndexDB&);
+    void operator=(const CSupplyIndexDB&);
+public:
+    /** Entries are keyed by block hash, so blocks that are disconnected simply stop being looked up. */
+    bool ReadSupplyInfo(const uint256 &hashBlock, CSupplyInfo &info);
+    bool WriteSupplyInfo(const std::vector<std::pair<uint256, CSupplyInfo> > &list);
 };
 
 #endif // BITCOIN_TXDB_H
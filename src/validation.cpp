@@ -5,6 +5,7 @@
 
 #include "validation.h"
 
+#include "auxpow/store.h"
 #include "arith_uint256.h"
 #include "chain.h"
 #include "chainparams.h"
@@ -14,9 +15,11 @@
 #include "consensus/merkle.h"
 #include "consensus/tx_verify.h"
 #include "consensus/validation.h"
+#include "crypto/scrypt.h"
 #include "cuckoocache.h"
 #include "fs.h"
 #include "hash.h"
+#include "memusage.h"
 #include "init.h"
 #include "policy/fees.h"
 #include "policy/policy.h"
@@ -43,7 +46,9 @@
 #include "warnings.h"
 
 #include <atomic>
+#include <future>
 #include <sstream>
+#include <tuple>
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -64,6 +69,8 @@
 CCriticalSection cs_main;
 
 BlockMap mapBlockIndex;
+/** Storage of the CBlockIndex entries mapBlockIndex points to. */
+static CBlockIndexArena blockIndexArena;
 CChain chainActive;
 CBlockIndex *pindexBestHeader = nullptr;
 CWaitableCriticalSection csBestBlock;
@@ -180,6 +187,9 @@ namespace {
     /** Dirty block index entries. */
     std::set<CBlockIndex*> setDirtyBlockIndex;
 
+    /** Proof-of-work hashes of new block index entries, written along with them. */
+    std::map<uint256, uint256> mapDirtyPoWHash;
+
     /** Dirty block file entries. */
     std::set<int> setDirtyFileInfo;
 } // anon namespace
@@ -205,6 +215,7 @@ CBlockIndex* FindForkInGlobalIndex(const CChain& chain, const CBlockLocator& loc
 CCoinsViewDB *pcoinsdbview = nullptr;
 CCoinsViewCache *pcoinsTip = nullptr;
 CBlockTreeDB *pblocktree = nullptr;
+CSupplyIndexDB *psupplyindex = nullptr;
 
 enum FlushStateMode {
     FLUSH_STATE_NONE,
@@ -1008,7 +1019,7 @@ static bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMes
     return true;
 }
 
-bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+static bool ReadBlockFromDiskUnchecked(CBlock& block, const CDiskBlockPos& pos)
 {
     block.SetNull();
 
@@ -1025,6 +1036,14 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
         return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
     }
 
+    return true;
+}
+
+bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams)
+{
+    if (!ReadBlockFromDiskUnchecked(block, pos))
+        return false;
+
     // Check the header
     if (!CheckBlockProofOfWork(&block, consensusParams))
         return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
@@ -1034,11 +1053,73 @@ bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus:
 
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
-    if (!ReadBlockFromDisk(block, pindex->GetBlockPos(), consensusParams))
+    // The proof of work of an indexed header was checked before it was added to the index,
+    // so a matching block hash is enough here and scrypt does not have to run again every
+    // time the block is served to a peer, returned over RPC/REST or replayed. The block
+    // hash does not commit to an auxpow though, so that is still checked, which the
+    // auxpow cache answers without scrypt for the blocks it has seen.
+    if (!ReadBlockFromDiskUnchecked(block, pindex->GetBlockPos()))
         return false;
     if (block.GetHash() != pindex->GetBlockHash())
         return error("ReadBlockFromDisk(CBlock&, CBlockIndex*): GetHash() doesn't match index for %s at %s",
                 pindex->ToString(), pindex->GetBlockPos().ToString());
+    if (block.auxpow && !CheckBlockProofOfWork(&block, consensusParams))
+        return error("ReadBlockFromDisk: Errors in block header at %s", pindex->GetBlockPos().ToString());
+    return true;
+}
+
+bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const uint256& hash, const Consensus::Params& consensusParams)
+{
+    if (!ReadBlockFromDiskUnchecked(block, pos))
+        return false;
+    if (block.GetHash() != hash)
+        return error("ReadBlockFromDisk(CBlock&, CDiskBlockPos&, uint256&): GetHash() doesn't match %s at %s",
+                hash.ToString(), pos.ToString());
+    // As for the index based read, the auxpow is not covered by the hash
+    if (block.auxpow && !CheckBlockProofOfWork(&block, consensusParams))
+        return error("ReadBlockFromDisk: Errors in block header at %s", pos.ToString());
+    return true;
+}
+
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CDiskBlockPos& pos, const uint256& hash, const CMessageHeader::MessageStartChars& messageStart, const Consensus::Params& consensusParams)
+{
+    // Step back over the index header WriteBlockToDisk put in front of the block
+    if (pos.nPos < CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int))
+        return error("%s: no index header in front of %s", __func__, pos.ToString());
+    CDiskBlockPos hpos = pos;
+    hpos.nPos -= CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int);
+    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+
+    try {
+        CMessageHeader::MessageStartChars blkStart;
+        unsigned int nSize;
+        filein >> FLATDATA(blkStart) >> nSize;
+        if (memcmp(blkStart, messageStart, CMessageHeader::MESSAGE_START_SIZE) != 0)
+            return error("%s: block magic mismatch at %s", __func__, pos.ToString());
+        if (nSize < 80 || nSize > MAX_SIZE)
+            return error("%s: invalid block size %u at %s", __func__, nSize, pos.ToString());
+        block.resize(nSize);
+        filein.read((char*)block.data(), nSize);
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+
+    // The block hash covers the 80 byte header that starts the block
+    if (Hash(block.begin(), block.begin() + 80) != hash)
+        return error("%s: GetHash() doesn't match %s at %s", __func__, hash.ToString(), pos.ToString());
+
+    // but not the auxpow that follows it in a merge-mined block
+    try {
+        CBlockHeader header;
+        CDataStream ss(block, SER_NETWORK, PROTOCOL_VERSION);
+        ss >> header;
+        if (header.auxpow && !CheckBlockProofOfWork(&header, consensusParams))
+            return error("%s: Errors in block header at %s", __func__, pos.ToString());
+    } catch (const std::exception& e) {
+        return error("%s: Deserialize error - %s at %s", __func__, e.what(), pos.ToString());
+    }
     return true;
 }
 
@@ -1049,6 +1130,97 @@ int static generateMTRandom(int s, int range)
     return dist(gen);
 }
 
+static const int SUPERBLOCK_RANGE = 100000;
+
+/**
+ * Same result as generateMTRandom(s, SUPERBLOCK_RANGE) without seeding a whole mt19937.
+ * The first output of the generator only depends on words 0, 1 and 397 of the seeded
+ * state, so the seeding recurrence is stopped at word 397 and the 624 word twist is
+ * skipped. uniform_int maps that output onto [1, range] in buckets of 0xffffffff / range
+ * values and draws again if it lands past the last bucket; that rare case is left to
+ * generateMTRandom.
+ */
+static int SuperblockRandom(int s)
+{
+    const uint32_t x0 = s;
+    uint32_t x1 = 0, x = x0;
+    for (uint32_t i = 1; i <= 397; i++) {
+        x = 1812433253U * (x ^ (x >> 30)) + i;
+        if (i == 1)
+            x1 = x;
+    }
+    const uint32_t y = (x0 & 0x80000000U) | (x1 & 0x7fffffffU);
+    uint32_t z = x ^ (y >> 1) ^ ((x1 & 1) * 0x9908b0dfU);
+    z ^= (z >> 11);
+    z ^= (z << 7) & 0x9d2c5680U;
+    z ^= (z << 15) & 0xefc60000U;
+    z ^= (z >> 18);
+
+    static const uint32_t nBucketSize = 0xffffffffU / SUPERBLOCK_RANGE;
+    if (z / nBucketSize >= (uint32_t)SUPERBLOCK_RANGE)
+        return generateMTRandom(s, SUPERBLOCK_RANGE);
+    return z / nBucketSize + 1;
+}
+
+namespace {
+enum SuperblockType {
+    SUPERBLOCK_NONE = 0,
+    SUPERBLOCK_5X = 1,
+    SUPERBLOCK_50X = 2,
+};
+
+SuperblockType GetSuperblockTypeUncached(int nHeight)
+{
+    // A psuedo-random pattern is used to select "super blocks" which
+    // get either 50x or 5x normal subsidy
+    int rand = SuperblockRandom(nHeight);
+    if (rand > 99990)
+        return SUPERBLOCK_50X;
+    if (rand < 2001)
+        return SUPERBLOCK_5X;
+    return SUPERBLOCK_NONE;
+}
+
+/**
+ * Superblock type of every height below MAX_HEIGHT, two bits per height. Chunks of
+ * CHUNK_HEIGHTS are filled on first use, so connecting, mining and supply audits of
+ * blocks already seen only cost a lookup.
+ */
+class CSuperblockMap
+{
+private:
+    static const int CHUNK_BITS = 12;
+    static const int CHUNK_HEIGHTS = 1 << CHUNK_BITS;
+    static const int MAX_HEIGHT = 1 << 26;
+
+    CCriticalSection cs;
+    std::vector<std::unique_ptr<uint8_t[]>> vChunks;
+
+public:
+    SuperblockType Get(int nHeight)
+    {
+        if (nHeight < 0 || nHeight >= MAX_HEIGHT)
+            return GetSuperblockTypeUncached(nHeight);
+
+        const size_t nChunk = nHeight >> CHUNK_BITS;
+        LOCK(cs);
+        if (nChunk >= vChunks.size())
+            vChunks.resize(nChunk + 1);
+        if (!vChunks[nChunk]) {
+            std::unique_ptr<uint8_t[]> chunk(new uint8_t[CHUNK_HEIGHTS / 4]());
+            const int nStart = nChunk << CHUNK_BITS;
+            for (int i = 0; i < CHUNK_HEIGHTS; i++)
+                chunk[i >> 2] |= GetSuperblockTypeUncached(nStart + i) << ((i & 3) * 2);
+            vChunks[nChunk] = std::move(chunk);
+        }
+        const int i = nHeight & (CHUNK_HEIGHTS - 1);
+        return (SuperblockType)((vChunks[nChunk][i >> 2] >> ((i & 3) * 2)) & 3);
+    }
+};
+
+CSuperblockMap mapSuperblocks;
+} // namespace
+
 CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
 {
     // In -regtest mode use Bitcoin schedule
@@ -1079,14 +1251,12 @@ CAmount GetBlockSubsidy(int nHeight, const Consensus::Params& consensusParams)
         nSubsidy = 200 * COIN;
     }
     
-        // Superblock random reward
-    // A psuedo-random pattern is used to select "super blocks" which
-    // getet either 50x or 5x normal subsidy
-    int rand = generateMTRandom(nHeight, 100000);
+    // Superblock random reward
+    SuperblockType superblock = mapSuperblocks.Get(nHeight);
 
-    if(rand > 99990) {
+    if (superblock == SUPERBLOCK_50X) {
         nSubsidy *= 50;
-    } else if (rand < 2001) {
+    } else if (superblock == SUPERBLOCK_5X) {
         nSubsidy *= 5 ;
     }
     
@@ -1603,6 +1773,53 @@ void ThreadScriptCheck() {
     scriptcheckqueue.Thread();
 }
 
+/**
+ * Context-free proof-of-work check of a run of headers from one headers message.
+ * Results go to the caller's arrays, at the positions given when it was built.
+ */
+class CHeaderPoWCheck
+{
+private:
+    std::vector<const CBlockHeader*> vpheader;
+    char* pfChecked;
+    uint256* phashPoW;
+    const Consensus::Params* pparams;
+
+public:
+    CHeaderPoWCheck(): pfChecked(nullptr), phashPoW(nullptr), pparams(nullptr) {}
+    CHeaderPoWCheck(std::vector<const CBlockHeader*> vpheaderIn, char* pfCheckedIn, uint256* phashPoWIn, const Consensus::Params& params) :
+        vpheader(std::move(vpheaderIn)), pfChecked(pfCheckedIn), phashPoW(phashPoWIn), pparams(&params) {}
+
+    bool operator()()
+    {
+        std::vector<bool> vChecked;
+        std::vector<uint256> vHash;
+        CheckBlockHeadersProofOfWork(vpheader, vChecked, vHash, *pparams);
+        bool fAllOk = true;
+        for (size_t i = 0; i < vpheader.size(); i++) {
+            pfChecked[i] = vChecked[i];
+            phashPoW[i] = vHash[i];
+            fAllOk &= vChecked[i];
+        }
+        return fAllOk;
+    }
+
+    void swap(CHeaderPoWCheck& check)
+    {
+        vpheader.swap(check.vpheader);
+        std::swap(pfChecked, check.pfChecked);
+        std::swap(phashPoW, check.phashPoW);
+        std::swap(pparams, check.pparams);
+    }
+};
+
+static CCheckQueue<CHeaderPoWCheck> headercheckqueue(1);
+
+void ThreadHeaderCheck() {
+    RenameThread("sexcoin-headerch");
+    headercheckqueue.Thread();
+}
+
 // Protected by cs_main
 VersionBitsCache versionbitscache;
 
@@ -1692,6 +1909,37 @@ static int64_t nTimeIndex = 0;
 static int64_t nTimeCallbacks = 0;
 static int64_t nTimeTotal = 0;
 
+/** The -supplyindex entry of a block, given the entry of its parent and the fees its transactions paid. */
+static CSupplyInfo GetBlockSupplyInfo(const CSupplyInfo& prev, const CBlock& block, int nHeight, CAmount nFees, const Consensus::Params& consensusParams)
+{
+    CSupplyInfo info = prev;
+    const CAmount nSubsidy = GetBlockSubsidy(nHeight, consensusParams);
+    info.nHeight = nHeight;
+    info.nSubsidy += nSubsidy;
+    info.nFees += nFees;
+    info.nUnclaimed += nSubsidy + nFees - block.vtx[0]->GetValueOut();
+    for (const auto& tx : block.vtx) {
+        for (const CTxOut& txout : tx->vout) {
+            if (txout.scriptPubKey.IsUnspendable())
+                info.nBurned += txout.nValue;
+        }
+    }
+    return info;
+}
+
+/** Write the -supplyindex entry of a block that is being connected. */
+static bool WriteBlockSupplyInfo(const CBlock& block, const CBlockIndex* pindex, CAmount nFees, const Consensus::Params& consensusParams)
+{
+    CSupplyInfo info;
+    if (pindex->pprev) {
+        // SyncSupplyIndex has not reached the parent yet and will index this block too
+        if (!psupplyindex->ReadSupplyInfo(pindex->pprev->GetBlockHash(), info))
+            return true;
+        info = GetBlockSupplyInfo(info, block, pindex->nHeight, nFees, consensusParams);
+    }
+    return psupplyindex->WriteSupplyInfo({std::make_pair(pindex->GetBlockHash(), info)});
+}
+
 /** Apply the effects of this block (with given index) on the UTXO set represented by coins.
  *  Validity checks that depend on the UTXO set are also done; ConnectBlock()
  *  can fail if those validity checks fail (among other reasons). */
@@ -1716,8 +1964,11 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
     // Special case for the genesis block, skipping connection of its transactions
     // (its coinbase is unspendable)
     if (block.GetHash() == chainparams.GetConsensus().hashGenesisBlock) {
-        if (!fJustCheck)
+        if (!fJustCheck) {
+            if (psupplyindex && !WriteBlockSupplyInfo(block, pindex, 0, chainparams.GetConsensus()))
+                return AbortNode(state, "Failed to write supply index");
             view.SetBestBlock(pindex->GetBlockHash());
+        }
         return true;
     }
 
@@ -1911,6 +2162,9 @@ static bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockInd
         if (!pblocktree->WriteTxIndex(vPos))
             return AbortNode(state, "Failed to write transaction index");
 
+    if (psupplyindex && !WriteBlockSupplyInfo(block, pindex, nFees, chainparams.GetConsensus()))
+        return AbortNode(state, "Failed to write supply index");
+
     // add this block to the view's block chain
     view.SetBestBlock(pindex->GetBlockHash());
 
@@ -2002,11 +2256,19 @@ bool static FlushStateToDisk(const CChainParams& chainparams, CValidationState &
                     vBlocks.push_back(*it);
                     setDirtyBlockIndex.erase(it++);
                 }
-                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks, mapDirtyAuxPow)) {
+                if (!pblocktree->WriteBatchSync(vFiles, nLastBlockFile, vBlocks, mapDirtyAuxPow, mapDirtyPoWHash)) {
                     return AbortNode(state, "Failed to write to block index database");
                 }
                 for (std::vector<const CBlockIndex*>::const_iterator it = vBlocks.begin(); it != vBlocks.end(); it++) {
-                    mapDirtyAuxPow.erase((*it)->GetBlockHash());
+                    // Recently connected headers are the ones peers ask for,
+                    // so keep their auxpows around once they are on disk.
+                    std::map<uint256, std::shared_ptr<CAuxPow> >::iterator itAuxPow = mapDirtyAuxPow.find((*it)->GetBlockHash());
+                    if (itAuxPow != mapDirtyAuxPow.end()) {
+                        if (itAuxPow->second)
+                            auxpowStore.Put(itAuxPow->first, itAuxPow->second);
+                        mapDirtyAuxPow.erase(itAuxPow);
+                    }
+                    mapDirtyPoWHash.erase((*it)->GetBlockHash());
                 }
             }
             // Finally remove any pruned files
@@ -2688,8 +2950,7 @@ static CBlockIndex* AddToBlockIndex(const CBlockHeader& block)
         return it->second;
 
     // Construct new block index object
-    CBlockIndex* pindexNew = new CBlockIndex(block);
-    assert(pindexNew);
+    CBlockIndex* pindexNew = blockIndexArena.Allocate(block);
     // We assign the sequence id to blocks only when the full data is available,
     // to avoid miners withholding blocks but broadcasting headers, to get a
     // competitive advantage.
@@ -2853,10 +3114,10 @@ static bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos,
     return true;
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+static bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true, uint256* phashPoW = nullptr)
 {
     // Check proof of work matches claimed amount
-    if (fCheckPOW && !CheckBlockProofOfWork(&block, consensusParams))
+    if (fCheckPOW && !CheckBlockProofOfWork(&block, consensusParams, phashPoW))
         return state.DoS(50, false, REJECT_INVALID, "high-hash", false, "proof of work failed");
 
     return true;
@@ -3161,11 +3422,13 @@ static bool ContextualCheckBlock(const CBlock& block, CValidationState& state, c
     return true;
 }
 
-static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex)
+/** phashPoW, if given, is the proof-of-work hash of block, already checked by the caller. */
+static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex, const uint256* phashPoW = nullptr)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
     uint256 hash = block.GetHash();
+    uint256 hashPoW;
     BlockMap::iterator miSelf = mapBlockIndex.find(hash);
     CBlockIndex *pindex = nullptr;
     if (hash != chainparams.GetConsensus().hashGenesisBlock) {
@@ -3180,7 +3443,9 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, chainparams.GetConsensus()))
+        if (phashPoW)
+            hashPoW = *phashPoW;
+        if (!CheckBlockHeader(block, state, chainparams.GetConsensus(), phashPoW == nullptr, &hashPoW))
             return error("%s: Consensus::CheckBlockHeader: %s, %s", __func__, hash.ToString(), FormatStateMessage(state));
 
         // Get prev block index
@@ -3209,8 +3474,11 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
             }
         }
     }
-    if (pindex == nullptr)
+    if (pindex == nullptr) {
         pindex = AddToBlockIndex(block);
+        if (!hashPoW.IsNull())
+            mapDirtyPoWHash.insert(std::make_pair(hash, hashPoW));
+    }
 
     if (ppindex)
         *ppindex = pindex;
@@ -3224,11 +3492,53 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
 bool ProcessNewBlockHeaders(const std::vector<CBlockHeader>& headers, CValidationState& state, const CChainParams& chainparams, const CBlockIndex** ppindex, CBlockHeader *first_invalid)
 {
     if (first_invalid != nullptr) first_invalid->SetNull();
+
+    // Check the proof of work (scrypt, or auxpow and its parent's scrypt) of the
+    // headers we don't know yet on the header check threads, without holding
+    // cs_main. Headers that fail here are checked again by AcceptBlockHeader so
+    // the usual error is reported.
+    std::vector<size_t> vIndex;
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i = 0; i < headers.size(); i++) {
+            if (!mapBlockIndex.count(headers[i].GetHash()))
+                vIndex.push_back(i);
+        }
+    }
+    std::vector<char> vChecked(vIndex.size(), false);
+    std::vector<uint256> vHash(vIndex.size());
+    {
+        const size_t nLanes = scrypt_multi_lanes();
+        std::vector<CHeaderPoWCheck> vChecks;
+        for (size_t i = 0; i < vIndex.size(); i += nLanes) {
+            std::vector<const CBlockHeader*> vpheader;
+            for (size_t j = i; j < vIndex.size() && j < i + nLanes; j++)
+                vpheader.push_back(&headers[vIndex[j]]);
+            vChecks.push_back(CHeaderPoWCheck(std::move(vpheader), &vChecked[i], &vHash[i], chainparams.GetConsensus()));
+        }
+        if (nScriptCheckThreads) {
+            CCheckQueueControl<CHeaderPoWCheck> control(&headercheckqueue);
+            control.Add(vChecks);
+            control.Wait();
+        } else {
+            for (CHeaderPoWCheck& check : vChecks) {
+                if (!check())
+                    break;
+            }
+        }
+    }
+    std::vector<const uint256*> vpHashPoW(headers.size(), nullptr);
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        if (vChecked[i])
+            vpHashPoW[vIndex[i]] = &vHash[i];
+    }
+
+    {
+        LOCK(cs_main);
+        for (size_t i = 0; i < headers.size(); i++) {
+            const CBlockHeader& header = headers[i];
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            if (!AcceptBlockHeader(header, state, chainparams, &pindex)) {
+            if (!AcceptBlockHeader(header, state, chainparams, &pindex, vpHashPoW[i])) {
                 if (first_invalid) *first_invalid = header;
                 return false;
             }
@@ -3590,15 +3900,46 @@ CBlockIndex * InsertBlockIndex(uint256 hash)
         return (*mi).second;
 
     // Create new
-    CBlockIndex* pindexNew = new CBlockIndex();
-    if (!pindexNew)
-        throw std::runtime_error(std::string(__func__) + ": new CBlockIndex failed");
+    CBlockIndex* pindexNew = blockIndexArena.Allocate();
     mi = mapBlockIndex.insert(std::make_pair(hash, pindexNew)).first;
     pindexNew->phashBlock = &((*mi).first);
 
     return pindexNew;
 }
 
+BlockIndexMemoryStats GetBlockIndexMemoryStats()
+{
+    AssertLockHeld(cs_main);
+    CBlockIndexArena::Stats stats = blockIndexArena.GetStats();
+    return BlockIndexMemoryStats{stats.entries, stats.bytes, memusage::DynamicUsage(mapBlockIndex)};
+}
+
+/** Compute the proof-of-work hashes of block index entries, failing if one does not meet its target. */
+static bool ComputePoWHashes(const std::vector<const CBlockIndex*>& vIndex, std::vector<std::pair<uint256, uint256> >& vPoWHash, const CChainParams& chainparams)
+{
+    std::vector<CBlockHeader> vHeader;
+    {
+        LOCK(cs_main);
+        for (const CBlockIndex* pindex : vIndex)
+            vHeader.push_back(pindex->GetBlockHeader(mapDirtyAuxPow));
+    }
+
+    std::vector<const CBlockHeader*> vpheader;
+    for (const CBlockHeader& header : vHeader)
+        vpheader.push_back(&header);
+    std::vector<bool> vChecked;
+    std::vector<uint256> vHashPoW;
+    CheckBlockHeadersProofOfWork(vpheader, vChecked, vHashPoW, chainparams.GetConsensus());
+
+    vPoWHash.clear();
+    for (size_t i = 0; i < vIndex.size(); i++) {
+        if (!vChecked[i] && !CheckBlockProofOfWork(vpheader[i], chainparams.GetConsensus(), &vHashPoW[i]))
+            return error("%s: proof of work check failed for block index entry %s", __func__, vIndex[i]->ToString());
+        vPoWHash.push_back(std::make_pair(vIndex[i]->GetBlockHash(), vHashPoW[i]));
+    }
+    return true;
+}
+
 bool static LoadBlockIndexDB(const CChainParams& chainparams)
 {
     if (!pblocktree->LoadBlockIndexGuts(chainparams.GetConsensus(), InsertBlockIndex))
@@ -3606,6 +3947,44 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
 
     boost::this_thread::interruption_point();
 
+    // Check the stored proof-of-work hashes against the loaded entries. A hash
+    // that does not belong to its entry or misses the entry's target is
+    // recomputed from the header, and only if that fails too is the index
+    // corrupt. Entries from before these hashes were stored are filled in
+    // later by MigrateBlockIndexPoWHashes().
+    size_t nPoWChecked = 0;
+    std::vector<const CBlockIndex*> vRecompute;
+    bool fPoWOk = pblocktree->LoadPoWHashes([&chainparams, &nPoWChecked, &vRecompute](const uint256& hash, const uint256& hashPoW, bool fConsistent) {
+        BlockMap::const_iterator mi = mapBlockIndex.find(hash);
+        if (mi == mapBlockIndex.end())
+            return true;
+        if (!fConsistent || !CheckProofOfWork(hashPoW, mi->second->nBits, chainparams.GetConsensus()))
+            vRecompute.push_back(mi->second);
+        nPoWChecked++;
+        return true;
+    });
+    if (!fPoWOk)
+        return false;
+    if (!vRecompute.empty()) {
+        LogPrintf("%s: recomputing %u inconsistent proof-of-work hashes\n", __func__, vRecompute.size());
+        std::vector<std::pair<uint256, uint256> > vPoWHash;
+        if (!ComputePoWHashes(vRecompute, vPoWHash, chainparams))
+            return false;
+        if (!pblocktree->WritePoWHashes(vPoWHash))
+            return error("%s: failed to write proof-of-work hashes", __func__);
+    }
+
+    // Once every entry has its hash stored, one that lacks it is corrupt. The
+    // genesis block never went through AcceptBlockHeader and has none.
+    bool fHavePoWHashes = false;
+    if (nPoWChecked + 1 < mapBlockIndex.size() && pblocktree->ReadFlag("powhashes", fHavePoWHashes) && fHavePoWHashes) {
+        for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex) {
+            if (item.second->pprev && !pblocktree->HavePoWHash(item.first))
+                return error("%s: proof-of-work hash missing for %s", __func__, item.second->ToString());
+        }
+    }
+    LogPrintf("%s: checked proof of work of %u block index entries\n", __func__, nPoWChecked);
+
     // Calculate nChainWork
     std::vector<std::pair<int, CBlockIndex*> > vSortedByHeight;
     vSortedByHeight.reserve(mapBlockIndex.size());
@@ -3615,10 +3994,55 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
         vSortedByHeight.push_back(std::make_pair(pindex->nHeight, pindex));
     }
     sort(vSortedByHeight.begin(), vSortedByHeight.end());
-    for (const std::pair<int, CBlockIndex*>& item : vSortedByHeight)
+
+    // The entries were allocated in the order the database returned them,
+    // which is by hash. Move them to a new arena in height order, so that
+    // walking back along pprev (GetAncestor(), the retarget algorithms) reads
+    // neighbouring memory. pskip is only set by BuildSkip() below; until then
+    // it serves to find the moved copy of a parent, which is always moved
+    // before its children.
     {
-        CBlockIndex* pindex = item.second;
-        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + GetBlockProof(*pindex);
+        CBlockIndexArena arenaByHeight;
+        for (std::pair<int, CBlockIndex*>& item : vSortedByHeight) {
+            CBlockIndex* pindex = item.second;
+            CBlockIndex* pindexMoved = arenaByHeight.Allocate(*pindex);
+            if (pindex->pprev) {
+                if (!pindex->pprev->pskip) {
+                    for (BlockMap::value_type& entry : mapBlockIndex)
+                        entry.second->pskip = nullptr;
+                    return error("LoadBlockIndexDB(): block index entry %s is not above its parent", pindex->GetBlockHash().ToString());
+                }
+                pindexMoved->pprev = pindex->pprev->pskip;
+            }
+            pindex->pskip = pindexMoved;
+            item.second = pindexMoved;
+        }
+        for (BlockMap::value_type& entry : mapBlockIndex)
+            entry.second = entry.second->pskip;
+        blockIndexArena.Swap(arenaByHeight);
+    }
+
+    // GetBlockProof() costs a 256-bit division per entry, so it is computed on
+    // all cores up front; the pass below, which has to follow the height order,
+    // only adds it to the work of the parent.
+    std::vector<arith_uint256> vBlockProof(vSortedByHeight.size());
+    {
+        const size_t nChunk = vSortedByHeight.size() / std::max(GetNumCores(), 1) + 1;
+        std::vector<std::future<void> > vJobs;
+        for (size_t nBegin = 0; nBegin < vSortedByHeight.size(); nBegin += nChunk) {
+            const size_t nEnd = std::min(nBegin + nChunk, vSortedByHeight.size());
+            vJobs.push_back(std::async(std::launch::async, [&vSortedByHeight, &vBlockProof, nBegin, nEnd]() {
+                for (size_t i = nBegin; i < nEnd; i++)
+                    vBlockProof[i] = GetBlockProof(*vSortedByHeight[i].second);
+            }));
+        }
+        for (std::future<void>& job : vJobs)
+            job.get();
+    }
+    for (size_t i = 0; i < vSortedByHeight.size(); i++)
+    {
+        CBlockIndex* pindex = vSortedByHeight[i].second;
+        pindex->nChainWork = (pindex->pprev ? pindex->pprev->nChainWork : 0) + vBlockProof[i];
         pindex->nTimeMax = (pindex->pprev ? std::max(pindex->pprev->nTimeMax, pindex->nTime) : pindex->nTime);
         // We can link the chain of blocks for which we've received transactions at some point.
         // Pruned nodes may have deleted the block.
@@ -4029,6 +4453,8 @@ void UnloadBlockIndex()
     nBlockSequenceId = 1;
     setDirtyBlockIndex.clear();
     mapDirtyAuxPow.clear();
+    auxpowStore.Clear();
+    mapDirtyPoWHash.clear();
     g_failed_blocks.clear();
     setDirtyFileInfo.clear();
     versionbitscache.Clear();
@@ -4036,10 +4462,8 @@ void UnloadBlockIndex()
         warningcache[b].clear();
     }
 
-    for (BlockMap::value_type& entry : mapBlockIndex) {
-        delete entry.second;
-    }
     mapBlockIndex.clear();
+    blockIndexArena.Clear();
     fHavePruned = false;
 }
 
@@ -4064,7 +4488,133 @@ bool LoadBlockIndex(const CChainParams& chainparams)
         // Use the provided setting for -txindex in the new database
         fTxIndex = gArgs.GetBoolArg("-txindex", DEFAULT_TXINDEX);
         pblocktree->WriteFlag("txindex", fTxIndex);
+        // Every entry of a new index gets its proof-of-work hash stored along with it
+        pblocktree->WriteFlag("powhashes", true);
+    }
+    return true;
+}
+
+bool MigrateBlockIndexPoWHashes(const CChainParams& chainparams)
+{
+    bool fHavePoWHashes = false;
+    if (pblocktree->ReadFlag("powhashes", fHavePoWHashes) && fHavePoWHashes)
+        return true;
+
+    // The genesis block never went through AcceptBlockHeader and has no stored hash.
+    std::vector<const CBlockIndex*> vIndex;
+    {
+        LOCK(cs_main);
+        vIndex.reserve(mapBlockIndex.size());
+        for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex) {
+            if (item.second->pprev)
+                vIndex.push_back(item.second);
+        }
     }
+    LogPrintf("%s: storing proof-of-work hashes of %u block index entries\n", __func__, vIndex.size());
+
+    static const size_t nBatchSize = 4096;
+    size_t nStored = 0;
+    for (size_t nNext = 0; nNext < vIndex.size(); ) {
+        boost::this_thread::interruption_point();
+
+        std::vector<const CBlockIndex*> vBatch;
+        for (; nNext < vIndex.size() && vBatch.size() < nBatchSize; nNext++) {
+            if (!pblocktree->HavePoWHash(vIndex[nNext]->GetBlockHash()))
+                vBatch.push_back(vIndex[nNext]);
+        }
+        std::vector<std::pair<uint256, uint256> > vPoWHash;
+        if (!ComputePoWHashes(vBatch, vPoWHash, chainparams))
+            return AbortNode("Proof of work check failed for a block index entry",
+                             _("Error: Corrupted block database detected. Please restart with -reindex."));
+        if (!pblocktree->WritePoWHashes(vPoWHash))
+            return AbortNode("Failed to write to block index database");
+        nStored += vPoWHash.size();
+    }
+
+    pblocktree->WriteFlag("powhashes", true);
+    LogPrintf("%s: stored %u proof-of-work hashes\n", __func__, nStored);
+    return true;
+}
+
+bool SyncSupplyIndex(const CChainParams& chainparams)
+{
+    if (!psupplyindex)
+        return true;
+
+    // ConnectBlock only indexes a block on top of an indexed parent, so the indexed
+    // blocks of the active chain form a prefix of it. Find where that prefix ends.
+    const CBlockIndex* pindex = nullptr;
+    CSupplyInfo info;
+    {
+        LOCK(cs_main);
+        int nIndexed = -1, nMissing = chainActive.Height() + 1;
+        while (nMissing - nIndexed > 1) {
+            int nMid = (nIndexed + nMissing) / 2;
+            if (psupplyindex->ReadSupplyInfo(chainActive[nMid]->GetBlockHash(), info))
+                nIndexed = nMid;
+            else
+                nMissing = nMid;
+        }
+        if (nMissing > chainActive.Height())
+            return true;
+        if (nIndexed >= 0) {
+            pindex = chainActive[nIndexed];
+            if (!psupplyindex->ReadSupplyInfo(pindex->GetBlockHash(), info))
+                return AbortNode("Failed to read supply index");
+        }
+        LogPrintf("%s: indexing supply from height %d to %d\n", __func__, nMissing, chainActive.Height());
+    }
+
+    static const size_t nBatchSize = 1000;
+    int nIndexed = 0;
+    while (true) {
+        boost::this_thread::interruption_point();
+
+        std::vector<std::tuple<const CBlockIndex*, CDiskBlockPos, CDiskBlockPos> > vBatch;
+        {
+            LOCK(cs_main);
+            if (pindex && !chainActive.Contains(pindex)) {
+                // Reorganized away from the blocks indexed so far; their common ancestor was indexed before them
+                pindex = chainActive.FindFork(pindex);
+                if (!psupplyindex->ReadSupplyInfo(pindex->GetBlockHash(), info))
+                    return AbortNode("Failed to read supply index");
+            }
+            const CBlockIndex* pnext = pindex ? chainActive.Next(pindex) : chainActive.Genesis();
+            for (; pnext && vBatch.size() < nBatchSize; pnext = chainActive.Next(pnext))
+                vBatch.emplace_back(pnext, pnext->GetBlockPos(), pnext->GetUndoPos());
+        }
+        if (vBatch.empty())
+            break;
+
+        std::vector<std::pair<uint256, CSupplyInfo> > vInfo;
+        for (const auto& item : vBatch) {
+            const CBlockIndex* pnext = std::get<0>(item);
+            CBlock block;
+            if (!ReadBlockFromDiskUnchecked(block, std::get<1>(item)) || block.GetHash() != pnext->GetBlockHash())
+                return AbortNode(strprintf("Failed to read block %s for the supply index", pnext->GetBlockHash().ToString()));
+            if (!pnext->pprev) {
+                info.SetNull();
+            } else {
+                CBlockUndo blockundo;
+                if (std::get<2>(item).IsNull() || !UndoReadFromDisk(blockundo, std::get<2>(item), pnext->pprev->GetBlockHash()))
+                    return AbortNode(strprintf("Failed to read undo data of block %s for the supply index", pnext->GetBlockHash().ToString()));
+                CAmount nFees = 0;
+                for (size_t i = 1; i < block.vtx.size(); i++) {
+                    for (const Coin& coin : blockundo.vtxundo[i - 1].vprevout)
+                        nFees += coin.out.nValue;
+                    nFees -= block.vtx[i]->GetValueOut();
+                }
+                info = GetBlockSupplyInfo(info, block, pnext->nHeight, nFees, chainparams.GetConsensus());
+            }
+            vInfo.push_back(std::make_pair(pnext->GetBlockHash(), info));
+        }
+        if (!psupplyindex->WriteSupplyInfo(vInfo))
+            return AbortNode("Failed to write supply index");
+        pindex = std::get<0>(vBatch.back());
+        nIndexed += vInfo.size();
+    }
+
+    LogPrintf("%s: indexed supply of %d blocks\n", __func__, nIndexed);
     return true;
 }
 
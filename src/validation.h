@@ -34,6 +34,7 @@
 class CBlockIndex;
 class CBlockTreeDB;
 class CChainParams;
+class CSupplyIndexDB;
 class CCoinsViewDB;
 class CInv;
 class CConnman;
@@ -131,6 +132,7 @@ static const int64_t MAX_FEE_ESTIMATION_TIP_AGE = 3 * 60 * 60;
 static const bool DEFAULT_PERMIT_BAREMULTISIG = true;
 static const bool DEFAULT_CHECKPOINTS_ENABLED = true;
 static const bool DEFAULT_TXINDEX = false;
+static const bool DEFAULT_SUPPLYINDEX = false;
 static const unsigned int DEFAULT_BANSCORE_THRESHOLD = 100;
 /** Default for -persistmempool */
 static const bool DEFAULT_PERSIST_MEMPOOL = true;
@@ -265,12 +267,19 @@ bool LoadGenesisBlock(const CChainParams& chainparams);
 /** Load the block tree and coins database from disk,
  * initializing state if we're running with -reindex. */
 bool LoadBlockIndex(const CChainParams& chainparams);
+/** Store the proof-of-work hashes of block index entries written before they were kept
+ * alongside the index, so that later startups can check them. Runs once per datadir. */
+bool MigrateBlockIndexPoWHashes(const CChainParams& chainparams);
+/** Add -supplyindex entries for active chain blocks connected while the index was off. */
+bool SyncSupplyIndex(const CChainParams& chainparams);
 /** Update the chain tip based on database information. */
 bool LoadChainTip(const CChainParams& chainparams);
 /** Unload database information */
 void UnloadBlockIndex();
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the header proof-of-work checking thread */
+void ThreadHeaderCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload();
 /** Retrieve a transaction (from memory pool, or from disk, if possible) */
@@ -294,6 +303,16 @@ void UnlinkPrunedFiles(const std::set<int>& setFilesToPrune);
 
 /** Create a new block index entry for a given block hash */
 CBlockIndex * InsertBlockIndex(uint256 hash);
+
+struct BlockIndexMemoryStats
+{
+    size_t entries;
+    size_t entry_bytes; //!< Arena slabs holding the CBlockIndex entries
+    size_t map_bytes;   //!< mapBlockIndex nodes and buckets
+};
+
+/** Memory held by the block index. Requires cs_main. */
+BlockIndexMemoryStats GetBlockIndexMemoryStats();
 /** Flush all state, indexes and buffers to disk. */
 void FlushStateToDisk();
 /** Prune block files and flush state to disk. */
@@ -397,6 +416,10 @@ void InitScriptExecutionCache();
 /** Functions for disk access for blocks */
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+/** Read the block at pos, which the caller looked up under cs_main, and check it against the indexed hash and its auxpow. */
+bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const uint256& hash, const Consensus::Params& consensusParams);
+/** Read the serialized bytes of the block at pos as they are stored, checking the index header, the block hash and the auxpow. */
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CDiskBlockPos& pos, const uint256& hash, const CMessageHeader::MessageStartChars& messageStart, const Consensus::Params& consensusParams);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -453,6 +476,9 @@ extern CCoinsViewCache *pcoinsTip;
 /** Global variable that points to the active block tree (protected by cs_main) */
 extern CBlockTreeDB *pblocktree;
 
+/** Global variable that points to the supply index, if -supplyindex (protected by cs_main) */
+extern CSupplyIndexDB *psupplyindex;
+
 /**
  * Return the spend height, which is one more than the inputs.GetBestBlock().
  * While checking, GetBestBlock() refers to the parent block. (protected by cs_main)
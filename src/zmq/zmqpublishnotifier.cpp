@@ -2,12 +2,15 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include "arith_uint256.h"
+#include "auxpow/blockcache.h"
 #include "chain.h"
 #include "chainparams.h"
 #include "streams.h"
 #include "zmqpublishnotifier.h"
 #include "validation.h"
 #include "util.h"
+#include "rpc/mining.h"
 #include "rpc/server.h"
 
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
@@ -16,6 +19,7 @@ static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
+static const char *MSG_AUXBLOCK  = "auxblock";
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -195,3 +199,29 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+bool CZMQPublishAuxBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
+{
+    int nHeight;
+    std::shared_ptr<const CBlock> pblock;
+    try {
+        pblock = auxBlockCache.Create(GetAuxpowMiningScript(), nHeight, pindex->GetBlockHash());
+    } catch (const std::exception& e) {
+        LogPrint(BCLog::ZMQ, "zmq: Can't create auxblock: %s\n", e.what());
+        return true;
+    }
+    if (!pblock || nHeight < Params().GetConsensus().nAuxPowStartHeight)
+        return true;
+
+    uint256 hash = pblock->GetHash();
+    LogPrint(BCLog::ZMQ, "zmq: Publish auxblock %s\n", hash.GetHex());
+
+    /* hash as in hashblock, then the target as getauxblock prints it, then the LE chain ID */
+    char data[68];
+    for (unsigned int i = 0; i < 32; i++)
+        data[31 - i] = hash.begin()[i];
+    uint256 target = ArithToUint256(arith_uint256().SetCompact(pblock->nBits));
+    memcpy(&data[32], target.begin(), 32);
+    WriteLE32((unsigned char*)&data[64], pblock->GetChainID());
+    return SendMessage(MSG_AUXBLOCK, data, sizeof(data));
+}